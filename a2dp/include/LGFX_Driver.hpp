@@ -1,66 +0,0 @@
-#pragma once
-
-#define LGFX_USE_V1
-#include <LovyanGFX.hpp>
-
-// CYD (ESP32-2432S028R / JC2432W328) ST7789 240x320 用設定
-// TFT HSPI: SCLK=14, MOSI=13, CS=15, DC=2, BL=27
-
-class LGFX : public lgfx::LGFX_Device {
-  lgfx::Panel_ST7789  _panel;
-  lgfx::Bus_SPI       _bus;
-  lgfx::Light_PWM     _light;
-
-public:
-  LGFX() {
-    { // SPIバス設定
-      auto cfg = _bus.config();
-      cfg.spi_host    = HSPI_HOST;
-      cfg.spi_mode    = 3;
-      cfg.freq_write  = 40000000;   // 安定性優先
-      cfg.freq_read   = 16000000;
-      cfg.spi_3wire   = false;
-      cfg.use_lock    = true;
-      cfg.dma_channel = SPI_DMA_CH_AUTO;
-      cfg.pin_sclk    = 14;
-      cfg.pin_mosi    = 13;
-      cfg.pin_miso    = -1;         // 未使用
-      cfg.pin_dc      = 2;
-      _bus.config(cfg);
-      _panel.setBus(&_bus);
-    }
-
-    { // パネル設定
-      auto cfg = _panel.config();
-      cfg.pin_cs           = 15;
-      cfg.pin_rst          = -1;
-      cfg.pin_busy         = -1;
-      cfg.memory_width     = 240;
-      cfg.memory_height    = 320;
-      cfg.panel_width      = 240;
-      cfg.panel_height     = 320;
-      cfg.offset_x         = 0;
-      cfg.offset_y         = 0;
-      cfg.offset_rotation  = 0;
-      cfg.dummy_read_pixel = 8;
-      cfg.dummy_read_bits  = 1;
-      cfg.readable         = false;
-      cfg.invert           = false;
-      cfg.rgb_order        = false;  // RGB
-      cfg.dlen_16bit       = false;
-      cfg.bus_shared       = false;
-      _panel.config(cfg);
-    }
-
-    { // バックライト設定
-      auto cfg = _light.config();
-      cfg.pin_bl      = 27;
-      cfg.freq        = 12000;
-      cfg.pwm_channel = 1;
-      _light.config(cfg);
-      _panel.setLight(&_light);
-    }
-
-    setPanel(&_panel);
-  }
-};
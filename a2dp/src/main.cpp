@@ -6,8 +6,16 @@
 #include <vector>
 #include <cstring>
 
-#include "LGFX_Driver.hpp"
+#include "BspLgfx.hpp"
 #include "CST820.h"
+#include "TouchFilter.h"
+#include "TouchAffine.h"
+#include "SdBench.h"
+#include "SdMount.h"
+#include "SdIndex.h"
+#include "SdLog.h"
+#include "AssetPack.h"
+#include "I2sOut.h"
 
 using audio_tools::I2SStream;
 
@@ -16,12 +24,24 @@ static I2SStream i2s;
 static BluetoothA2DPSink a2dp_sink;
 static LGFX tft;
 static SPIClass sdSPI(VSPI);
-static CST820 touch(33, 32, 25, 21, I2C_ADDR_CST820);
+static CST820 touch;   // ピンは bsp::Board::Touch
+static TouchFilterDefault touchFilter;
+// タッチ生座標 → 画面座標（既定は横向き。NVS にキャリブレーション結果があれば置き換える）
+static TouchAffine touchCal = touch_affine_make(0, 1, 0, -1, 0, 240 - 1);
 static bool isA2dpConnected = false;
 static constexpr const char* dev_name = "TWV2000C";
 static std::vector<int32_t> sample_buffer;
 static bool sdInitialized = false;
 static char sdStatus[96] = "SD: Not initialized";
+static SdIndex sdIndex;
+static AssetPack assets;
+static bool sdWriteOk = false;
+static bool sdReadOk = false;
+#if SD_LOG_ENABLE
+static SdLog sdLog;
+static volatile uint32_t audioBytes = 0;
+static volatile uint32_t audioCallbacks = 0;
+#endif
 static char touchStatus[64] = "Touch: --";
 static char lastTouchStatus[64] = "";
 static int lineHeight = 0;
@@ -30,6 +50,7 @@ static int sdLineY = 0;
 static int touchLineY = 0;
 
 static void init_sd_card();
+static void update_sd_status();
 static void drawStatusLine(int y, const char* text, uint16_t fgColor);
 
 // callback 
@@ -38,19 +59,11 @@ void get_audio_data(const uint8_t *data, uint32_t len) {
         return;
     }
 
-    const size_t sample_count = len / sizeof(int16_t);
-    if (sample_buffer.size() < sample_count) {
-        sample_buffer.resize(sample_count);
-    }
-
-    const int16_t* data16 = reinterpret_cast<const int16_t*>(data);
-    for (size_t idx = 0; idx < sample_count; ++idx) {
-         const int16_t sample_with_error = data16[idx] | 0x0001;  // PCM5102A対策
-         sample_buffer[idx] = static_cast<int32_t>(sample_with_error) << 16;
-    }
-
-    i2s.write(reinterpret_cast<const uint8_t*>(sample_buffer.data()),
-              sample_count * sizeof(int32_t));
+#if SD_LOG_ENABLE
+    audioBytes += len;
+    ++audioCallbacks;
+#endif
+    i2s_out_write16(i2s, reinterpret_cast<const int16_t*>(data), len / sizeof(int16_t), 2, sample_buffer);
 }
 
 //  For memory check
@@ -77,46 +90,44 @@ static void drawStatusLine(int y, const char* text, uint16_t fgColor) {
 }
 
 static void init_sd_card() {
-    constexpr int SD_CS = 5;
-    constexpr int SD_SCK = 18;
-    constexpr int SD_MISO = 19;
-    constexpr int SD_MOSI = 23;
+    constexpr int SD_CS = bsp::Board::Sd::kCs;
+    constexpr int SD_SCK = bsp::Board::Sd::kSck;
+    constexpr int SD_MISO = bsp::Board::Sd::kMiso;
+    constexpr int SD_MOSI = bsp::Board::Sd::kMosi;
     sdSPI.begin(SD_SCK, SD_MISO, SD_MOSI, SD_CS);
 
-    if (!SD.begin(SD_CS, sdSPI, 10000000)) {
+    SdMountResult sdm = sd_mount_auto(sdSPI, SD_CS);
+    if (!sdm.ok) {
         snprintf(sdStatus, sizeof(sdStatus), "SD: Not found");
         Serial.println("[SD] Initialization failed");
         return;
     }
 
+#if SD_BENCH_ENABLE
+    if (!sd_bench_run(sdSPI, sd_bench_default_config(SD_CS, sdm.hz), Serial)) {
+        snprintf(sdStatus, sizeof(sdStatus), "SD: Bench remount NG");
+        return;
+    }
+#endif
+#if ASSET_BENCH_ENABLE
+    if (assets.valid()) asset_pack_bench(assets, SD, "/assets", Serial);
+#endif
+
+    Serial.printf("[SD] %lu Hz%s\n", (unsigned long)sdm.hz, sdm.cached ? " (cached)" : "");
     sdInitialized = true;
 
-    int fileCount = 0;
-    char firstName[32] = "";
-    File root = SD.open("/");
-    if (root) {
-        while (true) {
-            File entry = root.openNextFile();
-            if (!entry) break;
-            ++fileCount;
-            if (firstName[0] == '\0') {
-                strncpy(firstName, entry.name(), sizeof(firstName) - 1);
-                firstName[sizeof(firstName) - 1] = '\0';
-            }
-            entry.close();
-        }
-        root.close();
-    }
+    // ルートの件数は索引から読む（無い/古い場合は裏で作り直す）
+    bool indexed = sdIndex.open(SD, "/");
+    static SdIndexItem first;
+    const bool hasFirst = indexed && sdIndex.page(0, &first, 1) == 1;
 
-    bool writeOk = false;
-    bool readOk = false;
     String payload = String("Hello SD @") + String(millis());
     const char *testPath = "/a2dp_sd_test.txt";
 
     File wf = SD.open(testPath, FILE_WRITE);
     if (wf) {
         if (wf.println(payload)) {
-            writeOk = true;
+            sdWriteOk = true;
         }
         wf.close();
     }
@@ -126,22 +137,32 @@ static void init_sd_card() {
     if (rf) {
         readBack = rf.readStringUntil('\n');
         rf.close();
-        readOk = (readBack.length() > 0);
+        sdReadOk = (readBack.length() > 0);
     }
 
-    Serial.printf("[SD] files=%d first='%s' write=%s read=%s data='%s'\n",
-                  fileCount,
-                  firstName[0] ? firstName : "",
-                  writeOk ? "OK" : "NG",
-                  readOk ? "OK" : "NG",
+    Serial.printf("[SD] files=%lu%s first='%s' write=%s read=%s data='%s'\n",
+                  (unsigned long)sdIndex.count(),
+                  indexed ? "" : " (indexing)",
+                  hasFirst ? first.name : "",
+                  sdWriteOk ? "OK" : "NG",
+                  sdReadOk ? "OK" : "NG",
                   readBack.c_str());
 
+    sdIndex.start_background();
+    update_sd_status();
+}
+
+static void update_sd_status() {
+    if (!sdInitialized) return;
+    char files[16];
+    if (sdIndex.valid()) snprintf(files, sizeof(files), "%lu", (unsigned long)sdIndex.count());
+    else snprintf(files, sizeof(files), "...");
     snprintf(sdStatus,
              sizeof(sdStatus),
-             "SD: %s/%s files=%d",
-             writeOk ? "W OK" : "W NG",
-             readOk ? "R OK" : "R NG",
-             fileCount);
+             "SD: %s/%s files=%s",
+             sdWriteOk ? "W OK" : "W NG",
+             sdReadOk ? "R OK" : "R NG",
+             files);
 }
 
 
@@ -158,8 +179,17 @@ void setup() {
     tft.setTextColor(lgfx::color565(255, 255, 255));
     tft.setTextDatum(lgfx::textdatum_t::top_center);
     tft.setFont(&lgfx::fonts::AsciiFont8x16);
-    tft.setTextSize(2);
-    tft.drawString("TWV2000M", tft.width() / 2, 0);
+    // spiffs パーティションのアセットパックに "title" フォント（VLW）があれば、フラッシュから直接使う
+    const AssetEntry* titleEntry = nullptr;
+    const uint8_t* titleFont = assets.begin() ? assets.find("title", nullptr, &titleEntry) : nullptr;
+    if (titleFont && titleEntry->type == (uint16_t)AssetType::Font && tft.loadFont(titleFont)) {
+        tft.drawString("TWV2000M", tft.width() / 2, 0);
+        tft.unloadFont();
+        tft.setFont(&lgfx::fonts::AsciiFont8x16);
+    } else {
+        tft.setTextSize(2);
+        tft.drawString("TWV2000M", tft.width() / 2, 0);
+    }
     tft.setTextSize(1);
     tft.setTextDatum(lgfx::textdatum_t::middle_center);
     tft.drawString("Hello LovyanGFX", tft.width() / 2, tft.height() / 3);
@@ -172,25 +202,26 @@ void setup() {
     touchLineY = sdLineY + lineHeight + 4;
 
     touch.begin();
+    touch_calib_load(&touchCal);
     snprintf(touchStatus, sizeof(touchStatus), "Touch: --");
     drawStatusLine(statusLineY, "Waiting for A2DP...", lgfx::color565(0, 255, 128));
 
     init_sd_card();
+#if SD_LOG_ENABLE
+    if (sdInitialized) {
+        bool log_ok = sdLog.begin(SD, "/telemetry.log");
+        Serial.printf("[SDLOG] %s last_seq=%lu\n", log_ok ? "OK" : "NG", (unsigned long)sdLog.stats().recovered_seq);
+        const uint32_t boot[1] = {(uint32_t)esp_reset_reason()};
+        sdLog.append(SdLogType::Boot, boot, sizeof(boot));
+    }
+#endif
     drawStatusLine(sdLineY, sdStatus, lgfx::color565(255, 255, 0));
     drawStatusLine(touchLineY, touchStatus, lgfx::color565(0, 192, 255));
     strncpy(lastTouchStatus, touchStatus, sizeof(lastTouchStatus) - 1);
     lastTouchStatus[sizeof(lastTouchStatus) - 1] = '\0';
 
-    // I2S pins (avoid conflicts with TFT/SD on CYD): LRCK=22, BCK=26, DATA=4
-    // 変更: AudioToolsを使ったピン設定
-    auto cfg = i2s.defaultConfig();
-    cfg.sample_rate = 44100;
-    cfg.bits_per_sample = 32;
-    cfg.pin_bck = 16;
-    cfg.pin_ws = 17;
-    cfg.pin_data = 4;
-
-    if (!i2s.begin(cfg)) {
+    // I2S (PCM5102A: BCK=16, WS=17, DATA=4)
+    if (!i2s_out_begin(i2s, 44100)) {
         Serial.println("Failed to initialize I2S");
         while (true) {
             delay(1000);
@@ -220,13 +251,24 @@ void loop() {
     // --- Touch update ---
     uint16_t rawX = 0, rawY = 0;
     uint8_t gesture = 0;
-    bool pressed = touch.getTouch(&rawX, &rawY, &gesture);
-    if (pressed) {
-        uint16_t dispX = rawY;
-        uint16_t dispY = (tft.height() > 0) ? (tft.height() - 1 - rawX) : rawX;
-        if (dispX >= tft.width())  dispX = tft.width() - 1;
-        if (dispY >= tft.height()) dispY = tft.height() - 1;
-        snprintf(touchStatus, sizeof(touchStatus), "Touch: %3u,%3u g=%02X", dispX, dispY, gesture);
+    TouchPoint tp = {0, 0, false, now};
+    tp.pressed = touch.getTouch(&rawX, &rawY, &gesture);
+    if (tp.pressed) {
+        touch_affine_apply(touchCal, rawX, rawY, &tp.x, &tp.y);
+    }
+    touchFilter.process(tp);
+#if SD_LOG_ENABLE
+    static bool lastPressed = false;
+    if (tp.pressed != lastPressed) {
+        lastPressed = tp.pressed;
+        const int16_t ev[3] = {tp.x, tp.y, (int16_t)(tp.pressed ? 1 : 0)};
+        sdLog.append(SdLogType::Touch, ev, sizeof(ev));
+    }
+#endif
+    if (tp.pressed) {
+        int dispX = constrain(tp.x, 0, tft.width() - 1);
+        int dispY = constrain(tp.y, 0, tft.height() - 1);
+        snprintf(touchStatus, sizeof(touchStatus), "Touch: %3d,%3d g=%02X", dispX, dispY, gesture);
     } else {
         snprintf(touchStatus, sizeof(touchStatus), "Touch: --");
     }
@@ -241,8 +283,25 @@ void loop() {
     if (now - ts > 3000) {
         ts = now;
         print_mem("run");
+        const CST820Stats& ts_stats = touch.stats();
+        Serial.printf("[TOUCH] xfer=%u nak=%u short=%u timeout=%u recover=%u\n",
+                      (unsigned)ts_stats.transactions,
+                      (unsigned)ts_stats.naks,
+                      (unsigned)ts_stats.short_reads,
+                      (unsigned)ts_stats.timeouts,
+                      (unsigned)ts_stats.recoveries);
+#if SD_LOG_ENABLE
+        const uint32_t heap[3] = {(uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+                                  (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+                                  (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DMA)};
+        sdLog.append(SdLogType::Heap, heap, sizeof(heap));
+        const uint32_t audio[3] = {audioBytes, audioCallbacks, isA2dpConnected ? 1u : 0u};
+        sdLog.append(SdLogType::Audio, audio, sizeof(audio));
+        sdLog.report(Serial);
+#endif
         const char* status = isA2dpConnected ? "A2DP Connected" : "Waiting for A2DP...";
         drawStatusLine(statusLineY, status, lgfx::color565(0, 255, 128));
+        update_sd_status();
         drawStatusLine(sdLineY, sdStatus, lgfx::color565(255, 255, 0));
     }
 
@@ -13,7 +13,14 @@
 #define LV_COLOR_16_SWAP 1
 #define LV_COLOR_SCREEN_TRANSP 0
 
-#define LV_MEM_CUSTOM 0
+#define LV_MEM_CUSTOM 1
+/* lib/LvPool（小物はサイズクラス、それ以外は TLSF）。LV_MEM_SIZE はそのプールの大きさ */
+#define LV_MEM_CUSTOM_INCLUDE "LvPool.h"
+#define LV_MEM_CUSTOM_ALLOC   lv_pool_alloc
+#define LV_MEM_CUSTOM_FREE    lv_pool_free
+#define LV_MEM_CUSTOM_REALLOC lv_pool_realloc
+/* プールを heap_caps の領域に置く場合（既定は .bss の静的配列）
+ * #define LV_POOL_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) */
 #define LV_MEM_SIZE (48U * 1024U)
 
 #define LV_DISP_DEF_REFR_PERIOD 30
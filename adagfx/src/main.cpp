@@ -8,52 +8,38 @@
 #include <SD.h>
 #include <esp_heap_caps.h>
 #include <lvgl.h>
+#include "LvPool.h"   // lv_conf.h の LV_MEM_CUSTOM のアロケータ
 #include "CST820.h"
+#include "TouchFilter.h"
+#include "TouchAffine.h"
+#include "TouchCalibUi.h"
+#include "SdBench.h"
+#include "SdMount.h"
 
-#define TFT_CS   15
-#define TFT_DC    2
-#define TFT_RST  -1   // RST未接続なら -1
-#define TFT_BL   27
-#define TFT_SCLK 14
-#define TFT_MOSI 13
-#define TFT_MISO 12
+// ピン・クロックはボード特性（lib/Bsp/BoardTraits.h）から取る
+typedef bsp::Board::Tft TftPins;
+typedef bsp::Board::Sd SdPins;
+typedef bsp::Board::Touch TouchPins;
 
 // SPIバスを分離する:
-//  - TFT: HSPI (SCLK=14, MOSI=13, MISO=12, CS=15)
+//  - TFT: HSPI (SCLK=14, MOSI=13, CS=15。MISO は未使用)
 //  - SD : VSPI (SCLK=18, MOSI=23, MISO=19, CS=5)
 static SPIClass hspi(HSPI);
-Adafruit_ST7789 tft = Adafruit_ST7789(&hspi, TFT_CS, TFT_DC, TFT_RST);
+Adafruit_ST7789 tft = Adafruit_ST7789(&hspi, TftPins::kCs, TftPins::kDc, TftPins::kRst);
 
-// JC2432W328 (Capacitive) 既定ピン: SDA=33, SCL=32, RST=25, INT=21
-#ifndef TOUCH_SDA
-#define TOUCH_SDA 33
-#endif
-#ifndef TOUCH_SCL
-#define TOUCH_SCL 32
-#endif
-#ifndef TOUCH_RST
-#define TOUCH_RST 25
-#endif
-#ifndef TOUCH_INT
-#define TOUCH_INT 21
-#endif
-
-// Rotation=1想定の座標補正
-#ifndef TOUCH_SWAP_XY
-#define TOUCH_SWAP_XY 1
-#endif
-#ifndef TOUCH_FLIP_X
-#define TOUCH_FLIP_X 1
-#endif
-#ifndef TOUCH_FLIP_Y
-#define TOUCH_FLIP_Y 0
-#endif
-
-// 必要に応じてタッチ座標を180度回転
+// 必要に応じてタッチ座標を180度回転（キャリブレーション未保存時の既定行列を選ぶ）
 #ifndef TOUCH_ROTATE_180
 #define TOUCH_ROTATE_180 1
 #endif
 
+// タッチ生座標 → 画面座標（Rotation=1 想定。NVS にキャリブレーション結果があれば置き換える）
+//   基本回転: sx = rawY, sy = (240-1) - rawX / 180度補正: sx = (320-1) - rawY, sy = rawX
+#if TOUCH_ROTATE_180
+static TouchAffine touch_cal = touch_affine_make(0, -1, 320 - 1, 1, 0, 0);
+#else
+static TouchAffine touch_cal = touch_affine_make(0, 1, 0, -1, 0, 240 - 1);
+#endif
+
 static CST820* tp = nullptr;
 
 static void print_mem(const char* stage) {
@@ -175,17 +161,17 @@ void setup() {
   print_mem("boot");
 
   // TFT用: HSPIにピンを割り当て
-  hspi.begin(TFT_SCLK, TFT_MISO, TFT_MOSI, TFT_CS);
+  hspi.begin(TftPins::kSclk, TftPins::kMiso, TftPins::kMosi, TftPins::kCs);
 
   tft.init(240, 320);          // ST7789 240x320（ネイティブ）
   tft.setRotation(1);          // 横向き 320x240
-  tft.setSPISpeed(80000000);   // 80MHz（不安定なら 60MHz/40MHz に戻す）
+  tft.setSPISpeed(TftPins::kWriteHz);   // 既定 80MHz（不安定なら -D BSP_TFT_WRITE_HZ=40000000）
   tft.invertDisplay(false);    // 必要に応じて true に
   // tft.setColRowStart(x, y);  // ずれがある場合のみ有効化
 
   // バックライト
-  pinMode(TFT_BL, OUTPUT);
-  digitalWrite(TFT_BL, HIGH);
+  pinMode(TftPins::kBl, OUTPUT);
+  digitalWrite(TftPins::kBl, HIGH);
 
   // 追加のバックライト制御は不要
 
@@ -198,11 +184,12 @@ void setup() {
   print_mem("after_lvgl");
 
   // Touch開始（自動探索）
-  tp = new CST820(TOUCH_SDA, TOUCH_SCL, TOUCH_RST, TOUCH_INT, I2C_ADDR_CST820);
+  tp = new CST820();
   tp->begin();
+  touch_calib_load(&touch_cal);
   // 画面にも表示
   lv_obj_t* lbl = lv_label_create(lv_scr_act());
-  lv_label_set_text_fmt(lbl, "Touch: SDA=%u SCL=%u addr=0x%02X", (unsigned)TOUCH_SDA, (unsigned)TOUCH_SCL, (unsigned)I2C_ADDR_CST820);
+  lv_label_set_text_fmt(lbl, "Touch: SDA=%u SCL=%u addr=0x%02X", (unsigned)TouchPins::kSda, (unsigned)TouchPins::kScl, (unsigned)TouchPins::kAddr);
   lv_obj_align(lbl, LV_ALIGN_BOTTOM_LEFT, 4, -4);
 
   // LVGL input device登録
@@ -210,35 +197,48 @@ void setup() {
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = [](lv_indev_drv_t* drv, lv_indev_data_t* data) {
-    uint16_t rx, ry; uint8_t g;
-    bool pressed = false;
-    if (tp) pressed = tp->getTouch(&rx, &ry, &g);
-    if (!pressed) {
+    static TouchFilterDefault filter;
+    uint16_t rx = 0, ry = 0; uint8_t g = 0;
+    TouchPoint p = {0, 0, false, millis()};
+    if (tp) p.pressed = tp->getTouch(&rx, &ry, &g);
+    if (touch_calib_ui_active()) {
+      touch_calib_ui_feed(p.pressed, rx, ry);
       data->state = LV_INDEV_STATE_RELEASED;
       return;
     }
     // 座標補正（画面は setRotation(1) 横向き。タッチは縦向き基準）
-    // 基本回転: new_x = rawY, new_y = (240-1) - rawX
-    uint16_t sx = ry;
-    uint16_t sy = (uint16_t)(240 - 1) - rx;
-    // 180度ズレている場合の補正
-    #if TOUCH_ROTATE_180
-      sx = (uint16_t)(tft.width()  - 1) - sx;
-      sy = (uint16_t)(tft.height() - 1) - sy;
-    #endif
+    if (p.pressed) touch_affine_apply(touch_cal, rx, ry, &p.x, &p.y);
+    filter.process(p);
+    if (!p.pressed) {
+      data->state = LV_INDEV_STATE_RELEASED;
+      return;
+    }
     // 範囲クランプ
-    if (sx >= tft.width())  sx = tft.width() - 1;
-    if (sy >= tft.height()) sy = tft.height() - 1;
+    if (p.x < 0) p.x = 0;
+    if (p.y < 0) p.y = 0;
+    if (p.x >= tft.width())  p.x = tft.width() - 1;
+    if (p.y >= tft.height()) p.y = tft.height() - 1;
     data->state = LV_INDEV_STATE_PRESSED;
-    data->point.x = sx;
-    data->point.y = sy;
+    data->point.x = p.x;
+    data->point.y = p.y;
   };
   lv_indev_drv_register(&indev_drv);
 
+  // 起動時に画面を押したままならタッチのキャリブレーション画面を出す
+  {
+    uint16_t rx, ry; uint8_t g;
+    if (tp->getTouch(&rx, &ry, &g)) touch_calib_ui_start(&touch_cal);
+  }
+
   // SD (VSPI: SCK=18, MISO=19, MOSI=23, CS=5)
-  SPIClass sdSPI(VSPI);
-  sdSPI.begin(18, 19, 23, 5);
-  bool sd_ok = SD.begin(5, sdSPI, 10000000);
+  static SPIClass sdSPI(VSPI);  // SD はこのインスタンスを保持し続けるので static にする
+  sdSPI.begin(SdPins::kSck, SdPins::kMiso, SdPins::kMosi, SdPins::kCs);
+  SdMountResult sdm = sd_mount_auto(sdSPI, SdPins::kCs);
+  bool sd_ok = sdm.ok;
+  if (sd_ok) Serial.printf("[SD] %lu Hz%s\n", (unsigned long)sdm.hz, sdm.cached ? " (cached)" : "");
+#if SD_BENCH_ENABLE
+  if (sd_ok) sd_ok = sd_bench_run(sdSPI, sd_bench_default_config(SdPins::kCs, sdm.hz), Serial);
+#endif
   lv_obj_t* sd_lbl = lv_label_create(lv_scr_act());
   if (sd_ok) {
     // ルートを少し列挙
@@ -0,0 +1,89 @@
+#include "AssetPack.h"
+
+#ifdef ARDUINO
+#include <esp32/rom/crc.h>
+
+bool AssetPack::begin(const char* label) {
+    end();
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!part) return false;
+
+    // まずヘッダだけ読んで、必要な長さだけ map する
+    AssetPackHeader h;
+    if (esp_partition_read(part, 0, &h, sizeof(h)) != ESP_OK) return false;
+    if (memcmp(h.magic, ASSET_PACK_MAGIC, 4) != 0 || h.version != ASSET_PACK_VERSION ||
+        h.total_size > part->size || h.total_size < sizeof(h) + (uint32_t)h.count * sizeof(AssetEntry)) {
+        return false;
+    }
+
+    const void* ptr = nullptr;
+    if (esp_partition_mmap(part, 0, h.total_size, SPI_FLASH_MMAP_DATA, &ptr, &_handle) != ESP_OK) return false;
+    const uint8_t* base = static_cast<const uint8_t*>(ptr);
+    const AssetEntry* dir = reinterpret_cast<const AssetEntry*>(base + sizeof(AssetPackHeader));
+    if (crc32_le(0, reinterpret_cast<const uint8_t*>(dir), h.count * sizeof(AssetEntry)) != h.crc) {
+        spi_flash_munmap(_handle);
+        _handle = 0;
+        return false;
+    }
+    _base = base;
+    _hdr = reinterpret_cast<const AssetPackHeader*>(base);
+    _dir = dir;
+    return true;
+}
+
+void AssetPack::end() {
+    if (_handle) spi_flash_munmap(_handle);
+    _handle = 0;
+    _base = nullptr;
+    _hdr = nullptr;
+    _dir = nullptr;
+}
+
+const uint8_t* AssetPack::find(const char* name, uint32_t* size, const AssetEntry** out) const {
+    if (!_hdr) return nullptr;
+    const AssetEntry* e = asset_pack_lookup(_dir, _hdr->count, name);
+    if (!e) return nullptr;
+    if (size) *size = e->size;
+    if (out) *out = e;
+    return _base + e->offset;
+}
+
+void asset_pack_bench(const AssetPack& pack, fs::FS& sd, const char* sd_dir, Print& out) {
+    out.println("# assetbench begin");
+    out.println("name,bytes,mmap_us,sd_us,sd_open_us");
+    for (uint16_t i = 0; i < pack.count(); ++i) {
+        const AssetEntry* e = pack.entry(i);
+
+        // mmap: 参照を得て全バイトを読む（キャッシュミス込み）
+        uint32_t t0 = micros();
+        uint32_t crc_map = crc32_le(0, pack.data(e), e->size);
+        uint32_t mmap_us = micros() - t0;
+
+        // SD: 開いて RAM に読み込む
+        char path[64];
+        snprintf(path, sizeof(path), "%s/%s", sd_dir, e->name);
+        uint32_t sd_us = 0, open_us = 0;
+        bool sd_ok = false;
+        uint8_t* buf = static_cast<uint8_t*>(malloc(e->size));
+        if (buf) {
+            t0 = micros();
+            File f = sd.open(path, FILE_READ);
+            open_us = micros() - t0;
+            if (f) {
+                sd_ok = f.read(buf, e->size) == e->size;
+                f.close();
+                sd_us = micros() - t0;
+                sd_ok = sd_ok && crc32_le(0, buf, e->size) == crc_map;
+            }
+            free(buf);
+        }
+        if (sd_ok) {
+            out.printf("%s,%lu,%lu,%lu,%lu\n", e->name, (unsigned long)e->size,
+                       (unsigned long)mmap_us, (unsigned long)sd_us, (unsigned long)open_us);
+        } else {
+            out.printf("%s,%lu,%lu,,\n", e->name, (unsigned long)e->size, (unsigned long)mmap_us);
+        }
+    }
+    out.println("# assetbench end");
+}
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+
+// 読み出し専用のアセットパック（フォント・画像・UIテーブル）
+//   ヘッダ 16B + ディレクトリ 32B x count（名前順）+ データ（4B 境界）
+// spiffs パーティション（未使用）に書き込み、esp_partition_mmap でフラッシュキャッシュ越しに
+// そのまま参照する。find() が返すポインタは RAM へのコピーを伴わない。
+// 形式の定義は Arduino 非依存で、ホストのパッカー（tools/asset_pack.cpp）と共有する。
+
+#include <stdint.h>
+#include <string.h>
+
+#define ASSET_PACK_MAGIC   "APK1"
+#define ASSET_PACK_VERSION 1
+#define ASSET_NAME_MAX     20     // NUL を含む
+
+enum class AssetType : uint16_t { Raw = 0, Font = 1, Image = 2, Table = 3 };
+
+struct AssetPackHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t count;
+    uint32_t total_size;   // ヘッダからデータ末尾まで
+    uint32_t crc;          // ディレクトリの CRC32
+};
+
+struct AssetEntry {
+    char     name[ASSET_NAME_MAX];
+    uint32_t offset;       // パック先頭から
+    uint32_t size;
+    uint16_t type;         // AssetType
+    uint16_t flags;
+};
+
+// Image のデータ先頭に付く情報（画素は RGB565、LV_COLOR_16_SWAP に合わせてパック時に並べ替える）
+struct AssetImageInfo {
+    uint16_t w, h;
+    uint16_t swapped;      // 1 ならバイトスワップ済み
+    uint16_t reserved;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "AssetPackHeader layout");
+static_assert(sizeof(AssetEntry) == 32, "AssetEntry layout");
+static_assert(sizeof(AssetImageInfo) == 8, "AssetImageInfo layout");
+
+// 名前順のディレクトリを二分探索する
+inline const AssetEntry* asset_pack_lookup(const AssetEntry* dir, uint16_t count, const char* name) {
+    int lo = 0, hi = (int)count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = strncmp(name, dir[mid].name, ASSET_NAME_MAX);
+        if (c == 0) return &dir[mid];
+        if (c < 0) hi = mid - 1; else lo = mid + 1;
+    }
+    return nullptr;
+}
+
+#ifndef ASSET_BENCH_ENABLE
+#define ASSET_BENCH_ENABLE 0
+#endif
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <FS.h>
+#include <esp_partition.h>
+
+class AssetPack {
+public:
+    // label のパーティションを map する。パックが無い/壊れていれば false
+    bool begin(const char* label = "spiffs");
+    void end();
+
+    bool valid() const { return _hdr != nullptr; }
+    uint16_t count() const { return _hdr ? _hdr->count : 0; }
+    const AssetEntry* entry(uint16_t i) const { return (_hdr && i < _hdr->count) ? &_dir[i] : nullptr; }
+
+    // 見つからなければ nullptr。out にはディレクトリのエントリ（種類など）を返す
+    const uint8_t* find(const char* name, uint32_t* size = nullptr, const AssetEntry** out = nullptr) const;
+    const uint8_t* data(const AssetEntry* e) const { return _base + e->offset; }
+
+private:
+    const uint8_t* _base = nullptr;
+    const AssetPackHeader* _hdr = nullptr;
+    const AssetEntry* _dir = nullptr;
+    spi_flash_mmap_handle_t _handle = 0;
+};
+
+// 各アセットを mmap 経由で全バイト読む時間と、SD（sd_dir/名前）から RAM に読む時間を比べて CSV で出す
+void asset_pack_bench(const AssetPack& pack, fs::FS& sd, const char* sd_dir, Print& out);
+#endif
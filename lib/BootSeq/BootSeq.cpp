@@ -0,0 +1,121 @@
+#ifdef ARDUINO
+#include "BootSeq.h"
+#include <string.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+struct BootMark {
+    const char* name;
+    uint32_t us;
+};
+
+static BootMark marks[BOOT_MARK_MAX];
+static uint8_t mark_count = 0;
+
+static uint32_t now_us() { return (uint32_t)esp_timer_get_time(); }
+
+void boot_mark(const char* name) {
+    if (mark_count < BOOT_MARK_MAX) marks[mark_count++] = {name, now_us()};
+}
+
+uint32_t boot_mark_us(const char* name) {
+    for (uint8_t i = 0; i < mark_count; ++i) {
+        if (strcmp(marks[i].name, name) == 0) return marks[i].us;
+    }
+    return 0;
+}
+
+int BootSeq::add(const char* name, void (*fn)(), uint32_t deps, int8_t core, uint16_t stack) {
+    // EventGroup のビットは 24 本まで
+    if (_count >= BOOT_SEQ_MAX || _count >= 24 || (deps >> _count) != 0) return -1;
+    _stages[_count] = {name, fn, deps, core, stack, 0, 0, 0};
+    return _count++;
+}
+
+void BootSeq::exec(uint8_t i) {
+    BootStage& s = _stages[i];
+    s.ran_core = (uint8_t)xPortGetCoreID();
+    s.start_us = now_us();
+    s.fn();
+    s.end_us = now_us();
+}
+
+void BootSeq::task(void* arg) {
+    TaskArg* a = static_cast<TaskArg*>(arg);
+    a->seq->exec(a->index);
+    xEventGroupSetBits(a->seq->_done, BOOT_DEP(a->index));
+    vTaskDelete(nullptr);
+}
+
+void BootSeq::run(bool parallel) {
+    _parallel = parallel;
+    _start_us = now_us();
+    if (parallel && !_done) _done = xEventGroupCreate();
+    if (!parallel || !_done) {
+        _parallel = false;
+        for (uint8_t i = 0; i < _count; ++i) exec(i);
+        _end_us = now_us();
+        return;
+    }
+
+    const uint32_t all = _count ? (uint32_t)(BOOT_DEP(_count) - 1) : 0;
+    uint32_t started = 0;
+    for (;;) {
+        const uint32_t done = xEventGroupGetBits(_done) & all;
+        if (done == all) break;
+        // 依存が揃ったものを起動する。別タスクのものは全部、ここで実行するものは1つだけ
+        int here = -1;
+        for (uint8_t i = 0; i < _count; ++i) {
+            const BootStage& s = _stages[i];
+            if ((started & BOOT_DEP(i)) || (s.deps & done) != s.deps) continue;
+            if (s.core == BOOT_HERE) {
+                if (here < 0) here = i;
+                continue;
+            }
+            _args[i] = {this, i};
+            started |= BOOT_DEP(i);
+            if (xTaskCreatePinnedToCore(task, s.name, s.stack, &_args[i], uxTaskPriorityGet(nullptr), nullptr,
+                                        s.core) != pdPASS) {
+                // タスクが作れなければここで実行する
+                exec(i);
+                xEventGroupSetBits(_done, BOOT_DEP(i));
+            }
+        }
+        if (here >= 0) {
+            started |= BOOT_DEP(here);
+            exec((uint8_t)here);
+            xEventGroupSetBits(_done, BOOT_DEP(here));
+            continue;
+        }
+        // 走っているステージのどれかが終わるまで待つ
+        xEventGroupWaitBits(_done, all & ~done, pdFALSE, pdFALSE, portMAX_DELAY);
+    }
+    _end_us = now_us();
+}
+
+void BootSeq::report(Print& out) const {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < _count; ++i) {
+        const BootStage& s = _stages[i];
+        sum += s.end_us - s.start_us;
+        char deps[32] = "";
+        size_t n = 0;
+        for (uint8_t d = 0; d < i && n < sizeof(deps) - 1; ++d) {
+            if (!(s.deps & BOOT_DEP(d))) continue;
+            n += snprintf(deps + n, sizeof(deps) - n, "%s%u", n ? "," : "", (unsigned)d);
+        }
+        out.printf("[BOOT] %2u %-10s core%u %7.1f..%7.1fms %7.1fms deps=%s\n", (unsigned)i, s.name,
+                   (unsigned)s.ran_core, s.start_us / 1000.0f, s.end_us / 1000.0f, (s.end_us - s.start_us) / 1000.0f,
+                   n ? deps : "-");
+    }
+    out.printf("[BOOT] %s: wall=%.1fms stages_sum=%.1fms\n", _parallel ? "parallel" : "serial",
+               wall_us() / 1000.0f, sum / 1000.0f);
+}
+
+void boot_report(Print& out, const BootSeq* seq) {
+    if (seq) seq->report(out);
+    for (uint8_t i = 0; i < mark_count; ++i) {
+        out.printf("[BOOT] mark %-12s %8.1fms\n", marks[i].name, marks[i].us / 1000.0f);
+    }
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+// 起動処理をステージに分けて時間を測り、依存関係の許す範囲で両コアに並べて走らせる。
+//   BootSeq seq;
+//   int disp = seq.add("display", init_display);
+//   int bt   = seq.add("bt", init_bt, 0, 0);                       // コア 0 のタスクで（依存なし）
+//   int ui   = seq.add("lvgl", init_lvgl, BOOT_DEP(disp));          // 呼び出し元のタスクで
+//   seq.run(BOOT_PARALLEL);
+//   ... 最初の操作可能なフレームで boot_mark("first_frame")
+//   boot_report(Serial, &seq);
+// run(false) は登録順に呼び出し元で1つずつ実行する（並列化前と同じ順序。比較の基準）。
+// 時刻は esp_timer（アプリ起動時に 0。ブートローダの時間は含まない）。
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef BOOT_SEQ_MAX
+#define BOOT_SEQ_MAX 12
+#endif
+#ifndef BOOT_MARK_MAX
+#define BOOT_MARK_MAX 8
+#endif
+
+#define BOOT_DEP(i) (1u << (i))
+// 呼び出し元のタスクで実行する（LVGL など、ループと同じタスクで触る必要があるもの）
+#define BOOT_HERE (-1)
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+struct BootStage {
+    const char* name;
+    void (*fn)();
+    uint32_t deps;
+    int8_t core;        // BOOT_HERE / 0 / 1
+    uint16_t stack;
+    uint8_t ran_core;
+    uint32_t start_us;
+    uint32_t end_us;
+};
+
+class BootSeq {
+public:
+    // 戻り値はステージ番号（BOOT_DEP に渡す）。deps は登録済みのステージだけ指定できる。失敗時 -1
+    int add(const char* name, void (*fn)(), uint32_t deps = 0, int8_t core = BOOT_HERE, uint16_t stack = 4096);
+    // parallel=false なら登録順にこのタスクで実行
+    void run(bool parallel);
+    uint32_t wall_us() const { return _end_us - _start_us; }
+    void report(Print& out) const;
+
+private:
+    struct TaskArg {
+        BootSeq* seq;
+        uint8_t index;
+    };
+    static void task(void* arg);
+    void exec(uint8_t i);
+
+    BootStage _stages[BOOT_SEQ_MAX];
+    TaskArg _args[BOOT_SEQ_MAX];
+    uint8_t _count = 0;
+    EventGroupHandle_t _done = nullptr;
+    bool _parallel = false;
+    uint32_t _start_us = 0;
+    uint32_t _end_us = 0;
+};
+
+// 単発のタイムスタンプ（"setup" / "first_frame" など）
+void boot_mark(const char* name);
+uint32_t boot_mark_us(const char* name);
+// マークとステージの一覧（seq は省略可）
+void boot_report(Print& out, const BootSeq* seq = nullptr);
+#endif
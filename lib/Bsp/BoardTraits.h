@@ -0,0 +1,111 @@
+#pragma once
+
+// ボードのピン・バスクロック・パネルの癖を constexpr でまとめる（全ビルド共通）。
+//   各ビルドはピン番号を直接書かず bsp::Board::Tft::kSclk のように参照する。
+//   -1 は未接続。使う側の分岐が定数になるので、未使用の経路はコンパイラが落とす。
+//   ピンの重なりやクロックの食い違いは下の static_assert でコンパイルエラーになる。
+// 別の基板に載せる時は同じ形の struct を足して Board を切り替える。
+
+#include <stdint.h>
+
+// TFT の書き込みクロック。APB 80MHz を割り切れる値（80/40/20/16MHz...）。個体で不安定なら下げる
+#ifndef BSP_TFT_WRITE_HZ
+#define BSP_TFT_WRITE_HZ 80000000
+#endif
+// TFT の SPI モード（a2dp は従来どおり 3）
+#ifndef BSP_TFT_SPI_MODE
+#define BSP_TFT_SPI_MODE 0
+#endif
+
+// 外付け DAC の I2S ピン。配線がビルドごとに違うので -D で上書きする（lovgfx_a2dp は BCK=26, WS=22）
+#ifndef BSP_I2S_BCK
+#define BSP_I2S_BCK 16
+#endif
+#ifndef BSP_I2S_WS
+#define BSP_I2S_WS 17
+#endif
+#ifndef BSP_I2S_DATA
+#define BSP_I2S_DATA 4
+#endif
+
+namespace bsp {
+
+// JC2432W328C / ESP32-2432S028 系（CYD）: ST7789 240x320 + CST820
+struct Jc2432w328c {
+    // TFT（HSPI）。SCLK/MOSI/CS は HSPI の IO_MUX ピンなので 80MHz まで出せる
+    struct Tft {
+        static constexpr int8_t kSclk = 14;
+        static constexpr int8_t kMosi = 13;
+        static constexpr int8_t kMiso = -1;    // パネルは読まない（GPIO12 は起動時のストラップピン）
+        static constexpr int8_t kCs   = 15;
+        static constexpr int8_t kDc   = 2;
+        static constexpr int8_t kRst  = -1;    // EN と共通
+        static constexpr int8_t kBl   = 27;
+        static constexpr uint32_t kWriteHz = BSP_TFT_WRITE_HZ;
+        static constexpr uint32_t kReadHz  = 16000000;
+        static constexpr uint8_t kSpiMode  = BSP_TFT_SPI_MODE;
+        static constexpr uint32_t kBlPwmHz = 12000;   // 可聴域の外（A2DP 出力にうなりが乗らない）
+        // パネル: 240x320 縦置き、オフセットなし、反転なし、RGB 順、8bit コマンド
+        static constexpr uint16_t kWidth  = 240;
+        static constexpr uint16_t kHeight = 320;
+        static constexpr bool kInvert     = false;
+        static constexpr bool kRgbOrder   = false;
+        static constexpr bool kReadable   = false;
+        static constexpr bool kBusShared  = false;    // SD は VSPI で別バス
+    };
+
+    // タッチ（CST820, I2C）
+    struct Touch {
+        static constexpr int8_t kSda = 33;
+        static constexpr int8_t kScl = 32;
+        static constexpr int8_t kRst = 25;
+        static constexpr int8_t kInt = 21;
+        static constexpr uint8_t kAddr = 0x15;
+        static constexpr uint32_t kI2cHz = 400000;
+        static constexpr uint16_t kResetWaitMs = 300;   // リセット解除から応答するまで
+    };
+
+    // microSD（VSPI）
+    struct Sd {
+        static constexpr int8_t kSck  = 18;
+        static constexpr int8_t kMiso = 19;
+        static constexpr int8_t kMosi = 23;
+        static constexpr int8_t kCs   = 5;
+    };
+
+    // 外付け DAC（PCM5102A, I2S）
+    struct I2s {
+        static constexpr int8_t kBck  = BSP_I2S_BCK;
+        static constexpr int8_t kWs   = BSP_I2S_WS;
+        static constexpr int8_t kData = BSP_I2S_DATA;
+    };
+};
+
+typedef Jc2432w328c Board;
+
+// --- 整合性の確認（コンパイル時） ---
+constexpr bool pin_in(int) { return false; }
+template <class... T>
+constexpr bool pin_in(int p, int q, T... rest) { return p == q || pin_in(p, rest...); }
+
+constexpr bool pins_distinct() { return true; }
+template <class... T>
+constexpr bool pins_distinct(int p, T... rest) { return (p < 0 || !pin_in(p, rest...)) && pins_distinct(rest...); }
+
+// 34..39 は入力専用
+constexpr bool pin_output_ok(int p) { return p < 34; }
+
+static_assert(pins_distinct(Board::Tft::kSclk, Board::Tft::kMosi, Board::Tft::kMiso, Board::Tft::kCs,
+                            Board::Tft::kDc, Board::Tft::kRst, Board::Tft::kBl,
+                            Board::Touch::kSda, Board::Touch::kScl, Board::Touch::kRst, Board::Touch::kInt,
+                            Board::Sd::kSck, Board::Sd::kMiso, Board::Sd::kMosi, Board::Sd::kCs,
+                            Board::I2s::kBck, Board::I2s::kWs, Board::I2s::kData),
+              "board pins overlap");
+static_assert(pin_output_ok(Board::Tft::kBl) && pin_output_ok(Board::Touch::kRst) &&
+              pin_output_ok(Board::I2s::kBck) && pin_output_ok(Board::I2s::kWs) && pin_output_ok(Board::I2s::kData),
+              "output on an input-only pin");
+static_assert(Board::Tft::kWriteHz > 0 && Board::Tft::kWriteHz <= 80000000 && 80000000 % Board::Tft::kWriteHz == 0,
+              "TFT write clock must be 80MHz / n (otherwise it is silently rounded down)");
+static_assert(Board::Tft::kSpiMode <= 3, "SPI mode is 0..3");
+
+}  // namespace bsp
@@ -0,0 +1,68 @@
+#pragma once
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+#include "BoardTraits.h"
+
+// LovyanGFX の表示設定（ボード特性 bsp::Board::Tft から組み立てる。全 LovyanGFX ビルド共通）
+// 配線（TFT/HSPI）: SCLK=14, MOSI=13, MISO(未使用), CS=15, DC=2, BL=27
+
+template <class Tft>
+class LGFX_Board : public lgfx::LGFX_Device {
+  lgfx::Panel_ST7789  _panel;   // 240x320 ST7789
+  lgfx::Bus_SPI       _bus;     // HSPI
+  lgfx::Light_PWM     _light;   // Backlight
+
+public:
+  LGFX_Board(void) {
+    { // SPIバス設定
+      auto cfg = _bus.config();
+      cfg.spi_host    = HSPI_HOST;
+      cfg.spi_mode    = Tft::kSpiMode;
+      cfg.freq_write  = Tft::kWriteHz;
+      cfg.freq_read   = Tft::kReadHz;
+      cfg.spi_3wire   = false;
+      cfg.use_lock    = true;
+      cfg.dma_channel = SPI_DMA_CH_AUTO;
+      cfg.pin_sclk    = Tft::kSclk;
+      cfg.pin_mosi    = Tft::kMosi;
+      cfg.pin_miso    = Tft::kMiso;
+      cfg.pin_dc      = Tft::kDc;
+      _bus.config(cfg);
+      _panel.setBus(&_bus);
+    }
+
+    { // ディスプレイ設定（ST7789 は 240x320 の縦置きが基準。向きは setRotation で）
+      auto cfg = _panel.config();
+      cfg.pin_cs          = Tft::kCs;
+      cfg.pin_rst         = Tft::kRst;
+      cfg.pin_busy        = -1;
+      cfg.memory_width    = Tft::kWidth;
+      cfg.memory_height   = Tft::kHeight;
+      cfg.panel_width     = Tft::kWidth;
+      cfg.panel_height    = Tft::kHeight;
+      cfg.offset_x        = 0;
+      cfg.offset_y        = 0;
+      cfg.offset_rotation = 0;
+      cfg.readable        = Tft::kReadable;
+      cfg.invert          = Tft::kInvert;
+      cfg.rgb_order       = Tft::kRgbOrder;
+      cfg.dlen_16bit      = false;
+      cfg.bus_shared      = Tft::kBusShared;
+      _panel.config(cfg);
+    }
+
+    { // バックライト設定
+      auto cfg = _light.config();
+      cfg.pin_bl = Tft::kBl;
+      cfg.freq   = Tft::kBlPwmHz;
+      _light.config(cfg);
+      _panel.setLight(&_light);
+    }
+
+    setPanel(&_panel);
+  }
+};
+
+typedef LGFX_Board<bsp::Board::Tft> LGFX;
@@ -0,0 +1,185 @@
+#ifndef _CST820_H
+#define _CST820_H
+
+// CST820 静電タッチ（I2C）。ピンとアドレスはボード特性（BoardTraits.h）から取るのでヘッダだけで完結する。
+//   static CST820 tp;           // bsp::Board::Touch のピン
+//   tp.begin();                 // リセット解除後 kResetWaitMs 待つ
+//   tp.getTouch(&x, &y, &g);
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Wire.h>
+#endif  // ホストでは Arduino の関数と Wire を先に宣言してから読み込む（tools/cst820_mock.cpp）
+
+#include "BoardTraits.h"
+
+#define I2C_ADDR_CST820 0x15
+
+// 1トランザクションあたりの上限（ms）と、バス復旧に入るまでの連続失敗回数
+#ifndef CST820_I2C_TIMEOUT_MS
+#define CST820_I2C_TIMEOUT_MS 10
+#endif
+#ifndef CST820_I2C_RETRY
+#define CST820_I2C_RETRY 2
+#endif
+#ifndef CST820_RECOVER_AFTER
+#define CST820_RECOVER_AFTER 3
+#endif
+
+enum class CST820Gesture : uint8_t {
+    None        = 0x00,
+    SlideDown   = 0x01,
+    SlideUp     = 0x02,
+    SlideLeft   = 0x03,
+    SlideRight  = 0x04,
+    SingleTap   = 0x05,
+    DoubleTap   = 0x0B,
+    LongPress   = 0x0C
+};
+
+struct CST820Stats {
+    uint32_t transactions;  // 発行したI2Cトランザクション数
+    uint32_t naks;          // NAK/バスエラー
+    uint32_t short_reads;   // 要求バイト数に満たなかった読み出し
+    uint32_t timeouts;      // 時間上限を超えて諦めた読み出し
+    uint32_t recoveries;    // SDA張り付きからのバス復旧回数
+};
+
+// Pins: kSda / kScl / kRst / kInt（-1 で未接続）/ kAddr / kI2cHz / kResetWaitMs
+template <class Pins>
+class CST820Driver {
+public:
+    void begin();
+    bool getTouch(uint16_t* x, uint16_t* y, uint8_t* gesture);
+
+    // true: 0x01..0x06 を1回で読む（既定） / false: レジスタ毎に個別に読む
+    void setBurstRead(bool enable) { _burst = enable; }
+    const CST820Stats& stats() const { return _stats; }
+
+private:
+    bool _burst = true;
+    uint8_t _fail_streak = 0;
+    CST820Stats _stats = {};
+    void bus_begin();
+    bool i2c_read_regs(uint8_t reg, uint8_t* data, uint8_t len);
+    void i2c_write(uint8_t reg, uint8_t val);
+    void bus_recover();
+};
+
+typedef CST820Driver<bsp::Board::Touch> CST820;
+
+template <class Pins>
+void CST820Driver<Pins>::bus_begin() {
+    if (Pins::kSda >= 0 && Pins::kScl >= 0) Wire.begin(Pins::kSda, Pins::kScl);
+    else Wire.begin();
+    Wire.setClock(Pins::kI2cHz);
+    Wire.setTimeOut(CST820_I2C_TIMEOUT_MS);
+}
+
+template <class Pins>
+void CST820Driver<Pins>::begin() {
+    bus_begin();
+    if (Pins::kInt >= 0) {
+        pinMode(Pins::kInt, OUTPUT);
+        digitalWrite(Pins::kInt, HIGH); delay(1);
+        digitalWrite(Pins::kInt, LOW);  delay(1);
+    }
+    if (Pins::kRst >= 0) {
+        pinMode(Pins::kRst, OUTPUT);
+        digitalWrite(Pins::kRst, LOW); delay(10);
+        digitalWrite(Pins::kRst, HIGH); delay(Pins::kResetWaitMs);
+    }
+    i2c_write(0xFE, 0xFF);  // disable auto low power
+}
+
+template <class Pins>
+bool CST820Driver<Pins>::getTouch(uint16_t* x, uint16_t* y, uint8_t* gesture) {
+    // data: [0]=gesture(0x01) [1]=finger(0x02) [2..5]=XH,XL,YH,YL(0x03..0x06)
+    uint8_t data[6] = {0};
+    bool ok;
+    if (_burst) {
+        ok = i2c_read_regs(0x01, data, sizeof(data));
+    } else {
+        ok = i2c_read_regs(0x02, &data[1], 1)
+          && i2c_read_regs(0x01, &data[0], 1)
+          && i2c_read_regs(0x03, &data[2], 4);
+    }
+    if (!ok) {
+        // 読めなかったサンプルは「離した」として扱い、UIスレッドを止めない
+        if (gesture) *gesture = static_cast<uint8_t>(CST820Gesture::None);
+        return false;
+    }
+    if (gesture) *gesture = data[0];
+    if (x) *x = ((data[2] & 0x0F) << 8) | data[3];
+    if (y) *y = ((data[4] & 0x0F) << 8) | data[5];
+    return data[1] != 0;
+}
+
+template <class Pins>
+bool CST820Driver<Pins>::i2c_read_regs(uint8_t reg, uint8_t* data, uint8_t len) {
+    const uint32_t start = millis();
+    for (uint8_t attempt = 0; attempt <= CST820_I2C_RETRY; ++attempt) {
+        _stats.transactions++;
+        Wire.beginTransmission(Pins::kAddr);
+        Wire.write(reg);
+        const uint8_t err = Wire.endTransmission(false);
+        if (err == 0) {
+            const uint8_t cnt = Wire.requestFrom(Pins::kAddr, len);
+            if (cnt == len) {
+                for (uint8_t i = 0; i < len; ++i) data[i] = Wire.read();
+                _fail_streak = 0;
+                return true;
+            }
+            _stats.short_reads++;
+            while (Wire.available()) Wire.read();
+        } else if (err == 5) {
+            _stats.timeouts++;
+        } else {
+            _stats.naks++;
+        }
+        if (millis() - start >= CST820_I2C_TIMEOUT_MS) {
+            if (err != 5) _stats.timeouts++;   // endTransmission のタイムアウトは数え済み
+            break;
+        }
+    }
+    if (++_fail_streak >= CST820_RECOVER_AFTER) {
+        _fail_streak = 0;
+        bus_recover();
+    }
+    return false;
+}
+
+template <class Pins>
+void CST820Driver<Pins>::i2c_write(uint8_t reg, uint8_t val) {
+    Wire.beginTransmission(Pins::kAddr);
+    Wire.write(reg);
+    Wire.write(val);
+    Wire.endTransmission();
+}
+
+// スレーブがSDAをLowに掴んだままの場合、SCLを最大9クロック送ってからSTOPを出す。
+// ピンは Wire を外してから触り、SDA が離れていた場合も含めて必ず Wire を掛け直す
+template <class Pins>
+void CST820Driver<Pins>::bus_recover() {
+    if (Pins::kSda < 0 || Pins::kScl < 0) return;
+    Wire.end();
+    pinMode(Pins::kSda, INPUT_PULLUP);
+    if (digitalRead(Pins::kSda) == LOW) {
+        _stats.recoveries++;
+        pinMode(Pins::kScl, OUTPUT_OPEN_DRAIN);
+        digitalWrite(Pins::kScl, HIGH);
+        for (int i = 0; i < 9 && digitalRead(Pins::kSda) == LOW; ++i) {
+            digitalWrite(Pins::kScl, LOW);  delayMicroseconds(5);
+            digitalWrite(Pins::kScl, HIGH); delayMicroseconds(5);
+        }
+        // STOP: SCL=Low で SDA=Low → SCL=High → SDA=High
+        digitalWrite(Pins::kScl, LOW);  delayMicroseconds(5);
+        pinMode(Pins::kSda, OUTPUT_OPEN_DRAIN);
+        digitalWrite(Pins::kSda, LOW);  delayMicroseconds(5);
+        digitalWrite(Pins::kScl, HIGH); delayMicroseconds(5);
+        digitalWrite(Pins::kSda, HIGH); delayMicroseconds(5);
+    }
+    bus_begin();
+}
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+// 確保中のポインタ → (サイズ, タグ) の固定長ハッシュ表（HeapTrack の free 側で使う）。
+// 開番地法（線形探査）で、削除は後ろの要素を詰め直すので墓標が溜まらない。
+// 満杯に近づいたら（7/8）put は失敗し、その確保は集計から外れる。
+// Arduino 非依存。排他は呼び出し側で行う。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+template <uint16_t N>
+class HeapTagTable {
+    static_assert(N >= 16 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+    HeapTagTable() { clear(); }
+
+    void clear() {
+        memset(_key, 0, sizeof(_key));
+        _count = 0;
+    }
+
+    // size は 16MB 未満（上位 8bit にタグを詰める）
+    bool put(uintptr_t p, uint32_t size, uint8_t tag) {
+        if (!p || _count >= N - N / 8) return false;
+        uint16_t i = home(p);
+        while (_key[i] && _key[i] != p) i = (i + 1) & (N - 1);
+        if (!_key[i]) ++_count;
+        _key[i] = p;
+        _val[i] = (size & 0xFFFFFF) | ((uint32_t)tag << 24);
+        return true;
+    }
+
+    bool take(uintptr_t p, uint32_t* size, uint8_t* tag) {
+        if (!p) return false;
+        uint16_t i = home(p);
+        while (_key[i] != p) {
+            if (!_key[i]) return false;
+            i = (i + 1) & (N - 1);
+        }
+        *size = _val[i] & 0xFFFFFF;
+        *tag = (uint8_t)(_val[i] >> 24);
+        // i を空けて、探査列が途切れないように後ろの要素を前へ寄せる
+        uint16_t j = i;
+        for (;;) {
+            j = (j + 1) & (N - 1);
+            if (!_key[j]) break;
+            const uint16_t k = home(_key[j]);
+            // k が (i, j] の範囲（循環）にあれば j はそのままでよい
+            if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) continue;
+            _key[i] = _key[j];
+            _val[i] = _val[j];
+            i = j;
+        }
+        _key[i] = 0;
+        --_count;
+        return true;
+    }
+
+    uint16_t count() const { return _count; }
+    static constexpr uint16_t capacity() { return N; }
+
+private:
+    static uint16_t home(uintptr_t p) {
+        uint32_t h = (uint32_t)(p >> 2) * 2654435761u;
+        h ^= h >> 15;
+        return (uint16_t)(h & (N - 1));
+    }
+
+    uintptr_t _key[N];
+    uint32_t _val[N];
+    uint16_t _count;
+};
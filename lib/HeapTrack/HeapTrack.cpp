@@ -0,0 +1,237 @@
+#ifdef ARDUINO
+#include "HeapTrack.h"
+#include <string.h>
+#include <esp_heap_caps.h>
+
+static uint8_t frag_max = 0;        // 内部 DRAM の断片化の最大値
+static uint32_t largest_min = 0;    // 内部 DRAM の最大ブロックの最小値
+
+HeapFragStats heap_frag_sample(uint32_t caps) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    HeapFragStats s;
+    s.free = info.total_free_bytes;
+    s.largest = info.largest_free_block;
+    s.free_blocks = info.free_blocks;
+    s.used_blocks = info.allocated_blocks;
+    s.frag_pct = s.free ? (uint8_t)(100 - (uint64_t)s.largest * 100 / s.free) : 0;
+    return s;
+}
+
+void heap_track_tick(uint32_t period_ms) {
+    static uint32_t last = 0;
+    const uint32_t now = millis();
+    if (last && now - last < period_ms) return;
+    last = now;
+    const HeapFragStats s = heap_frag_sample(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (s.frag_pct > frag_max) frag_max = s.frag_pct;
+    if (!largest_min || s.largest < largest_min) largest_min = s.largest;
+}
+
+#if HEAP_TRACK_ENABLE
+#include "HeapTagTable.h"
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+void __real_free(void* p);
+}
+
+struct HeapBinding {
+    TaskHandle_t task;
+    uint8_t tag;
+};
+
+static portMUX_TYPE track_mux = portMUX_INITIALIZER_UNLOCKED;
+static HeapTagTable<HEAP_TRACK_SLOTS> table;
+static HeapTagStats tags[HEAP_TRACK_TAGS];
+static uint8_t tag_count = 1;       // 0 番はタグなし
+static HeapBinding bindings[HEAP_TRACK_BINDINGS];
+static uint32_t dropped = 0;        // 表があふれて数えられなかった確保
+
+// 今のタスクのタグ（結び付けが無ければ 0）。確保のたびに通るので線形探索で済む数に抑える
+static uint8_t current_tag() {
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < HEAP_TRACK_BINDINGS; ++i) {
+        if (bindings[i].task == self && bindings[i].tag) return bindings[i].tag;
+    }
+    return 0;
+}
+
+static void track_alloc(void* p, size_t size, uint8_t tag) {
+    if (!p || !tag) return;
+    portENTER_CRITICAL(&track_mux);
+    if (table.put((uintptr_t)p, (uint32_t)size, tag)) {
+        HeapTagStats& t = tags[tag];
+        t.live += (uint32_t)size;
+        if (t.live > t.peak) t.peak = t.live;
+        ++t.allocs;
+    } else {
+        ++dropped;
+    }
+    portEXIT_CRITICAL(&track_mux);
+}
+
+// 数えていた確保なら外してタグを返す（数えていなければ 0）
+static uint8_t track_free(void* p, uint32_t* size) {
+    uint8_t tag = 0;
+    *size = 0;
+    if (!p) return 0;
+    portENTER_CRITICAL(&track_mux);
+    if (table.take((uintptr_t)p, size, &tag)) {
+        HeapTagStats& t = tags[tag];
+        t.live -= *size;
+        ++t.frees;
+    }
+    portEXIT_CRITICAL(&track_mux);
+    return tag;
+}
+
+extern "C" void* __wrap_malloc(size_t size) {
+    void* p = __real_malloc(size);
+    track_alloc(p, size, current_tag());
+    return p;
+}
+
+extern "C" void* __wrap_calloc(size_t n, size_t size) {
+    void* p = __real_calloc(n, size);
+    track_alloc(p, n * size, current_tag());
+    return p;
+}
+
+extern "C" void* __wrap_realloc(void* p, size_t size) {
+    if (!p) return __wrap_malloc(size);
+    uint32_t old_size;
+    uint8_t tag = track_free(p, &old_size);
+    void* q = __real_realloc(p, size);
+    if (!q) {
+        // 失敗時は元の領域が残る（size 0 の解放を除く）
+        if (size) track_alloc(p, old_size, tag);
+        return nullptr;
+    }
+    track_alloc(q, size, tag ? tag : current_tag());
+    return q;
+}
+
+extern "C" void __wrap_free(void* p) {
+    uint32_t size;
+    track_free(p, &size);
+    __real_free(p);
+}
+
+uint8_t heap_track_tag(const char* name) {
+    uint8_t tag = 0;
+    portENTER_CRITICAL(&track_mux);
+    for (uint8_t i = 1; i < tag_count; ++i) {
+        if (strcmp(tags[i].name, name) == 0) { tag = i; break; }
+    }
+    if (!tag && tag_count < HEAP_TRACK_TAGS) {
+        tag = tag_count++;
+        tags[tag].name = name;
+    }
+    portEXIT_CRITICAL(&track_mux);
+    return tag;
+}
+
+uint8_t heap_track_bind(TaskHandle_t task, uint8_t tag) {
+    uint8_t prev = 0;
+    portENTER_CRITICAL(&track_mux);
+    HeapBinding* slot = nullptr;
+    for (uint8_t i = 0; i < HEAP_TRACK_BINDINGS; ++i) {
+        if (bindings[i].task == task) { slot = &bindings[i]; break; }
+        if (!slot && !bindings[i].tag) slot = &bindings[i];
+    }
+    if (slot && slot->task == task) prev = slot->tag;
+    if (slot) {
+        slot->task = tag ? task : nullptr;
+        slot->tag = tag;
+    }
+    portEXIT_CRITICAL(&track_mux);
+    return prev;
+}
+
+bool heap_track_bind(const char* task_name, const char* tag_name) {
+    const TaskHandle_t task = xTaskGetHandle(task_name);
+    if (!task) return false;
+    heap_track_bind(task, heap_track_tag(tag_name));
+    return true;
+}
+
+void heap_track_set(const char* name) {
+    heap_track_bind(xTaskGetCurrentTaskHandle(), name ? heap_track_tag(name) : 0);
+}
+
+bool heap_track_get(uint8_t tag, HeapTagStats* out) {
+    if (tag == 0 || tag >= tag_count) return false;
+    portENTER_CRITICAL(&track_mux);
+    *out = tags[tag];
+    portEXIT_CRITICAL(&track_mux);
+    return true;
+}
+#endif
+
+void heap_track_reset_peaks() {
+#if HEAP_TRACK_ENABLE
+    portENTER_CRITICAL(&track_mux);
+    for (uint8_t i = 1; i < tag_count; ++i) tags[i].peak = tags[i].live;
+    portEXIT_CRITICAL(&track_mux);
+#endif
+    frag_max = 0;
+    largest_min = 0;
+}
+
+static void report_frag(Print& out, const char* name, uint32_t caps) {
+    const HeapFragStats s = heap_frag_sample(caps);
+    if (!s.free && !s.used_blocks) return;
+    out.printf("[HEAP] %-8s free=%6.1fKB largest=%6.1fKB frag=%3u%% blocks free/used=%lu/%lu\n", name,
+               s.free / 1024.0f, s.largest / 1024.0f, (unsigned)s.frag_pct, (unsigned long)s.free_blocks,
+               (unsigned long)s.used_blocks);
+}
+
+void heap_track_report(Print& out) {
+    heap_track_tick(0);
+#if HEAP_TRACK_ENABLE
+    HeapTagStats snap[HEAP_TRACK_TAGS];
+    uint8_t n;
+    uint32_t drop, tracked = 0;
+    uint16_t slots;
+    portENTER_CRITICAL(&track_mux);
+    n = tag_count;
+    memcpy(snap, tags, sizeof(snap));
+    drop = dropped;
+    slots = table.count();
+    portEXIT_CRITICAL(&track_mux);
+    out.printf("[HEAP] %-8s %8s %8s %7s %7s\n", "tag", "liveKB", "peakKB", "allocs", "frees");
+    for (uint8_t i = 1; i < n; ++i) {
+        out.printf("[HEAP] %-8s %8.1f %8.1f %7lu %7lu\n", snap[i].name, snap[i].live / 1024.0f,
+                   snap[i].peak / 1024.0f, (unsigned long)snap[i].allocs, (unsigned long)snap[i].frees);
+        tracked += snap[i].live;
+    }
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    const uint32_t used = info.total_allocated_bytes;
+    out.printf("[HEAP] %-8s %8.1f          (untagged + heap_caps_malloc direct) slots=%u/%u dropped=%lu\n", "other",
+               (used > tracked ? used - tracked : 0) / 1024.0f, (unsigned)slots, (unsigned)HEAP_TRACK_SLOTS,
+               (unsigned long)drop);
+#endif
+    report_frag(out, "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    report_frag(out, "dma", MALLOC_CAP_DMA);
+    report_frag(out, "psram", MALLOC_CAP_SPIRAM);
+    out.printf("[HEAP] internal frag_max=%u%% largest_min=%.1fKB min_free=%.1fKB\n", (unsigned)frag_max,
+               largest_min / 1024.0f, heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) / 1024.0f);
+}
+
+bool heap_track_command(const char* line, Print& out) {
+    if (strncmp(line, "mem", 3) != 0 || (line[3] && line[3] != ' ')) return false;
+    const char* arg = line + 3;
+    while (*arg == ' ') ++arg;
+    if (strcmp(arg, "reset") == 0) {
+        heap_track_reset_peaks();
+        out.println("[HEAP] peaks reset");
+    } else {
+        heap_track_report(out);
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+// ヒープの使い道をサブシステムごとに数える。
+//   タグ付け : -D HEAP_TRACK_ENABLE=1 と、リンカの --wrap（malloc/calloc/realloc/free）を両方指定したときだけ有効。
+//              確保したタスクに結び付いたタグ（HEAP_TRACK_BIND / HEAP_TRACK_SCOPE）で、生存バイトと最大値を数える。
+//              heap_caps_malloc を直接呼ぶ確保（DMA バッファなど）は数えず、report の "other" に入る。
+//   断片化   : heap_caps_get_info で空き容量と最大ブロックを取り、frag = 1 - largest / free [%] を出す（常に使える）。
+// 無効時はタグ付けのマクロが空になり、malloc は素通り（--wrap も付けない）。
+//
+//   platformio.ini の build_flags:
+//     -D HEAP_TRACK_ENABLE=1
+//     -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc -Wl,--wrap=free
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef HEAP_TRACK_ENABLE
+#define HEAP_TRACK_ENABLE 0
+#endif
+// タグの数（0 番は「タグなし」）
+#ifndef HEAP_TRACK_TAGS
+#define HEAP_TRACK_TAGS 8
+#endif
+// 追跡できる確保の数（2 のべき乗。1 つ 8 バイト）
+#ifndef HEAP_TRACK_SLOTS
+#define HEAP_TRACK_SLOTS 1024
+#endif
+// タスクとタグの結び付けの数
+#ifndef HEAP_TRACK_BINDINGS
+#define HEAP_TRACK_BINDINGS 12
+#endif
+
+struct HeapTagStats {
+    const char* name;
+    uint32_t live;     // 生存バイト（要求サイズの合計）
+    uint32_t peak;     // live の最大値（heap_track_reset_peaks まで）
+    uint32_t allocs;
+    uint32_t frees;
+};
+
+struct HeapFragStats {
+    uint32_t free;
+    uint32_t largest;
+    uint32_t free_blocks;
+    uint32_t used_blocks;
+    uint8_t  frag_pct;       // 100 * (1 - largest / free)
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// caps の領域をたどって断片化を測る
+HeapFragStats heap_frag_sample(uint32_t caps);
+// 周期的に呼ぶ（断片化の最大値と最大ブロックの最小値を残す）。period_ms 未満の間隔なら何もしない
+void heap_track_tick(uint32_t period_ms = 1000);
+void heap_track_reset_peaks();
+void heap_track_report(Print& out);
+// シリアルのコマンド行: "mem" で report、"mem reset" で最大値をリセット。扱ったら true
+bool heap_track_command(const char* line, Print& out);
+
+#if HEAP_TRACK_ENABLE
+// 名前を登録してタグ番号を返す（同じ名前は同じ番号。あふれたら 0）
+uint8_t heap_track_tag(const char* name);
+// task の確保を tag に数える（tag 0 で解除）。前の tag を返す
+uint8_t heap_track_bind(TaskHandle_t task, uint8_t tag);
+// 名前でタスクを探して結び付ける（見つからなければ false）
+bool heap_track_bind(const char* task_name, const char* tag_name);
+// 今のタスクを name に結び付ける（nullptr で解除）。setup の区切りごとに切り替える用
+void heap_track_set(const char* name);
+bool heap_track_get(uint8_t tag, HeapTagStats* out);
+
+// スコープの間だけ、今のタスクの確保を name に数える
+class HeapTrackScope {
+public:
+    explicit HeapTrackScope(const char* name)
+        : _prev(heap_track_bind(xTaskGetCurrentTaskHandle(), heap_track_tag(name))) {}
+    ~HeapTrackScope() { heap_track_bind(xTaskGetCurrentTaskHandle(), _prev); }
+private:
+    uint8_t _prev;
+};
+
+#define HEAP_TRACK_CAT2(a, b) a##b
+#define HEAP_TRACK_CAT(a, b) HEAP_TRACK_CAT2(a, b)
+#define HEAP_TRACK_SCOPE(name)           HeapTrackScope HEAP_TRACK_CAT(heap_track_scope_, __LINE__)(name)
+#define HEAP_TRACK_BIND(task_name, name) heap_track_bind((task_name), (name))
+#define HEAP_TRACK_SET(name)             heap_track_set(name)
+#else
+#define HEAP_TRACK_SCOPE(name)           ((void)0)
+#define HEAP_TRACK_BIND(task_name, name) ((void)(task_name), (void)(name), false)
+#define HEAP_TRACK_SET(name)             ((void)0)
+#endif
+#endif
@@ -0,0 +1,93 @@
+#ifdef ARDUINO
+#include "I2sJitter.h"
+
+// 書き込みタスクが一度に扱う量（16bit ステレオで 256 フレーム ≒ 5.8ms）
+#define I2S_JITTER_CHUNK 1024
+
+bool I2sJitter::begin(audio_tools::I2SStream& i2s, uint8_t* storage, size_t size,
+                      UBaseType_t priority, BaseType_t core) {
+    if (!storage || size < I2S_JITTER_CHUNK * 2) return false;
+    _i2s = &i2s;
+    _size = size;
+    _sb = xStreamBufferCreateStatic(size, 1, storage, &_sb_buf);
+    _stats.size = (uint32_t)size;
+    _stats.min_level = (uint32_t)size;
+    return _sb && xTaskCreatePinnedToCore(task, "i2s_jit", 3072, this, priority, nullptr, core) == pdPASS;
+}
+
+void I2sJitter::push(const uint8_t* data, size_t len) {
+    if (!_sb) return;
+    const uint32_t now = millis();
+    // フレームの途中で切らないよう、入りきらないときは丸ごと捨てる
+    const bool fits = xStreamBufferSpacesAvailable(_sb) >= len;
+    if (fits) xStreamBufferSend(_sb, data, len, 0);
+    portENTER_CRITICAL(&_mux);
+    if (_active && now - _last_push > _stats.max_gap_ms) _stats.max_gap_ms = now - _last_push;
+    if (!fits) ++_stats.overflows;
+    portEXIT_CRITICAL(&_mux);
+    _last_push = now;
+    _active = true;
+}
+
+void I2sJitter::idle() {
+    _active = false;
+}
+
+I2sJitterStats I2sJitter::stats() {
+    portENTER_CRITICAL(&_mux);
+    I2sJitterStats s = _stats;
+    portEXIT_CRITICAL(&_mux);
+    s.level = _sb ? (uint32_t)xStreamBufferBytesAvailable(_sb) : 0;
+    return s;
+}
+
+void I2sJitter::reset_window() {
+    const uint32_t level = _sb ? (uint32_t)xStreamBufferBytesAvailable(_sb) : 0;
+    portENTER_CRITICAL(&_mux);
+    _stats.min_level = level;
+    _stats.max_gap_ms = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void I2sJitter::task(void* arg) {
+    static_cast<I2sJitter*>(arg)->loop();
+}
+
+void I2sJitter::loop() {
+    static int16_t chunk[I2S_JITTER_CHUNK / sizeof(int16_t)];
+    std::vector<int32_t> buf;
+    const size_t prebuffer = _size * I2S_JITTER_PREBUFFER_PCT / 100;
+    bool playing = false;
+    for (;;) {
+        if (!playing) {
+            if (!_active || xStreamBufferBytesAvailable(_sb) < prebuffer) {
+                vTaskDelay(pdMS_TO_TICKS(5));
+                continue;
+            }
+            playing = true;
+            portENTER_CRITICAL(&_mux);
+            _stats.playing = true;
+            portEXIT_CRITICAL(&_mux);
+        }
+        size_t n = xStreamBufferReceive(_sb, chunk, sizeof(chunk), 0);
+        if (n == 0) {
+            portENTER_CRITICAL(&_mux);
+            if (_active) ++_stats.underruns;
+            _stats.playing = false;
+            _stats.min_level = 0;
+            portEXIT_CRITICAL(&_mux);
+            playing = false;
+            // 古い DMA バッファを繰り返さないよう無音で埋めて溜まるのを待つ
+            memset(chunk, 0, sizeof(chunk));
+            i2s_out_write16(*_i2s, chunk, sizeof(chunk) / sizeof(int16_t), 2, buf);
+            continue;
+        }
+        const uint32_t level = (uint32_t)xStreamBufferBytesAvailable(_sb);
+        portENTER_CRITICAL(&_mux);
+        if (level < _stats.min_level) _stats.min_level = level;
+        portEXIT_CRITICAL(&_mux);
+        // I2S の DMA が空くまでここで待つ（再生速度で回る）
+        i2s_out_write16(*_i2s, chunk, n / sizeof(int16_t), 2, buf);
+    }
+}
+#endif
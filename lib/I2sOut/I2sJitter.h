@@ -0,0 +1,59 @@
+#pragma once
+
+// A2DP などのバースト的な PCM を一度リングに溜めてから I2S に流す。
+// push() は BT のコールバックから呼ぶ（待たない。入りきらない分は捨てて overflows に数える）。
+// 書き込みタスクがリングから I2S へ書き、再生中にリングが空になったら無音を書いて underruns に数える。
+// リングは CPU しか触らないので DMA 不可の領域でよい（MemBudget の NoDma）。DMA は I2S ドライバのバッファだけ。
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 再生開始（とアンダーラン後の再開）までに溜める割合
+#ifndef I2S_JITTER_PREBUFFER_PCT
+#define I2S_JITTER_PREBUFFER_PCT 50
+#endif
+
+struct I2sJitterStats {
+    uint32_t underruns;     // 再生中にリングが空になった回数
+    uint32_t overflows;     // push で入りきらずに捨てた回数
+    uint32_t level;         // 現在のリング残量 [bytes]
+    uint32_t min_level;     // 再生中の最小残量（reset_window() 以降）
+    uint32_t size;
+    uint32_t max_gap_ms;    // push の間隔の最大（reset_window() 以降）
+    bool     playing;
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/stream_buffer.h>
+#include <freertos/task.h>
+#include "I2sOut.h"
+
+class I2sJitter {
+public:
+    // storage は size+1 バイト（StreamBuffer の仕様）。タスクは core 1 に作る
+    bool begin(audio_tools::I2SStream& i2s, uint8_t* storage, size_t size,
+               UBaseType_t priority = 5, BaseType_t core = 1);
+    // 16bit ステレオ PCM
+    void push(const uint8_t* data, size_t len);
+    // 音源が止まったら呼ぶ（以降の空はアンダーランに数えない）
+    void idle();
+    I2sJitterStats stats();
+    // min_level / max_gap_ms の集計区間を区切る
+    void reset_window();
+
+private:
+    static void task(void* arg);
+    void loop();
+
+    audio_tools::I2SStream* _i2s = nullptr;
+    StaticStreamBuffer_t _sb_buf;
+    StreamBufferHandle_t _sb = nullptr;
+    size_t _size = 0;
+    volatile bool _active = false;   // 音源がデータを送っている
+    uint32_t _last_push = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    I2sJitterStats _stats = {};
+};
+#endif
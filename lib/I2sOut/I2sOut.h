@@ -0,0 +1,52 @@
+#pragma once
+
+// CYD 外付け DAC（PCM5102A）への I2S 出力。
+//   ピン: bsp::Board::I2s（既定 BCK=16, WS=17, DATA=4。TFT/SD と重ならないことは BoardTraits.h で確かめる）
+//   16bit PCM を 32bit スロットの上位に載せて書く。最下位ビットを立てるのは PCM5102A の
+//   無音時ミュート（ゼロ検出）で頭が欠けるのを避けるため。
+// a2dp の A2DP 出力とネットラジオ（RadioStream）で同じ設定を使う。
+
+#include <AudioTools.h>
+#include <vector>
+
+#include "BoardTraits.h"
+
+// I2S の DMA バッファ（内部 DRAM）。既定は AudioTools の I2S_BUFFER_COUNT x I2S_BUFFER_SIZE
+#ifndef I2S_OUT_DMA_COUNT
+#define I2S_OUT_DMA_COUNT I2S_BUFFER_COUNT
+#endif
+#ifndef I2S_OUT_DMA_BYTES
+#define I2S_OUT_DMA_BYTES I2S_BUFFER_SIZE
+#endif
+
+inline bool i2s_out_begin(audio_tools::I2SStream& i2s, int sample_rate = 44100) {
+    auto cfg = i2s.defaultConfig();
+    cfg.sample_rate = sample_rate;
+    cfg.channels = 2;
+    cfg.bits_per_sample = 32;
+    cfg.pin_bck = bsp::Board::I2s::kBck;
+    cfg.pin_ws = bsp::Board::I2s::kWs;
+    cfg.pin_data = bsp::Board::I2s::kData;
+    cfg.buffer_count = I2S_OUT_DMA_COUNT;
+    cfg.buffer_size = I2S_OUT_DMA_BYTES;
+    return i2s.begin(cfg);
+}
+
+// 16bit PCM（channels=1 なら左右に複製）を書く。buf は呼び出し側が持つ作業領域
+inline size_t i2s_out_write16(audio_tools::I2SStream& i2s, const int16_t* pcm, size_t samples,
+                              uint8_t channels, std::vector<int32_t>& buf) {
+    const size_t out_samples = channels == 1 ? samples * 2 : samples;
+    if (buf.size() < out_samples) buf.resize(out_samples);
+    if (channels == 1) {
+        for (size_t i = 0; i < samples; ++i) {
+            const int32_t s = static_cast<int32_t>(pcm[i] | 0x0001) << 16;
+            buf[i * 2] = s;
+            buf[i * 2 + 1] = s;
+        }
+    } else {
+        for (size_t i = 0; i < samples; ++i) {
+            buf[i] = static_cast<int32_t>(pcm[i] | 0x0001) << 16;
+        }
+    }
+    return i2s.write(reinterpret_cast<const uint8_t*>(buf.data()), out_samples * sizeof(int32_t));
+}
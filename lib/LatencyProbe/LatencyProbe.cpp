@@ -0,0 +1,96 @@
+#include "LatencyProbe.h"
+
+#if LATENCY_PROBE_ENABLE
+#include <Arduino.h>
+
+namespace {
+
+constexpr uint8_t kScreens = 4;
+constexpr uint8_t kBuckets = 12;
+// バケット上限 [ms]（最後は上限なし）
+constexpr uint16_t kBounds[kBuckets - 1] = {8, 12, 16, 20, 25, 33, 40, 50, 66, 100, 200};
+// 無効化を起こさなかった入力はこの時間で捨てる
+constexpr uint32_t kStaleUs = 250000;
+
+struct ScreenStats {
+    const void* screen;
+    const char* name;
+    uint32_t count;
+    uint32_t min_us, max_us;
+    uint64_t sum_us;
+    uint32_t hist[kBuckets];
+};
+
+ScreenStats stats[kScreens];
+uint32_t input_us;          // 描画に反映されていない最古の入力
+bool input_pending;
+bool render_pending;        // 入力後に無効化が起きた
+bool last_pressed;
+int16_t last_x, last_y;
+
+ScreenStats* slot(const void* screen) {
+    for (ScreenStats& s : stats) {
+        if (s.screen == screen) return &s;
+    }
+    for (ScreenStats& s : stats) {
+        if (!s.screen) { s.screen = screen; s.min_us = UINT32_MAX; return &s; }
+    }
+    return nullptr;
+}
+
+uint32_t percentile(const ScreenStats& s, uint8_t pct) {
+    uint32_t target = (s.count * pct + 99) / 100, acc = 0;
+    for (uint8_t i = 0; i < kBuckets; ++i) {
+        acc += s.hist[i];
+        if (acc >= target) return i < kBuckets - 1 ? kBounds[i] : s.max_us / 1000;
+    }
+    return 0;
+}
+
+}  // namespace
+
+void latency_probe_input(uint32_t t_us, bool pressed, int16_t x, int16_t y) {
+    bool changed = pressed != last_pressed || (pressed && (x != last_x || y != last_y));
+    last_pressed = pressed; last_x = x; last_y = y;
+    if (!changed) return;
+    if (input_pending && !render_pending && t_us - input_us > kStaleUs) input_pending = false;
+    if (!input_pending) { input_us = t_us; input_pending = true; }
+}
+
+void latency_probe_invalidate() {
+    if (input_pending) render_pending = true;
+}
+
+void latency_probe_flush(const void* screen, bool last) {
+    if (!last || !render_pending) return;
+    uint32_t lat = micros() - input_us;
+    input_pending = render_pending = false;
+
+    ScreenStats* s = slot(screen);
+    if (!s) return;
+    s->count++;
+    s->sum_us += lat;
+    if (lat < s->min_us) s->min_us = lat;
+    if (lat > s->max_us) s->max_us = lat;
+    uint8_t b = 0;
+    while (b < kBuckets - 1 && lat > kBounds[b] * 1000UL) ++b;
+    s->hist[b]++;
+}
+
+void latency_probe_name(const void* screen, const char* name) {
+    ScreenStats* s = slot(screen);
+    if (s) s->name = name;
+}
+
+void latency_probe_report(Print& out) {
+    for (const ScreenStats& s : stats) {
+        if (!s.screen || s.count == 0) continue;
+        out.printf("[LAT %s] n=%u min=%.1f avg=%.1f p50<=%u p95<=%u max=%.1f ms |",
+                   s.name ? s.name : "screen", (unsigned)s.count,
+                   s.min_us / 1000.0f, (float)(s.sum_us / s.count) / 1000.0f,
+                   (unsigned)percentile(s, 50), (unsigned)percentile(s, 95), s.max_us / 1000.0f);
+        for (uint8_t i = 0; i < kBuckets; ++i) out.printf(" %u", (unsigned)s.hist[i]);
+        out.println();
+    }
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+// タッチ→表示（touch-to-photon）遅延の計測。
+//   1. read_cb: CST820 のサンプル取得時刻を入力イベントとして記録（押下/離し/移動があった時だけ）
+//   2. rounder_cb: その後、indev の処理中に起きた最初の無効化で入力を「描画待ち」に進める
+//      （rounder_cb は描画中にも呼ばれるが、そのとき lv_indev_get_act() は NULL なので、呼び出し側はそれだけを確かめる）
+//   3. flush_cb: 描画待ちの入力があり、その描画の最後の転送が終わった時点で遅延を確定
+// 画面（lv_scr_act()）ごとにヒストグラムを持ち、latency_probe_report() で出力する。
+// -D LATENCY_PROBE_ENABLE=1 の時だけ有効。無効時はマクロが空になる。
+
+#include <stdint.h>
+
+#ifndef LATENCY_PROBE_ENABLE
+#define LATENCY_PROBE_ENABLE 0
+#endif
+
+#if LATENCY_PROBE_ENABLE
+#include <Print.h>
+
+void latency_probe_input(uint32_t t_us, bool pressed, int16_t x, int16_t y);
+void latency_probe_invalidate();
+void latency_probe_flush(const void* screen, bool last);
+void latency_probe_name(const void* screen, const char* name);
+void latency_probe_report(Print& out);
+
+#define LATENCY_PROBE_INPUT(t_us, pressed, x, y) latency_probe_input((t_us), (pressed), (x), (y))
+#define LATENCY_PROBE_INVALIDATE()               latency_probe_invalidate()
+#define LATENCY_PROBE_FLUSH(screen, last)        latency_probe_flush((screen), (last))
+#define LATENCY_PROBE_NAME(screen, name)         latency_probe_name((screen), (name))
+#else
+#define LATENCY_PROBE_INPUT(t_us, pressed, x, y) ((void)0)
+#define LATENCY_PROBE_INVALIDATE()               ((void)0)
+#define LATENCY_PROBE_FLUSH(screen, last)        ((void)0)
+#define LATENCY_PROBE_NAME(screen, name)         ((void)0)
+#endif
@@ -0,0 +1,77 @@
+#include "LvPool.h"
+#include "LvPoolCore.h"
+#include "lv_conf.h"
+
+// 置き場所（heap_caps の caps）。0 なら .bss の静的配列
+#ifndef LV_POOL_CAPS
+#define LV_POOL_CAPS 0
+#endif
+// サイズクラスのページの目安 [bytes]（0 で TLSF だけ）
+#ifndef LV_POOL_SLAB_PAGE
+#define LV_POOL_SLAB_PAGE 256
+#endif
+// 1 で確保と解放をシリアルに出す（tools/lv_pool_stress.cpp で再生する）
+#ifndef LV_POOL_TRACE
+#define LV_POOL_TRACE 0
+#endif
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#endif
+
+static LvPoolCore pool;
+static bool pool_ready = false;
+#if LV_POOL_CAPS == 0
+static uint32_t pool_mem[LV_MEM_SIZE / 4];
+#endif
+
+// LVGL は lv_init の中から確保を始めるので、最初の確保でプールを用意する
+static bool pool_begin() {
+    if (pool_ready) return true;
+#if LV_POOL_CAPS == 0
+    pool_ready = pool.begin(pool_mem, sizeof(pool_mem), LV_POOL_SLAB_PAGE);
+#else
+    void* mem = heap_caps_malloc(LV_MEM_SIZE, LV_POOL_CAPS);
+    pool_ready = mem && pool.begin(mem, LV_MEM_SIZE, LV_POOL_SLAB_PAGE);
+#endif
+    return pool_ready;
+}
+
+#if LV_POOL_TRACE && defined(ARDUINO)
+#define LV_POOL_TRACE_PRINTF(...) Serial.printf(__VA_ARGS__)
+#else
+#define LV_POOL_TRACE_PRINTF(...) ((void)0)
+#endif
+
+extern "C" void* lv_pool_alloc(size_t size) {
+    if (!pool_begin()) return nullptr;
+    void* p = pool.alloc(size);
+    LV_POOL_TRACE_PRINTF("[LVT] a %lx %u\n", p ? (unsigned long)pool.offset_of(p) : 0xFFFFFFFFul, (unsigned)size);
+    return p;
+}
+
+extern "C" void lv_pool_free(void* p) {
+    if (!p) return;
+    LV_POOL_TRACE_PRINTF("[LVT] f %lx\n", (unsigned long)pool.offset_of(p));
+    pool.free(p);
+}
+
+extern "C" void* lv_pool_realloc(void* p, size_t size) {
+    if (!pool_begin()) return nullptr;
+#if LV_POOL_TRACE
+    const unsigned long from = p ? (unsigned long)pool.offset_of(p) : 0xFFFFFFFFul;
+#endif
+    void* q = pool.realloc(p, size);
+    LV_POOL_TRACE_PRINTF("[LVT] r %lx %lx %u\n", from, q ? (unsigned long)pool.offset_of(q) : 0xFFFFFFFFul,
+                         (unsigned)size);
+    return q;
+}
+
+extern "C" void lv_pool_get_stats(lv_pool_stats_t* out) {
+    if (!pool_begin()) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    pool.stats(out);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+ * LVGL の LV_MEM_CUSTOM 用アロケータ（lv_conf.h から C として読まれるので C の宣言だけ置く）。
+ *   小さい確保（LVGL のオブジェクト・スタイル・イベントなど 124B 以下）: サイズクラスごとのページから O(1)
+ *   それ以外: TLSF（2段のビットマップで O(1) に空きブロックを探し、解放時に前後と結合）
+ * プールは LV_MEM_SIZE バイト。LV_POOL_CAPS を指定すると heap_caps_malloc でその領域に置く（既定は .bss の静的配列）。
+ * 中身は LvPoolCore.h（Arduino 非依存）。
+ *
+ *   lv_conf.h:
+ *     #define LV_MEM_CUSTOM 1
+ *     #define LV_MEM_CUSTOM_INCLUDE "LvPool.h"
+ *     #define LV_MEM_CUSTOM_ALLOC   lv_pool_alloc
+ *     #define LV_MEM_CUSTOM_FREE    lv_pool_free
+ *     #define LV_MEM_CUSTOM_REALLOC lv_pool_realloc
+ *   platformio.ini の build_flags に -I ../lib/LvPool（LVGL 本体からこのヘッダを見つけるため）
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t pool_bytes;
+    uint32_t used_bytes;      /* 使用中（ヘッダとページを含む） */
+    uint32_t peak_used;
+    uint32_t free_bytes;      /* TLSF の空き */
+    uint32_t largest_free;    /* 1回で確保できる最大 */
+    uint8_t  frag_pct;        /* 100 * (1 - largest_free / free_bytes) */
+    uint32_t slab_pages;
+    uint32_t slab_bytes;      /* ページが占めるバイト */
+    uint32_t slab_used;       /* うち使用中のスロット */
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failures;
+} lv_pool_stats_t;
+
+void* lv_pool_alloc(size_t size);
+void lv_pool_free(void* p);
+void* lv_pool_realloc(void* p, size_t size);
+void lv_pool_get_stats(lv_pool_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
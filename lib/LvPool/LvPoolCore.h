@@ -0,0 +1,434 @@
+#pragma once
+
+// LvPool の本体（Arduino 非依存。tools/lv_pool_stress.cpp からも使う）。
+//
+// ブロック（TLSF が扱う単位。オフセットはプール先頭から、4 バイト境界）:
+//   [prev_phys 4B][size | flags 4B][payload ...]
+//   空きブロックは payload の先頭に空きリストの next / prev を置く（最小 16B）。
+//   size の bit0 = 空き。物理的に隣の空きブロックとは解放時に必ず結合する。
+// 空きリストは size の桁（fl）と、その中を SL_COUNT 等分した位置（sl）で分ける。
+// 小さい確保はサイズクラス（スロット 16〜128B）ごとのページ（TLSF から取った1ブロック）に詰める:
+//   [SlabPage 16B][slot][slot]...   slot = [prefix 4B][payload]
+//   prefix = ページのオフセット | SLAB_BIT。解放時は payload の直前の 4B を見て、ページかブロックかを見分ける。
+// 空になったページはすぐ TLSF に返す。寿命の短い小物が大きなブロックの間に散らばらないのが狙い。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "LvPool.h"
+
+class LvPoolCore {
+public:
+    // slab_page = ページの目安のバイト数（0 でサイズクラスを使わず TLSF だけ。LVGL 組み込みのプールに近い）
+    bool begin(void* mem, size_t bytes, uint16_t slab_page) {
+        uintptr_t a = ((uintptr_t)mem + 3) & ~(uintptr_t)3;
+        bytes -= a - (uintptr_t)mem;
+        bytes &= ~(size_t)3;
+        if (bytes < 64) return false;
+        // fl が FL_COUNT に収まる大きさまで（512KB）
+        if (bytes > ((size_t)SMALL << (FL_COUNT - 1)) - 4) bytes = ((size_t)SMALL << (FL_COUNT - 1)) - 4;
+        _base = (uint8_t*)a;
+        _size = (uint32_t)bytes;
+        _fl_map = 0;
+        memset(_sl_map, 0, sizeof(_sl_map));
+        for (int f = 0; f < FL_COUNT; ++f) {
+            for (int s = 0; s < SL_COUNT; ++s) _heads[f][s] = NIL;
+        }
+        _free = _peak = 0;
+        _allocs = _frees = _failures = 0;
+        _pages = _slab_bytes = _slab_used = 0;
+
+        _slab_page = slab_page;
+        for (int c = 0; c < CLASSES; ++c) {
+            _partial[c] = NIL;
+            uint32_t cap = slab_page > PAGE_HDR ? (slab_page - PAGE_HDR) / slot_size(c) : 0;
+            _cap[c] = (uint8_t)(cap < 2 ? 2 : cap > 255 ? 255 : cap);
+        }
+        // 要求サイズ → クラス（4B 刻み）
+        for (uint32_t i = 0, c = 0; i < sizeof(_class_of); ++i) {
+            while (c < CLASSES && slot_size(c) < i * 4 + 4) ++c;
+            _class_of[i] = (uint8_t)c;
+        }
+
+        prev_phys(0) = NIL;
+        sf(0) = _size | FREE_BIT;
+        insert(0);
+        return true;
+    }
+
+    void* alloc(size_t n) {
+        if (n == 0) n = 1;
+        void* p = nullptr;
+        if (_slab_page && n <= slot_size(CLASSES - 1) - 4) p = slab_alloc(_class_of[(n + 3) >> 2]);
+        if (!p && n < _size) {
+            const uint32_t o = block_alloc(block_size(n));
+            if (o != NIL) p = _base + o + HDR;
+        }
+        if (!p) { ++_failures; return nullptr; }
+        ++_allocs;
+        if (used() > _peak) _peak = used();
+        return p;
+    }
+
+    void free(void* p) {
+        if (!p) return;
+        ++_frees;
+        const uint32_t prefix = word(off(p) - 4);
+        if (prefix & SLAB_BIT) slab_free(p, prefix & ~3u);
+        else block_free(off(p) - HDR);
+    }
+
+    void* realloc(void* p, size_t n) {
+        if (!p) return alloc(n);
+        if (n == 0) { free(p); return nullptr; }
+        const uint32_t prefix = word(off(p) - 4);
+        if (!(prefix & SLAB_BIT) && n < _size) {
+            // TLSF のブロックはその場で縮める / 後ろの空きを取り込んで伸ばす
+            const uint32_t o = off(p) - HDR;
+            const uint32_t want = block_size(n);
+            uint32_t have = size(o);
+            const uint32_t nx = o + have;
+            if (want > have && nx < _size && is_free(nx) && have + size(nx) >= want) {
+                remove(nx);
+                have += size(nx);
+                sf(o) = have;
+                if (o + have < _size) prev_phys(o + have) = o;
+            }
+            if (want <= have) {
+                split(o, want);
+                if (used() > _peak) _peak = used();
+                return p;
+            }
+        } else if (prefix & SLAB_BIT && n <= usable_size(p)) {
+            return p;
+        }
+        void* q = alloc(n);
+        if (!q) return nullptr;
+        const size_t us = usable_size(p);
+        memcpy(q, p, us < n ? us : n);
+        free(p);
+        --_allocs;    // 移動は1回の確保として数える
+        --_frees;
+        return q;
+    }
+
+    size_t usable_size(const void* p) const {
+        const uint32_t prefix = word(off(p) - 4);
+        if (prefix & SLAB_BIT) return slot_size(page(prefix & ~3u)->cls) - 4;
+        return size(off(p) - HDR) - HDR;
+    }
+
+    void stats(lv_pool_stats_t* out) const {
+        memset(out, 0, sizeof(*out));
+        out->pool_bytes = _size;
+        out->used_bytes = used();
+        out->peak_used = _peak;
+        out->free_bytes = _free;
+        out->largest_free = largest_free();
+        out->frag_pct = _free ? (uint8_t)(100 - (uint64_t)out->largest_free * 100 / (_free - HDR)) : 0;
+        out->slab_pages = _pages;
+        out->slab_bytes = _slab_bytes;
+        out->slab_used = _slab_used;
+        out->allocs = _allocs;
+        out->frees = _frees;
+        out->failures = _failures;
+    }
+
+    // 構造の整合性を確かめる（ホストの試験用。O(n)）
+    bool check() const {
+        uint32_t o = 0, prev = NIL, free_sum = 0, free_blocks = 0, pages = 0;
+        bool prev_free = false;
+        while (o < _size) {
+            const uint32_t s = size(o);
+            if (s < MIN_BLOCK || (s & 3) || o + s > _size || prev_phys(o) != prev) return false;
+            if (is_free(o)) {
+                if (prev_free) return false;    // 結合し損ね
+                free_sum += s;
+                ++free_blocks;
+            }
+            prev_free = is_free(o);
+            prev = o;
+            o += s;
+        }
+        if (o != _size || free_sum != _free) return false;
+        uint32_t listed = 0;
+        for (int f = 0; f < FL_COUNT; ++f) {
+            for (int s = 0; s < SL_COUNT; ++s) {
+                const bool bit = (_sl_map[f] >> s) & 1;
+                if (bit != (_heads[f][s] != NIL)) return false;
+                for (uint32_t b = _heads[f][s]; b != NIL; b = next_free(b)) {
+                    int ff, ss;
+                    mapping(size(b), &ff, &ss);
+                    if (!is_free(b) || ff != f || ss != s) return false;
+                    ++listed;
+                }
+            }
+            if ((bool)((_fl_map >> f) & 1) != (_sl_map[f] != 0)) return false;
+        }
+        if (listed != free_blocks) return false;
+        for (int c = 0; c < CLASSES; ++c) {
+            for (uint32_t pg = _partial[c]; pg != NIL; pg = page(pg)->next) {
+                const SlabPage* sp = page(pg);
+                uint32_t nfree = 0;
+                for (uint16_t i = sp->free_head; i != NIL16; i = *(const uint16_t*)(slot(pg, i) + 4)) {
+                    if (i >= sp->cap || ++nfree > sp->cap) return false;
+                }
+                if (sp->cls != c || nfree == 0 || sp->used + nfree != sp->cap) return false;
+                ++pages;
+            }
+        }
+        return pages <= _pages;
+    }
+
+    uint32_t offset_of(const void* p) const { return off(p); }
+
+private:
+    enum {
+        HDR = 8,
+        MIN_BLOCK = 16,
+        FREE_BIT = 1,
+        SLAB_BIT = 2,
+        SL_LOG2 = 4,
+        SL_COUNT = 1 << SL_LOG2,
+        SMALL_LOG2 = 8,
+        SMALL = 1 << SMALL_LOG2,     // これ未満は 16B 刻みのリスト
+        FL_COUNT = 12,
+        CLASSES = 9,
+        PAGE_HDR = 16,
+    };
+    enum : uint32_t { NIL = 0xFFFFFFFFu };
+    enum : uint16_t { NIL16 = 0xFFFF };
+    // スロットの大きさ（prefix 4B 込み）。LVGL v8（32bit）の lv_obj_t・spec_attr・スタイル配列・
+    // イベント・タイマ・アニメ・短い文字列がこのどれかに入る
+    static uint32_t slot_size(int c) {
+        static const uint16_t t[CLASSES] = {16, 24, 32, 40, 48, 64, 80, 96, 128};
+        return t[c];
+    }
+
+    struct SlabPage {
+        uint32_t next;       // 空きのあるページのリスト
+        uint32_t prev;
+        uint16_t free_head;
+        uint16_t used;
+        uint8_t  cls;
+        uint8_t  cap;
+        uint16_t reserved;
+    };
+    static_assert(sizeof(SlabPage) == PAGE_HDR, "SlabPage layout");
+
+    uint32_t off(const void* p) const { return (uint32_t)((const uint8_t*)p - _base); }
+    uint32_t& word(uint32_t o) { return *(uint32_t*)(_base + o); }
+    uint32_t word(uint32_t o) const { return *(const uint32_t*)(_base + o); }
+    uint32_t& prev_phys(uint32_t o) { return word(o); }
+    uint32_t prev_phys(uint32_t o) const { return word(o); }
+    uint32_t& sf(uint32_t o) { return word(o + 4); }
+    uint32_t size(uint32_t o) const { return word(o + 4) & ~3u; }
+    bool is_free(uint32_t o) const { return word(o + 4) & FREE_BIT; }
+    uint32_t& next_free(uint32_t o) { return word(o + 8); }
+    uint32_t next_free(uint32_t o) const { return word(o + 8); }
+    uint32_t& prev_free(uint32_t o) { return word(o + 12); }
+    uint32_t used() const { return _size - _free; }
+
+    SlabPage* page(uint32_t o) { return (SlabPage*)(_base + o + HDR); }
+    const SlabPage* page(uint32_t o) const { return (const SlabPage*)(_base + o + HDR); }
+    uint8_t* slot(uint32_t o, uint16_t i) const {
+        return _base + o + HDR + PAGE_HDR + (uint32_t)i * slot_size(page(o)->cls);
+    }
+
+    static uint32_t block_size(size_t n) {
+        const uint32_t s = (uint32_t)((n + 3) & ~(size_t)3) + HDR;
+        return s < MIN_BLOCK ? (uint32_t)MIN_BLOCK : s;
+    }
+
+    static int log2_floor(uint32_t v) { return 31 - __builtin_clz(v); }
+
+    static void mapping(uint32_t s, int* fl, int* sl) {
+        if (s < SMALL) {
+            *fl = 0;
+            *sl = (int)(s / (SMALL / SL_COUNT));
+        } else {
+            const int f = log2_floor(s);
+            *sl = (int)((s >> (f - SL_LOG2)) ^ SL_COUNT);
+            *fl = f - SMALL_LOG2 + 1;
+        }
+    }
+
+    // s 以上が必ず入っているリストの位置（リストの幅ぶん切り上げる）
+    static void mapping_search(uint32_t s, int* fl, int* sl) {
+        if (s < SMALL) s += SMALL / SL_COUNT - 1;
+        else s += (1u << (log2_floor(s) - SL_LOG2)) - 1;
+        mapping(s, fl, sl);
+    }
+
+    void insert(uint32_t o) {
+        int f, s;
+        mapping(size(o), &f, &s);
+        const uint32_t head = _heads[f][s];
+        next_free(o) = head;
+        prev_free(o) = NIL;
+        if (head != NIL) prev_free(head) = o;
+        _heads[f][s] = o;
+        _sl_map[f] |= 1u << s;
+        _fl_map |= 1u << f;
+        _free += size(o);
+    }
+
+    void remove(uint32_t o) {
+        int f, s;
+        mapping(size(o), &f, &s);
+        const uint32_t nx = next_free(o), pv = prev_free(o);
+        if (nx != NIL) prev_free(nx) = pv;
+        if (pv != NIL) next_free(pv) = nx;
+        if (_heads[f][s] == o) {
+            _heads[f][s] = nx;
+            if (nx == NIL) {
+                _sl_map[f] &= ~(1u << s);
+                if (!_sl_map[f]) _fl_map &= ~(1u << f);
+            }
+        }
+        _free -= size(o);
+    }
+
+    uint32_t find(uint32_t want) const {
+        int f, s;
+        mapping_search(want, &f, &s);
+        if (f >= FL_COUNT) return NIL;
+        uint32_t sl_map = s < SL_COUNT ? _sl_map[f] & (~0u << s) : 0;
+        if (!sl_map) {
+            const uint32_t fl_map = f + 1 < FL_COUNT ? _fl_map & (~0u << (f + 1)) : 0;
+            if (!fl_map) return NIL;
+            f = __builtin_ctz(fl_map);
+            sl_map = _sl_map[f];
+        }
+        return _heads[f][__builtin_ctz(sl_map)];
+    }
+
+    // o（使用中）を want に切り詰め、余りを空きブロックにして後ろと結合する
+    void split(uint32_t o, uint32_t want) {
+        const uint32_t have = size(o);
+        if (have - want < MIN_BLOCK) return;
+        const uint32_t r = o + want;
+        sf(o) = want;
+        prev_phys(r) = o;
+        sf(r) = have - want;    // いったん使用中として作り、block_free で結合させる
+        if (r + (have - want) < _size) prev_phys(r + (have - want)) = r;
+        block_free(r);
+    }
+
+    uint32_t block_alloc(uint32_t want) {
+        const uint32_t o = find(want);
+        if (o == NIL) return NIL;
+        remove(o);
+        sf(o) = size(o);    // 使用中に
+        split(o, want);
+        return o;
+    }
+
+    void block_free(uint32_t o) {
+        uint32_t s = size(o);
+        const uint32_t nx = o + s;
+        if (nx < _size && is_free(nx)) {
+            remove(nx);
+            s += size(nx);
+        }
+        const uint32_t pv = prev_phys(o);
+        if (pv != NIL && is_free(pv)) {
+            remove(pv);
+            s += size(pv);
+            o = pv;
+        }
+        sf(o) = s | FREE_BIT;
+        if (o + s < _size) prev_phys(o + s) = o;
+        insert(o);
+    }
+
+    uint32_t largest_free() const {
+        if (!_fl_map) return 0;
+        const int f = log2_floor(_fl_map);
+        const int s = log2_floor(_sl_map[f]);
+        uint32_t best = 0;
+        for (uint32_t b = _heads[f][s]; b != NIL; b = next_free(b)) {
+            if (size(b) > best) best = size(b);
+        }
+        return best - HDR;
+    }
+
+    void link_page(uint8_t c, uint32_t o) {
+        SlabPage* sp = page(o);
+        sp->prev = NIL;
+        sp->next = _partial[c];
+        if (sp->next != NIL) page(sp->next)->prev = o;
+        _partial[c] = o;
+    }
+
+    void unlink_page(uint8_t c, uint32_t o) {
+        SlabPage* sp = page(o);
+        if (sp->next != NIL) page(sp->next)->prev = sp->prev;
+        if (sp->prev != NIL) page(sp->prev)->next = sp->next;
+        else _partial[c] = sp->next;
+    }
+
+    void* slab_alloc(uint8_t c) {
+        uint32_t o = _partial[c];
+        if (o == NIL) {
+            const uint32_t bytes = HDR + PAGE_HDR + (uint32_t)_cap[c] * slot_size(c);
+            o = block_alloc(bytes);
+            if (o == NIL) return nullptr;    // ページが取れなければ TLSF から直接
+            SlabPage* sp = page(o);
+            sp->cls = c;
+            sp->cap = _cap[c];
+            sp->used = 0;
+            sp->free_head = 0;
+            sp->reserved = 0;
+            for (uint16_t i = 0; i < sp->cap; ++i) {
+                uint8_t* s = slot(o, i);
+                *(uint32_t*)s = o | SLAB_BIT;
+                *(uint16_t*)(s + 4) = i + 1 < sp->cap ? (uint16_t)(i + 1) : (uint16_t)NIL16;
+            }
+            link_page(c, o);
+            ++_pages;
+            _slab_bytes += size(o);
+        }
+        SlabPage* sp = page(o);
+        uint8_t* s = slot(o, sp->free_head);
+        sp->free_head = *(uint16_t*)(s + 4);
+        ++sp->used;
+        _slab_used += slot_size(c);
+        if (sp->free_head == NIL16) unlink_page(c, o);
+        return s + 4;
+    }
+
+    void slab_free(void* p, uint32_t o) {
+        SlabPage* sp = page(o);
+        const uint8_t c = sp->cls;
+        uint8_t* s = (uint8_t*)p - 4;
+        const uint16_t i = (uint16_t)((s - slot(o, 0)) / slot_size(c));
+        const bool was_full = sp->free_head == NIL16;
+        *(uint16_t*)(s + 4) = sp->free_head;
+        sp->free_head = i;
+        --sp->used;
+        _slab_used -= slot_size(c);
+        if (sp->used == 0) {
+            if (!was_full) unlink_page(c, o);
+            --_pages;
+            _slab_bytes -= size(o);
+            block_free(o);
+        } else if (was_full) {
+            link_page(c, o);
+        }
+    }
+
+    uint8_t* _base = nullptr;
+    uint32_t _size = 0;
+    uint32_t _free = 0;
+    uint32_t _peak = 0;
+    uint32_t _fl_map = 0;
+    uint32_t _sl_map[FL_COUNT];
+    uint32_t _heads[FL_COUNT][SL_COUNT];
+    uint32_t _allocs = 0, _frees = 0, _failures = 0;
+    uint16_t _slab_page = 0;
+    uint32_t _partial[CLASSES];
+    uint8_t _cap[CLASSES];
+    uint8_t _class_of[(128 - 4) / 4 + 1];
+    uint32_t _pages = 0, _slab_bytes = 0, _slab_used = 0;
+};
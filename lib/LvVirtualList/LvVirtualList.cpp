@@ -0,0 +1,77 @@
+#include "LvVirtualList.h"
+
+void LvVirtualList::begin(lv_obj_t* container, lv_coord_t row_h, lv_coord_t gap,
+                          LvVirtualListCreateCb create, LvVirtualListBindCb bind, void* user) {
+    _cont = container;
+    _row_h = row_h;
+    _pitch = row_h + gap;
+    _create = create;
+    _bind = bind;
+    _user = user;
+
+    lv_obj_set_layout(_cont, 0);   // 行の位置はこちらで決める
+    _spacer = lv_obj_create(_cont);
+    lv_obj_remove_style_all(_spacer);
+    lv_obj_clear_flag(_spacer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_size(_spacer, 1, 1);
+    lv_obj_add_event_cb(_cont, scroll_cb, LV_EVENT_SCROLL, this);
+    lv_obj_add_event_cb(_cont, scroll_cb, LV_EVENT_SIZE_CHANGED, this);
+}
+
+void LvVirtualList::set_count(uint32_t n) {
+    _count = n;
+    // スクロール範囲: 最後の行の下端にスペーサを置く
+    lv_obj_set_pos(_spacer, 0, n ? (lv_coord_t)(n * _pitch - (_pitch - _row_h) - 1) : 0);
+    ensure_pool(true);
+    layout(true);
+}
+
+void LvVirtualList::ensure_pool(bool update_layout) {
+    if (update_layout) lv_obj_update_layout(_cont);
+    const lv_coord_t h = lv_obj_get_content_height(_cont);
+    uint16_t need = (uint16_t)((h + _pitch - 1) / _pitch + LV_VLIST_MARGIN);
+    if (need > LV_VLIST_POOL_MAX) need = LV_VLIST_POOL_MAX;
+    while (_pool_n < need) {
+        lv_obj_t* row = _create(_cont, _user);
+        lv_obj_set_height(row, _row_h);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+        _bound[_pool_n] = -1;
+        _pool[_pool_n++] = row;
+    }
+}
+
+void LvVirtualList::layout(bool force) {
+    if (!_pool_n) return;
+    // 先頭の見えている行の1つ前から並べる
+    int32_t first = lv_obj_get_scroll_y(_cont) / _pitch - LV_VLIST_MARGIN / 2;
+    if (first < 0) first = 0;
+    for (uint16_t k = 0; k < _pool_n; ++k) {
+        const int32_t idx = first + k;
+        // 行 (idx % pool) を使うので、1行スクロールしても結び直すのは1行だけ
+        const uint16_t slot = (uint16_t)(idx % _pool_n);
+        lv_obj_t* row = _pool[slot];
+        if (idx >= (int32_t)_count) {
+            lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            _bound[slot] = -1;
+            continue;
+        }
+        if (force || _bound[slot] != idx) {
+            lv_obj_set_pos(row, 0, (lv_coord_t)(idx * _pitch));
+            lv_obj_set_user_data(row, (void*)(uintptr_t)idx);
+            _bind(row, (uint32_t)idx, _user);
+            _bound[slot] = idx;
+        }
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+void LvVirtualList::scroll_cb(lv_event_t* e) {
+    LvVirtualList* self = static_cast<LvVirtualList*>(lv_event_get_user_data(e));
+    if (lv_event_get_code(e) == LV_EVENT_SIZE_CHANGED) {
+        // イベント中にレイアウトを更新し直さない（大きさは確定済み）
+        self->ensure_pool(false);
+        self->layout(true);
+    } else {
+        self->layout(false);
+    }
+}
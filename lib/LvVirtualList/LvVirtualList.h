@@ -0,0 +1,51 @@
+#pragma once
+
+// 行を使い回す仮想リスト（LVGL 8）。
+// 見えている行数 + 上下の余白分だけ行オブジェクトを作り、スクロールに合わせて位置を動かして
+// データに結び直す（bind）。件数が増えても LVGL のヒープ使用量は一定。
+// 行は固定の高さで、container のスクロール範囲は末尾のスペーサで確保する（container に flex は使わない）。
+
+#include <lvgl.h>
+
+#ifndef LV_VLIST_POOL_MAX
+#define LV_VLIST_POOL_MAX 16
+#endif
+#ifndef LV_VLIST_MARGIN
+#define LV_VLIST_MARGIN 2      // 見えている行の前後に余分に持つ行数（合計）
+#endif
+
+// 行オブジェクトを1つ作る（初回のみ）
+typedef lv_obj_t* (*LvVirtualListCreateCb)(lv_obj_t* parent, void* user);
+// 行を index 番目のデータに結び付ける（index が変わった時だけ呼ばれる）
+typedef void (*LvVirtualListBindCb)(lv_obj_t* row, uint32_t index, void* user);
+
+class LvVirtualList {
+public:
+    void begin(lv_obj_t* container, lv_coord_t row_h, lv_coord_t gap,
+               LvVirtualListCreateCb create, LvVirtualListBindCb bind, void* user = nullptr);
+    // 件数を変えて結び直す（内容だけ変わった場合も呼ぶ）
+    void set_count(uint32_t n);
+    uint32_t count() const { return _count; }
+    uint16_t pool_size() const { return _pool_n; }
+
+    // 行に結び付いているデータの位置
+    static uint32_t index_of(lv_obj_t* row) { return (uint32_t)(uintptr_t)lv_obj_get_user_data(row); }
+
+private:
+    static void scroll_cb(lv_event_t* e);
+    void ensure_pool(bool update_layout);
+    void layout(bool force);
+
+    lv_obj_t* _cont = nullptr;
+    lv_obj_t* _spacer = nullptr;
+    lv_coord_t _pitch = 0;
+    lv_coord_t _row_h = 0;
+    LvVirtualListCreateCb _create = nullptr;
+    LvVirtualListBindCb _bind = nullptr;
+    void* _user = nullptr;
+
+    lv_obj_t* _pool[LV_VLIST_POOL_MAX] = {};
+    int32_t _bound[LV_VLIST_POOL_MAX];
+    uint16_t _pool_n = 0;
+    uint32_t _count = 0;
+};
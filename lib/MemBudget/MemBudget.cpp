@@ -0,0 +1,81 @@
+#ifdef ARDUINO
+#include "MemBudget.h"
+#include <string.h>
+#include <esp_heap_caps.h>
+
+struct MemBudgetEntry {
+    const char* name;
+    int32_t heap;      // 空き容量の減少 [bytes]
+    uint32_t dma;      // mem_budget_alloc(Dma)
+    uint32_t nodma;    // mem_budget_alloc(NoDma)
+    uint32_t stat;     // 静的配列
+};
+
+static MemBudgetEntry entries[MEM_BUDGET_MAX];
+static uint8_t entry_count = 0;
+static size_t last_free = 0;
+static size_t boot_free = 0;
+
+static MemBudgetEntry* entry(const char* name) {
+    for (uint8_t i = 0; i < entry_count; ++i) {
+        if (strcmp(entries[i].name, name) == 0) return &entries[i];
+    }
+    if (entry_count >= MEM_BUDGET_MAX) return nullptr;
+    MemBudgetEntry* e = &entries[entry_count++];
+    memset(e, 0, sizeof(*e));
+    e->name = name;
+    return e;
+}
+
+void mem_budget_begin() {
+    entry_count = 0;
+    boot_free = last_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+void mem_budget_mark(const char* subsystem) {
+    const size_t now = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    MemBudgetEntry* e = entry(subsystem);
+    if (e) e->heap += (int32_t)last_free - (int32_t)now;
+    last_free = now;
+}
+
+void mem_budget_static(const char* subsystem, size_t bytes) {
+    MemBudgetEntry* e = entry(subsystem);
+    if (e) e->stat += bytes;
+}
+
+void* mem_budget_alloc(const char* subsystem, size_t bytes, MemPlace place) {
+    void* p;
+    if (place == MemPlace::Dma) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    } else {
+        // DMA 可能な内部 DRAM は I2S/SPI/WiFi/BT と取り合いになるので、PSRAM があれば先に使う
+        p = heap_caps_malloc_prefer(bytes, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_8BIT);
+    }
+    MemBudgetEntry* e = entry(subsystem);
+    if (p && e) {
+        if (place == MemPlace::Dma) e->dma += bytes;
+        else e->nodma += bytes;
+    }
+    return p;
+}
+
+void mem_budget_report(Print& out) {
+    out.printf("[BUDGET] %-10s %7s %6s %6s %6s\n", "subsystem", "heapKB", "dmaKB", "cpuKB", "bssKB");
+    int32_t heap_sum = 0;
+    uint32_t stat_sum = 0;
+    for (uint8_t i = 0; i < entry_count; ++i) {
+        const MemBudgetEntry& e = entries[i];
+        out.printf("[BUDGET] %-10s %7.1f %6.1f %6.1f %6.1f\n", e.name, e.heap / 1024.0f,
+                   e.dma / 1024.0f, e.nodma / 1024.0f, e.stat / 1024.0f);
+        heap_sum += e.heap;
+        stat_sum += e.stat;
+    }
+    out.printf("[BUDGET] total heap=%.1fKB bss=%.1fKB | free=%uKB (boot %uKB) largest=%uKB dma_free=%uKB min_free=%uKB\n",
+               heap_sum / 1024.0f, stat_sum / 1024.0f,
+               (unsigned)(heap_caps_get_free_size(MALLOC_CAP_8BIT) / 1024), (unsigned)(boot_free / 1024),
+               (unsigned)(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) / 1024),
+               (unsigned)(heap_caps_get_free_size(MALLOC_CAP_DMA) / 1024),
+               (unsigned)(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT) / 1024));
+}
+#endif
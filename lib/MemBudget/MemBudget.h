@@ -0,0 +1,29 @@
+#pragma once
+
+// 起動時の DRAM 予算（サブシステムごとの内訳）。
+//   mem_budget_begin() → 初期化の区切りごとに mem_budget_mark("lvgl") … → mem_budget_report()
+// mark は直前の mark からのヒープ空き容量の減少をそのサブシステムに計上する（BT のメモリ解放などで負になることもある）。
+// 大きなバッファは mem_budget_alloc() で置き場所を明示して確保する:
+//   Dma   : SPI/I2S の DMA が直接読む（内部 DRAM の DMA 可能領域）
+//   NoDma : CPU だけが触る（PSRAM があればそちら、無ければ内部 DRAM）
+// 静的配列（.bss）はヒープに現れないので mem_budget_static() で申告する。
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef MEM_BUDGET_MAX
+#define MEM_BUDGET_MAX 16
+#endif
+
+enum class MemPlace : uint8_t { Dma, NoDma };
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void mem_budget_begin();
+void mem_budget_mark(const char* subsystem);
+void mem_budget_static(const char* subsystem, size_t bytes);
+// 失敗時 nullptr。確保量は subsystem の Dma / NoDma 列に載る
+void* mem_budget_alloc(const char* subsystem, size_t bytes, MemPlace place);
+void mem_budget_report(Print& out);
+#endif
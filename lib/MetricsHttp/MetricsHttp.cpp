@@ -0,0 +1,66 @@
+#ifdef ARDUINO
+#include "MetricsHttp.h"
+
+// 送信バッファ（1接続ずつなので1枚）
+static char s_tx[METRICS_HTTP_BUF];
+// 1回の poll() で送る上限（TCP の送信バッファに収まる量なら write() は待たない）
+#define METRICS_HTTP_TX_CHUNK 1436
+
+bool MetricsServer::begin(MetricsFillCb fill, void* user, uint16_t port) {
+    _fill = fill;
+    _user = user;
+    _server.begin(port);
+    _server.setNoDelay(true);
+    _started = true;
+    return true;
+}
+
+void MetricsServer::close() {
+    _client.stop();
+    _busy = false;
+    _tx = nullptr;
+    _tx_len = _tx_pos = 0;
+}
+
+void MetricsServer::poll() {
+    if (!_started) return;
+    if (!_busy) {
+        // listen ソケットは非ブロッキングなので、待っている接続が無ければすぐ戻る
+        _client = _server.available();
+        if (!_client) return;
+        _busy = true;
+        _req.reset();
+        _t0 = millis();
+    }
+    if (millis() - _t0 > METRICS_HTTP_TIMEOUT_MS) {
+        ++_stats.errors;
+        close();
+        return;
+    }
+
+    if (!_tx) {
+        char in[128];
+        int avail;
+        while (_req.state() == MetricsRequest::Incomplete && (avail = _client.available()) > 0) {
+            const int n = _client.read(reinterpret_cast<uint8_t*>(in), avail < (int)sizeof(in) ? avail : sizeof(in));
+            if (n <= 0) break;
+            _req.feed(in, (size_t)n);
+        }
+        if (_req.state() == MetricsRequest::Incomplete) {
+            // 要求の途中で切られた
+            if (!_client.connected()) { ++_stats.errors; close(); }
+            return;
+        }
+        const uint32_t t0 = micros();
+        _tx_len = metrics_http_build(s_tx, sizeof(s_tx), _req, _fill, _user, &_tx);
+        _tx_pos = 0;
+        _stats.last_build_us = micros() - t0;
+        _stats.last_bytes = (uint32_t)_tx_len;
+        ++_stats.requests;
+    }
+
+    const size_t n = _tx_len - _tx_pos < METRICS_HTTP_TX_CHUNK ? _tx_len - _tx_pos : METRICS_HTTP_TX_CHUNK;
+    _tx_pos += _client.write(reinterpret_cast<const uint8_t*>(_tx + _tx_pos), n);
+    if (_tx_pos >= _tx_len) close();
+}
+#endif
@@ -0,0 +1,148 @@
+#pragma once
+
+// 監視用の小さな HTTP エンドポイント（GET /metrics → Prometheus テキスト）。
+// 応答は静的な送信バッファ1枚に組み立てる: 先頭 METRICS_HTTP_HEAD バイトをヘッダ用に空けて本文を直接書き、
+// 長さが決まってからヘッダを本文の直前に置く（本文はコピーしない）。
+// poll() は受信済みの分だけ読み、送れる分だけ書いてすぐ戻る（LVGL のループを止めない）。
+// 要求の解析と応答の組み立て（MetricsRequest / metrics_http_build）は Arduino 非依存で、
+// tools/metrics_loopback.cpp がホストのループバックで同じコードを試す。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "MetricsText.h"
+
+#ifndef METRICS_HTTP_PORT
+#define METRICS_HTTP_PORT 9100
+#endif
+// 送信バッファ（ヘッダ + 本文）
+#ifndef METRICS_HTTP_BUF
+#define METRICS_HTTP_BUF 2048
+#endif
+#define METRICS_HTTP_HEAD 128
+// 要求ヘッダの上限。これを超えたら 431 で閉じる
+#define METRICS_HTTP_REQ_MAX 512
+// 接続してから応答し終えるまでの上限 [ms]
+#ifndef METRICS_HTTP_TIMEOUT_MS
+#define METRICS_HTTP_TIMEOUT_MS 2000
+#endif
+
+typedef void (*MetricsFillCb)(MetricsText& out, void* user);
+
+// 受け取った分ずつ feed() し、空行まで来たら Ready
+class MetricsRequest {
+public:
+    enum State : uint8_t { Incomplete, Ready, Bad, TooLarge };
+
+    void reset() { _len = 0; _state = Incomplete; }
+
+    State feed(const char* data, size_t n) {
+        for (size_t i = 0; i < n && _state == Incomplete; ++i) {
+            if (_len >= sizeof(_buf) - 1) { _state = TooLarge; break; }
+            _buf[_len++] = data[i];
+            if (_len >= 4 && memcmp(_buf + _len - 4, "\r\n\r\n", 4) == 0) parse();
+            else if (_len >= 2 && memcmp(_buf + _len - 2, "\n\n", 2) == 0) parse();
+        }
+        return _state;
+    }
+
+    State state() const { return _state; }
+    bool is_get() const { return _get; }
+    const char* path() const { return _path; }
+
+private:
+    // "GET /metrics?x HTTP/1.1"
+    void parse() {
+        _buf[_len] = '\0';
+        _get = strncmp(_buf, "GET ", 4) == 0;
+        const char* p = strchr(_buf, ' ');
+        if (!p || p[1] != '/') { _state = Bad; return; }
+        ++p;
+        size_t n = strcspn(p, " ?\r\n");
+        if (n >= sizeof(_path)) n = sizeof(_path) - 1;
+        memcpy(_path, p, n);
+        _path[n] = '\0';
+        _state = Ready;
+    }
+
+    char _buf[METRICS_HTTP_REQ_MAX];
+    size_t _len = 0;
+    State _state = Incomplete;
+    bool _get = false;
+    char _path[32] = "";
+};
+
+// buf（METRICS_HTTP_BUF）に応答を組み立て、送る範囲を *start / 戻り値で返す
+inline size_t metrics_http_build(char* buf, size_t cap, const MetricsRequest& req,
+                                 MetricsFillCb fill, void* user, const char** start) {
+    char* body = buf + METRICS_HTTP_HEAD;
+    size_t body_len = 0;
+    int status = 200;
+    const char* reason = "OK";
+    const char* ctype = "text/plain; version=0.0.4";
+    if (req.state() == MetricsRequest::TooLarge) {
+        status = 431; reason = "Request Header Fields Too Large";
+    } else if (req.state() != MetricsRequest::Ready) {
+        status = 400; reason = "Bad Request";
+    } else if (!req.is_get()) {
+        status = 405; reason = "Method Not Allowed";
+    } else if (strcmp(req.path(), "/metrics") == 0) {
+        MetricsText m(body, cap - METRICS_HTTP_HEAD);
+        if (fill) fill(m, user);
+        body_len = m.size();
+        if (!m.ok()) { status = 500; reason = "Internal Server Error"; body_len = 0; }
+    } else if (strcmp(req.path(), "/") == 0) {
+        static const char index[] = "see /metrics\n";
+        memcpy(body, index, sizeof(index) - 1);
+        body_len = sizeof(index) - 1;
+    } else {
+        status = 404; reason = "Not Found";
+    }
+    if (status != 200) ctype = "text/plain";
+
+    char head[METRICS_HTTP_HEAD];
+    const int n = snprintf(head, sizeof(head),
+                           "HTTP/1.0 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n\r\n",
+                           status, reason, ctype, (unsigned)body_len);
+    const size_t hn = n < 0 ? 0 : (size_t)n < sizeof(head) ? (size_t)n : sizeof(head) - 1;
+    *start = body - hn;
+    memcpy(body - hn, head, hn);
+    return hn + body_len;
+}
+
+struct MetricsHttpStats {
+    uint32_t requests;      // 応答した数（エラー応答を含む）
+    uint32_t errors;        // 4xx/5xx 以外の理由で閉じた（タイムアウト・切断）
+    uint32_t last_build_us; // 直近の /metrics の組み立て時間
+    uint32_t last_bytes;
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+
+class MetricsServer {
+public:
+    bool begin(MetricsFillCb fill, void* user = nullptr, uint16_t port = METRICS_HTTP_PORT);
+    // 1接続ずつ処理する。待たない
+    void poll();
+    const MetricsHttpStats& stats() const { return _stats; }
+
+private:
+    void close();
+
+    WiFiServer _server;
+    WiFiClient _client;
+    bool _busy = false;
+    bool _started = false;
+    MetricsFillCb _fill = nullptr;
+    void* _user = nullptr;
+    MetricsRequest _req;
+    const char* _tx = nullptr;
+    size_t _tx_len = 0;
+    size_t _tx_pos = 0;
+    uint32_t _t0 = 0;
+    MetricsHttpStats _stats = {};
+};
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+// Prometheus のテキスト形式（version 0.0.4）を呼び出し側のバッファへ直接書く。
+//   MetricsText m(buf, sizeof(buf));
+//   m.gauge("jc_heap_free_bytes", free);
+//   m.type("jc_touch_errors_total", "counter").value("jc_touch_errors_total", naks, "kind", "nak");
+// String や printf は使わない。入りきらなければ ok() が false（それまでに書いた分は残る）。
+// Arduino 非依存。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class MetricsText {
+public:
+    MetricsText(char* buf, size_t cap) : _begin(buf), _p(buf), _end(buf + cap) {}
+
+    // "# TYPE name kind"（kind: gauge / counter）
+    MetricsText& type(const char* name, const char* kind) {
+        put("# TYPE ");
+        put(name);
+        put(' ');
+        put(kind);
+        put('\n');
+        return *this;
+    }
+
+    // name{label="label_val"} v
+    MetricsText& value(const char* name, int64_t v, const char* label = nullptr, const char* label_val = nullptr) {
+        head(name, label, label_val);
+        put_int(v);
+        put('\n');
+        return *this;
+    }
+
+    // 小数3桁（v_milli / 1000）
+    MetricsText& value_milli(const char* name, int64_t v_milli, const char* label = nullptr,
+                             const char* label_val = nullptr) {
+        head(name, label, label_val);
+        if (v_milli < 0) { put('-'); v_milli = -v_milli; }
+        put_int(v_milli / 1000);
+        put('.');
+        const int frac = (int)(v_milli % 1000);
+        put((char)('0' + frac / 100));
+        put((char)('0' + frac / 10 % 10));
+        put((char)('0' + frac % 10));
+        put('\n');
+        return *this;
+    }
+
+    MetricsText& gauge(const char* name, int64_t v) { return type(name, "gauge").value(name, v); }
+    MetricsText& counter(const char* name, int64_t v) { return type(name, "counter").value(name, v); }
+
+    bool ok() const { return !_overflow; }
+    size_t size() const { return (size_t)(_p - _begin); }
+
+private:
+    void head(const char* name, const char* label, const char* label_val) {
+        put(name);
+        if (label) {
+            put('{');
+            put(label);
+            put("=\"");
+            put(label_val);
+            put("\"}");
+        }
+        put(' ');
+    }
+    void put(char c) {
+        if (_p < _end) *_p++ = c;
+        else _overflow = true;
+    }
+    void put(const char* s) {
+        const size_t n = strlen(s);
+        if ((size_t)(_end - _p) < n) { _overflow = true; _p = _end; return; }
+        memcpy(_p, s, n);
+        _p += n;
+    }
+    void put_int(int64_t v) {
+        char tmp[20];
+        int n = 0;
+        uint64_t u = v < 0 ? (uint64_t)(-(v + 1)) + 1 : (uint64_t)v;
+        if (v < 0) put('-');
+        do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+        while (n) put(tmp[--n]);
+    }
+
+    char* _begin;
+    char* _p;
+    char* _end;
+    bool _overflow = false;
+};
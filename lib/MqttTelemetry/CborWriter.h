@@ -0,0 +1,56 @@
+#pragma once
+
+// 最小限の CBOR（RFC 8949）エンコーダ。呼び出し側のバッファへ直接書く。
+// 使うのは数値・文字列・長さ確定の配列/マップだけ。入りきらなければ ok() が false。
+// Arduino 非依存。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class CborWriter {
+public:
+    CborWriter(uint8_t* buf, size_t cap) : _begin(buf), _p(buf), _end(buf + cap) {}
+
+    CborWriter& uint(uint64_t v) { head(0, v); return *this; }
+    CborWriter& sint(int64_t v) {
+        if (v >= 0) head(0, (uint64_t)v);
+        else head(1, (uint64_t)(-(v + 1)));
+        return *this;
+    }
+    CborWriter& text(const char* s) {
+        const size_t n = strlen(s);
+        head(3, n);
+        raw(s, n);
+        return *this;
+    }
+    CborWriter& array(size_t n) { head(4, n); return *this; }
+    CborWriter& map(size_t n) { head(5, n); return *this; }
+
+    bool ok() const { return !_overflow; }
+    size_t size() const { return (size_t)(_p - _begin); }
+
+private:
+    // major type + 引数（0..23 は1バイト、以降 1/2/4/8 バイトのビッグエンディアン）
+    void head(uint8_t major, uint64_t v) {
+        const uint8_t m = (uint8_t)(major << 5);
+        if (v < 24) { put(m | (uint8_t)v); return; }
+        int n = v <= 0xFF ? 1 : v <= 0xFFFF ? 2 : v <= 0xFFFFFFFFull ? 4 : 8;
+        put(m | (uint8_t)(n == 1 ? 24 : n == 2 ? 25 : n == 4 ? 26 : 27));
+        for (int i = n - 1; i >= 0; --i) put((uint8_t)(v >> (i * 8)));
+    }
+    void put(uint8_t b) {
+        if (_p < _end) *_p++ = b;
+        else _overflow = true;
+    }
+    void raw(const void* d, size_t n) {
+        if ((size_t)(_end - _p) < n) { _overflow = true; _p = _end; return; }
+        memcpy(_p, d, n);
+        _p += n;
+    }
+
+    uint8_t* _begin;
+    uint8_t* _p;
+    uint8_t* _end;
+    bool _overflow = false;
+};
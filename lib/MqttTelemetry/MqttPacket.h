@@ -0,0 +1,100 @@
+#pragma once
+
+// MQTT 3.1.1 のパケット組み立て/読み取り（QoS 0 の送信に要る分 + SUBSCRIBE）。
+// PUBLISH はヘッダだけを作り、本文はキューから取り出したバッファをそのまま続けて送る。
+// Arduino 非依存（tools/mqtt_bench.cpp がホストで同じコードを使う）。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+enum MqttType : uint8_t {
+    MQTT_CONNECT = 1, MQTT_CONNACK = 2, MQTT_PUBLISH = 3, MQTT_SUBSCRIBE = 8, MQTT_SUBACK = 9,
+    MQTT_PINGREQ = 12, MQTT_PINGRESP = 13, MQTT_DISCONNECT = 14
+};
+
+// 残りの長さ（可変長 1..4 バイト）。戻り値は書いたバイト数
+inline size_t mqtt_put_length(uint8_t* p, uint32_t len) {
+    size_t n = 0;
+    do {
+        uint8_t b = len % 128;
+        len /= 128;
+        if (len) b |= 0x80;
+        p[n++] = b;
+    } while (len && n < 4);
+    return n;
+}
+
+inline size_t mqtt_put_string(uint8_t* p, const char* s) {
+    const size_t n = strlen(s);
+    p[0] = (uint8_t)(n >> 8);
+    p[1] = (uint8_t)n;
+    memcpy(p + 2, s, n);
+    return n + 2;
+}
+
+// buf は 16 + 各文字列長 + 6 バイト以上
+inline size_t mqtt_connect(uint8_t* buf, const char* client_id, uint16_t keepalive_s,
+                           const char* user = nullptr, const char* pass = nullptr) {
+    uint8_t flags = 0x02;   // clean session
+    uint32_t rem = 10 + 2 + (uint32_t)strlen(client_id);
+    if (user && *user) { flags |= 0x80; rem += 2 + (uint32_t)strlen(user); }
+    if (pass && *pass && (flags & 0x80)) { flags |= 0x40; rem += 2 + (uint32_t)strlen(pass); }
+    size_t n = 0;
+    buf[n++] = MQTT_CONNECT << 4;
+    n += mqtt_put_length(buf + n, rem);
+    n += mqtt_put_string(buf + n, "MQTT");
+    buf[n++] = 4;           // protocol level 3.1.1
+    buf[n++] = flags;
+    buf[n++] = (uint8_t)(keepalive_s >> 8);
+    buf[n++] = (uint8_t)keepalive_s;
+    n += mqtt_put_string(buf + n, client_id);
+    if (flags & 0x80) n += mqtt_put_string(buf + n, user);
+    if (flags & 0x40) n += mqtt_put_string(buf + n, pass);
+    return n;
+}
+
+// QoS 0 の PUBLISH ヘッダ（固定ヘッダ + トピック）。buf は 7 + トピック長バイト以上
+inline size_t mqtt_publish_header(uint8_t* buf, const char* topic, size_t payload_len) {
+    size_t n = 0;
+    buf[n++] = MQTT_PUBLISH << 4;
+    n += mqtt_put_length(buf + n, (uint32_t)(2 + strlen(topic) + payload_len));
+    n += mqtt_put_string(buf + n, topic);
+    return n;
+}
+
+// QoS 0 で購読（ホスト側の受信確認用）
+inline size_t mqtt_subscribe(uint8_t* buf, uint16_t packet_id, const char* topic) {
+    size_t n = 0;
+    buf[n++] = (MQTT_SUBSCRIBE << 4) | 0x02;
+    n += mqtt_put_length(buf + n, (uint32_t)(2 + 2 + strlen(topic) + 1));
+    buf[n++] = (uint8_t)(packet_id >> 8);
+    buf[n++] = (uint8_t)packet_id;
+    n += mqtt_put_string(buf + n, topic);
+    buf[n++] = 0;
+    return n;
+}
+
+inline size_t mqtt_pingreq(uint8_t* buf) { buf[0] = MQTT_PINGREQ << 4; buf[1] = 0; return 2; }
+inline size_t mqtt_disconnect(uint8_t* buf) { buf[0] = MQTT_DISCONNECT << 4; buf[1] = 0; return 2; }
+
+// 受信バイト列から1パケットを切り出す（溜めておいた先頭から呼ぶ）。
+// 揃っていれば true で *type / *body / *body_len / *total を返す
+inline bool mqtt_parse(const uint8_t* p, size_t n, uint8_t* type, const uint8_t** body,
+                       uint32_t* body_len, size_t* total) {
+    if (n < 2) return false;
+    uint32_t len = 0, mul = 1;
+    size_t i = 1;
+    for (;;) {
+        if (i >= n || i > 4) return false;
+        len += (p[i] & 0x7F) * mul;
+        mul *= 128;
+        if (!(p[i++] & 0x80)) break;
+    }
+    if (n - i < len) return false;
+    *type = p[0] >> 4;
+    *body = p + i;
+    *body_len = len;
+    *total = i + len;
+    return true;
+}
@@ -0,0 +1,180 @@
+#ifdef ARDUINO
+#include "MqttTelemetry.h"
+
+static uint8_t s_queue[TELEMETRY_QUEUE_KB * 1024];
+static uint8_t s_encode[TELEMETRY_PAYLOAD_MAX];   // sample() 側（CBOR を組み立てる）
+static uint8_t s_tx[TELEMETRY_PAYLOAD_MAX];       // 送信タスク側（キューの先頭を取り出す）
+
+#define MQTT_TELEMETRY_BACKOFF_MIN 1000
+#define MQTT_TELEMETRY_BACKOFF_MAX 30000
+#define MQTT_TELEMETRY_CONNACK_MS  3000
+
+MqttTelemetry::MqttTelemetry() : _q(s_queue, sizeof(s_queue)) {}
+
+bool MqttTelemetry::begin(const MqttTelemetryConfig& cfg, UBaseType_t priority, BaseType_t core) {
+    _cfg = cfg;
+    if (!_cfg.keepalive_s) _cfg.keepalive_s = 60;
+    if (!_cfg.batch_ms) _cfg.batch_ms = 10000;
+    _mtx = xSemaphoreCreateMutex();
+    return _mtx && xTaskCreatePinnedToCore(task, "mqtt_tlm", 4096, this, priority, &_task, core) == pdPASS;
+}
+
+void MqttTelemetry::sample(const TelemetrySample& s) {
+    if (!_mtx) return;
+    // _batch / _seq / s_encode も呼び出し元のタスク間で共有するので、組み立てからキューに積むまで _mtx を持つ
+    xSemaphoreTake(_mtx, portMAX_DELAY);
+    if (_batch.count() == 0) _batch_t0 = s.t_ms;
+    _batch.add(s);
+    if (!_batch.full() && s.t_ms - _batch_t0 < _cfg.batch_ms) {
+        xSemaphoreGive(_mtx);
+        return;
+    }
+
+    const size_t n = _batch.encode(s_encode, sizeof(s_encode), _cfg.client_id, _seq++);
+    _batch.clear();
+    if (n) {
+        _q.push(s_encode, n);
+        ++_stats.batches;
+    }
+    xSemaphoreGive(_mtx);
+    if (n && _task) xTaskNotifyGive(_task);
+}
+
+void MqttTelemetry::kick() {
+    _kick = true;
+    if (_task) xTaskNotifyGive(_task);
+}
+
+MqttTelemetryStats MqttTelemetry::stats() {
+    MqttTelemetryStats s;
+    xSemaphoreTake(_mtx, portMAX_DELAY);
+    s = _stats;
+    s.queue = _q.stats();
+    xSemaphoreGive(_mtx);
+    return s;
+}
+
+void MqttTelemetry::report(Print& out) {
+    if (!_mtx) return;
+    MqttTelemetryStats s = stats();
+    out.printf("[MQTT] %s batches=%lu sent=%lu (%luB) queue=%lu/%luB hw=%luB n=%lu dropped=%lu conn=%lu fail=%lu disc=%lu\n",
+               s.connected ? "up" : "down", (unsigned long)s.batches, (unsigned long)s.published,
+               (unsigned long)s.published_bytes, (unsigned long)s.queue.used, (unsigned long)s.queue.cap,
+               (unsigned long)s.queue.high_water, (unsigned long)s.queue.count, (unsigned long)s.queue.dropped,
+               (unsigned long)s.connects, (unsigned long)s.connect_fails, (unsigned long)s.disconnects);
+}
+
+void MqttTelemetry::task(void* arg) {
+    static_cast<MqttTelemetry*>(arg)->loop();
+}
+
+bool MqttTelemetry::connect_broker(WiFiClient& c) {
+    if (!c.connect(_cfg.host, _cfg.port)) return false;
+    uint8_t buf[160];
+    if (strlen(_cfg.client_id) + (_cfg.user ? strlen(_cfg.user) : 0) + (_cfg.pass ? strlen(_cfg.pass) : 0) + 22 > sizeof(buf)) {
+        c.stop();
+        return false;
+    }
+    const size_t n = mqtt_connect(buf, _cfg.client_id, _cfg.keepalive_s, _cfg.user, _cfg.pass);
+    if (c.write(buf, n) != n) { c.stop(); return false; }
+    // CONNACK（4バイト）を待つ
+    size_t got = 0;
+    const uint32_t t0 = millis();
+    while (got < 4 && millis() - t0 < MQTT_TELEMETRY_CONNACK_MS) {
+        if (c.available()) {
+            const int r = c.read(buf + got, 4 - got);
+            if (r > 0) got += (size_t)r;
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+    uint8_t type;
+    const uint8_t* body;
+    uint32_t body_len;
+    size_t total;
+    if (got < 4 || !mqtt_parse(buf, got, &type, &body, &body_len, &total) || type != MQTT_CONNACK ||
+        body_len != 2 || body[1] != 0) {
+        c.stop();
+        return false;
+    }
+    return true;
+}
+
+// キューを先頭から送る。送れなかったら false（接続を捨てる）
+bool MqttTelemetry::flush(WiFiClient& c, uint32_t* last_tx) {
+    uint8_t head[128];
+    const size_t topic_len = strlen(_cfg.topic);
+    if (topic_len + 7 > sizeof(head)) return true;
+    for (;;) {
+        uint32_t id;
+        xSemaphoreTake(_mtx, portMAX_DELAY);
+        const size_t n = _q.front(s_tx, sizeof(s_tx), &id);
+        xSemaphoreGive(_mtx);
+        if (!n) return true;
+        const size_t h = mqtt_publish_header(head, _cfg.topic, n);
+        if (c.write(head, h) != h || c.write(s_tx, n) != n) return false;
+        xSemaphoreTake(_mtx, portMAX_DELAY);
+        // 送っている間に古い順に捨てられていたら pop しない
+        _q.pop(id);
+        ++_stats.published;
+        _stats.published_bytes += (uint32_t)(h + n);
+        xSemaphoreGive(_mtx);
+        *last_tx = millis();
+    }
+}
+
+void MqttTelemetry::loop() {
+    WiFiClient c;
+    bool up = false;
+    uint32_t backoff = MQTT_TELEMETRY_BACKOFF_MIN;
+    uint32_t next_try = 0;
+    uint32_t last_tx = 0;
+
+    auto set_up = [&](bool v, bool lost) {
+        up = v;
+        xSemaphoreTake(_mtx, portMAX_DELAY);
+        _stats.connected = v;
+        if (lost) ++_stats.disconnects;
+        xSemaphoreGive(_mtx);
+    };
+
+    for (;;) {
+        // sample() / kick() で起こされるか、1秒ごとに見回る
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        if (WiFi.status() != WL_CONNECTED) {
+            if (up) { c.stop(); set_up(false, true); }
+            continue;
+        }
+        if (!up) {
+            if (!_kick && (int32_t)(millis() - next_try) < 0) continue;
+            _kick = false;
+            if (!connect_broker(c)) {
+                xSemaphoreTake(_mtx, portMAX_DELAY);
+                ++_stats.connect_fails;
+                xSemaphoreGive(_mtx);
+                next_try = millis() + backoff;
+                backoff = backoff * 2 < MQTT_TELEMETRY_BACKOFF_MAX ? backoff * 2 : MQTT_TELEMETRY_BACKOFF_MAX;
+                continue;
+            }
+            backoff = MQTT_TELEMETRY_BACKOFF_MIN;
+            last_tx = millis();
+            xSemaphoreTake(_mtx, portMAX_DELAY);
+            ++_stats.connects;
+            xSemaphoreGive(_mtx);
+            set_up(true, false);
+        }
+        // 受け取るのは PINGRESP くらいなので読み捨てる
+        while (c.available()) c.read();
+        if (!c.connected() || !flush(c, &last_tx)) {
+            c.stop();
+            set_up(false, true);
+            continue;
+        }
+        if (millis() - last_tx > (uint32_t)_cfg.keepalive_s * 500) {
+            uint8_t ping[2];
+            if (c.write(ping, mqtt_pingreq(ping)) != 2) { c.stop(); set_up(false, true); continue; }
+            last_tx = millis();
+        }
+    }
+}
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+// MQTT でテレメトリを送る（QoS 0）。
+// sample() で受けたサンプルを TelemetryBatch に溜め、batch_ms ごと（または満杯で）CBOR にして TelemetryQueue に積む。
+// 送信は core 0 のタスク: WiFi がつながっていればブローカーへ接続（失敗したら 1〜30秒のバックオフ）し、キューを先頭から送る。
+// ブローカーに届かない間はキューが古い順に捨てるので、メモリは TELEMETRY_QUEUE_KB で頭打ちになる。
+// ホストでの試験は tools/mqtt_bench.cpp（ローカルの Mosquitto に対してスループットとキューの上限を測る）。
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CborWriter.h"
+#include "TelemetryBatch.h"
+#include "TelemetryQueue.h"
+#include "MqttPacket.h"
+
+// オフライン時に溜めておく量 [KB]（1バッチ 30 サンプルで 500B 前後）
+#ifndef TELEMETRY_QUEUE_KB
+#define TELEMETRY_QUEUE_KB 8
+#endif
+#ifndef TELEMETRY_SAMPLE_MS
+#define TELEMETRY_SAMPLE_MS 1000
+#endif
+// 1バッチ（= 1メッセージ）の最大ペイロード
+#ifndef TELEMETRY_PAYLOAD_MAX
+#define TELEMETRY_PAYLOAD_MAX 1024
+#endif
+
+struct MqttTelemetryConfig {
+    const char* host;
+    uint16_t    port;
+    const char* client_id;
+    const char* topic;
+    const char* user;          // 不要なら nullptr
+    const char* pass;
+    uint16_t    keepalive_s;
+    uint32_t    batch_ms;      // この間隔でまとめて1メッセージにする
+};
+
+struct MqttTelemetryStats {
+    TelemetryQueueStats queue;
+    uint32_t batches;          // 積んだバッチ数
+    uint32_t published;        // 送ったメッセージ数
+    uint32_t published_bytes;  // MQTT ヘッダ込み
+    uint32_t connects;
+    uint32_t connect_fails;
+    uint32_t disconnects;
+    bool     connected;
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+class MqttTelemetry {
+public:
+    MqttTelemetry();
+    bool begin(const MqttTelemetryConfig& cfg, UBaseType_t priority = 1, BaseType_t core = 0);
+    // TELEMETRY_SAMPLE_MS ごとに呼ぶ（どのタスクからでもよい）
+    void sample(const TelemetrySample& s);
+    // WiFi がつながった直後に呼ぶと、バックオフを待たずに接続する
+    void kick();
+    MqttTelemetryStats stats();
+    void report(Print& out);
+
+private:
+    static void task(void* arg);
+    void loop();
+    bool connect_broker(WiFiClient& c);
+    bool flush(WiFiClient& c, uint32_t* last_tx);
+
+    MqttTelemetryConfig _cfg = {};
+    TelemetryQueue _q;
+    TelemetryBatch _batch;
+    uint32_t _batch_t0 = 0;
+    uint32_t _seq = 0;
+    SemaphoreHandle_t _mtx = nullptr;
+    TaskHandle_t _task = nullptr;
+    volatile bool _kick = false;
+    MqttTelemetryStats _stats = {};
+};
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+// 一定間隔のサンプルを列ごとにまとめて CBOR にする。
+//   {"v":1,"id":ID,"seq":N,"t0":最初のサンプルの時刻[ms],"dt":間隔[ms],"n":件数,
+//    "heap":[...],"lb":[...],"ur":[...],"ab":[...],"tp":[...],"te":[...],"rssi":[...]}
+// ur / tp / te は区間ごとの増分（カウンタの差）、それ以外はサンプル時点の値。
+// 列ごとに並べるとキー名は1回で済み、値も小さい整数になって CBOR では1〜3バイトに収まる。
+// Arduino 非依存。
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CborWriter.h"
+
+#ifndef TELEMETRY_BATCH_MAX
+#define TELEMETRY_BATCH_MAX 30
+#endif
+
+struct TelemetrySample {
+    uint32_t t_ms;
+    uint32_t heap_free;
+    uint32_t heap_largest;
+    uint32_t audio_underruns;   // 区間の増分
+    uint32_t audio_buf;         // 音声バッファ残量 [bytes]
+    uint32_t touch_presses;     // 区間の増分
+    uint32_t touch_errors;      // 区間の増分
+    int32_t  rssi;
+};
+
+class TelemetryBatch {
+public:
+    bool add(const TelemetrySample& s) {
+        if (_n >= TELEMETRY_BATCH_MAX) return false;
+        _s[_n++] = s;
+        return true;
+    }
+    bool full() const { return _n >= TELEMETRY_BATCH_MAX; }
+    uint16_t count() const { return _n; }
+    void clear() { _n = 0; }
+
+    // 戻り値は書いたバイト数（入りきらなければ 0）
+    size_t encode(uint8_t* buf, size_t cap, const char* id, uint32_t seq) const {
+        CborWriter w(buf, cap);
+        w.map(13);
+        w.text("v").uint(1);
+        w.text("id").text(id);
+        w.text("seq").uint(seq);
+        w.text("t0").uint(_n ? _s[0].t_ms : 0);
+        w.text("dt").uint(_n > 1 ? (_s[_n - 1].t_ms - _s[0].t_ms) / (_n - 1) : 0);
+        w.text("n").uint(_n);
+        column(w, "heap", &TelemetrySample::heap_free);
+        column(w, "lb", &TelemetrySample::heap_largest);
+        column(w, "ur", &TelemetrySample::audio_underruns);
+        column(w, "ab", &TelemetrySample::audio_buf);
+        column(w, "tp", &TelemetrySample::touch_presses);
+        column(w, "te", &TelemetrySample::touch_errors);
+        w.text("rssi").array(_n);
+        for (uint16_t i = 0; i < _n; ++i) w.sint(_s[i].rssi);
+        return w.ok() ? w.size() : 0;
+    }
+
+private:
+    void column(CborWriter& w, const char* key, uint32_t TelemetrySample::*field) const {
+        w.text(key).array(_n);
+        for (uint16_t i = 0; i < _n; ++i) w.uint(_s[i].*field);
+    }
+
+    TelemetrySample _s[TELEMETRY_BATCH_MAX];
+    uint16_t _n = 0;
+};
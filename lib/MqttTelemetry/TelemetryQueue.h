@@ -0,0 +1,102 @@
+#pragma once
+
+// 送信待ちのペイロードを溜める固定長のリング（オフライン時のキュー）。
+// 1件 = [長さ 2B][id 4B][本文]。入りきらないときは古いものから捨てるので、使うメモリは常に cap のまま。
+// 送信側は front() でコピーしてから送り、送れたら pop(id) する（送っている間に捨てられていたら何もしない）。
+// スレッド安全ではない（呼び出し側で排他する）。Arduino 非依存。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+struct TelemetryQueueStats {
+    uint32_t pushed;
+    uint32_t dropped;      // 古い順に捨てた件数
+    uint32_t rejected;     // 1件が cap を超えて積めなかった
+    uint32_t count;        // 現在の件数
+    uint32_t used;         // 現在の使用バイト（ヘッダ込み）
+    uint32_t high_water;   // 使用バイトの最大
+    uint32_t cap;
+};
+
+class TelemetryQueue {
+public:
+    static const size_t kHeader = 6;
+
+    TelemetryQueue(uint8_t* storage, size_t cap) : _buf(storage), _cap(cap) { _stats.cap = (uint32_t)cap; }
+
+    bool push(const uint8_t* data, size_t len) {
+        if (len > 0xFFFF || len + kHeader > _cap) { ++_stats.rejected; return false; }
+        while (_cap - _used < len + kHeader) drop_front();
+        uint8_t h[kHeader] = {(uint8_t)(len >> 8), (uint8_t)len,
+                              (uint8_t)(_next_id >> 24), (uint8_t)(_next_id >> 16),
+                              (uint8_t)(_next_id >> 8), (uint8_t)_next_id};
+        ++_next_id;
+        write(h, kHeader);
+        write(data, len);
+        ++_stats.pushed;
+        ++_stats.count;
+        if (_used > _stats.high_water) _stats.high_water = (uint32_t)_used;
+        return true;
+    }
+
+    // 先頭をコピーする。戻り値は本文の長さ（空なら 0、out が小さければ 0 で *id だけ返す）
+    size_t front(uint8_t* out, size_t out_cap, uint32_t* id) const {
+        if (_stats.count == 0) return 0;
+        uint8_t h[kHeader];
+        read(_head, h, kHeader);
+        const size_t len = ((size_t)h[0] << 8) | h[1];
+        *id = ((uint32_t)h[2] << 24) | ((uint32_t)h[3] << 16) | ((uint32_t)h[4] << 8) | h[5];
+        if (len > out_cap) return 0;
+        read((_head + kHeader) % _cap, out, len);
+        return len;
+    }
+
+    // 先頭が id のときだけ取り除く
+    bool pop(uint32_t id) {
+        uint32_t cur;
+        uint8_t dummy;
+        if (_stats.count == 0) return false;
+        front(&dummy, 0, &cur);
+        if (cur != id) return false;
+        drop_front(false);
+        return true;
+    }
+
+    bool empty() const { return _stats.count == 0; }
+    TelemetryQueueStats stats() const {
+        TelemetryQueueStats s = _stats;
+        s.used = (uint32_t)_used;
+        return s;
+    }
+
+private:
+    void drop_front(bool count_drop = true) {
+        uint8_t h[2];
+        read(_head, h, 2);
+        const size_t n = kHeader + (((size_t)h[0] << 8) | h[1]);
+        _head = (_head + n) % _cap;
+        _used -= n;
+        --_stats.count;
+        if (count_drop) ++_stats.dropped;
+    }
+    void write(const uint8_t* d, size_t n) {
+        size_t tail = (_head + _used) % _cap;
+        const size_t k = n < _cap - tail ? n : _cap - tail;
+        memcpy(_buf + tail, d, k);
+        memcpy(_buf, d + k, n - k);
+        _used += n;
+    }
+    void read(size_t pos, uint8_t* out, size_t n) const {
+        const size_t k = n < _cap - pos ? n : _cap - pos;
+        memcpy(out, _buf + pos, k);
+        memcpy(out + k, _buf, n - k);
+    }
+
+    uint8_t* _buf;
+    size_t _cap;
+    size_t _head = 0;
+    size_t _used = 0;
+    uint32_t _next_id = 1;
+    TelemetryQueueStats _stats = {};
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+// OTA イメージ（tools/ota_pack.py が作る）の形式。
+//   [OtaImageHeader 52B][本体]
+// 本体は firmware.bin そのもの（compression=0）か zlib 圧縮（compression=1）。
+// sha256 は展開後（= 書き込む内容）のハッシュで、切り替え前にこれと照合する。
+// Arduino 非依存。
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define OTA_IMAGE_MAGIC "JOT1"
+
+enum class OtaCompression : uint8_t { None = 0, Zlib = 1 };
+
+#pragma pack(push, 1)
+struct OtaImageHeader {
+    char     magic[4];      // "JOT1"
+    uint8_t  version;       // 1
+    uint8_t  compression;   // OtaCompression
+    uint16_t reserved;
+    uint32_t raw_size;      // 展開後のバイト数
+    uint32_t body_size;     // ヘッダの後ろに続くバイト数
+    uint8_t  sha256[32];    // 展開後の SHA-256
+    uint32_t header_crc;    // ここまでの CRC32
+};
+#pragma pack(pop)
+
+static_assert(sizeof(OtaImageHeader) == 52, "OtaImageHeader layout");
@@ -0,0 +1,286 @@
+#ifdef ARDUINO
+#include "OtaUpdate.h"
+#include <string.h>
+#include <HTTPClient.h>
+#include <esp_ota_ops.h>
+#include <esp32/rom/crc.h>
+#include <esp32/rom/miniz.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/version.h>
+
+#define OTA_BLOCK_SIZE 4096
+// 受信がこれ以上止まったら諦める [ms]
+#define OTA_STALL_MS 10000
+
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+#define ota_sha256_starts(c) mbedtls_sha256_starts(c, 0)
+#define ota_sha256_update    mbedtls_sha256_update
+#define ota_sha256_finish    mbedtls_sha256_finish
+#else
+#define ota_sha256_starts(c) mbedtls_sha256_starts_ret(c, 0)
+#define ota_sha256_update    mbedtls_sha256_update_ret
+#define ota_sha256_finish    mbedtls_sha256_finish_ret
+#endif
+
+struct OtaBlock {
+    uint8_t* data;
+    uint16_t len;    // 0 は終わりの合図
+};
+
+// 書き込みタスクとの受け渡し
+struct OtaPipe {
+    QueueHandle_t full;
+    QueueHandle_t free;
+    SemaphoreHandle_t done;
+    esp_ota_handle_t handle;
+    mbedtls_sha256_context sha;
+    volatile esp_err_t err;
+    uint32_t flash_ms;
+};
+
+static void flash_task(void* arg) {
+    OtaPipe* p = static_cast<OtaPipe*>(arg);
+    OtaBlock b;
+    for (;;) {
+        xQueueReceive(p->full, &b, portMAX_DELAY);
+        if (b.len == 0) break;
+        if (p->err == ESP_OK) {
+            const uint32_t t0 = millis();
+            ota_sha256_update(&p->sha, b.data, b.len);
+            // OTA_WITH_SEQUENTIAL_WRITES: セクタの境目でそのセクタだけを消してから書く
+            p->err = esp_ota_write(p->handle, b.data, b.len);
+            p->flash_ms += millis() - t0;
+        }
+        xQueueSend(p->free, &b, portMAX_DELAY);
+    }
+    xSemaphoreGive(p->done);
+    vTaskDelete(nullptr);
+}
+
+bool OtaUpdater::start(const char* url) {
+    if (_task) return false;
+    strncpy(_url, url, sizeof(_url) - 1);
+    _url[sizeof(_url) - 1] = '\0';
+    _stats = {};
+    _stats.state = OtaState::Running;
+    TaskHandle_t h = nullptr;
+    // 受信と展開は WiFi と同じ core 0。書き込みタスクは core 1 に置く
+    if (xTaskCreatePinnedToCore(task, "ota_net", 6144, this, 3, &h, 0) != pdPASS) {
+        _stats.state = OtaState::Failed;
+        _stats.error = "task";
+        return false;
+    }
+    _task = h;
+    return true;
+}
+
+void OtaUpdater::task(void* arg) {
+    OtaUpdater* self = static_cast<OtaUpdater*>(arg);
+    self->run();
+    self->_task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+// n バイト揃うまで読む（受信待ちの時間を *wait_ms に足す）
+static bool read_exact(WiFiClient* s, uint8_t* buf, size_t n, uint32_t* wait_ms) {
+    size_t got = 0;
+    uint32_t idle_since = millis();
+    while (got < n) {
+        const int avail = s->available();
+        if (avail <= 0) {
+            if (!s->connected() || millis() - idle_since > OTA_STALL_MS) return false;
+            const uint32_t t0 = millis();
+            vTaskDelay(pdMS_TO_TICKS(2));
+            *wait_ms += millis() - t0;
+            continue;
+        }
+        const size_t want = n - got < (size_t)avail ? n - got : (size_t)avail;
+        const int r = s->read(buf + got, want);
+        if (r > 0) { got += (size_t)r; idle_since = millis(); }
+    }
+    return true;
+}
+
+void OtaUpdater::run() {
+    const uint32_t t_start = millis();
+    OtaStats& st = _stats;
+    const char* error = nullptr;
+    HTTPClient http;
+    OtaPipe pipe = {};
+    OtaBlock blocks[OTA_UPDATE_BLOCKS] = {};
+    OtaBlock cur = {nullptr, 0};
+    tinfl_decompressor* inf = nullptr;
+    uint8_t* dict = nullptr;
+    bool writer = false;
+    bool begun = false;
+    const esp_partition_t* part = nullptr;
+    OtaImageHeader h;
+    WiFiClient* s = nullptr;
+    uint8_t in[2048];
+
+    // 展開した分を 4KB ブロックに詰めて書き込みタスクへ渡す
+    auto emit = [&](const uint8_t* d, size_t n) -> bool {
+        while (n) {
+            if (!cur.data) {
+                const uint32_t t0 = millis();
+                xQueueReceive(pipe.free, &cur, portMAX_DELAY);
+                st.wait_ms += millis() - t0;
+                cur.len = 0;
+            }
+            const size_t k = n < (size_t)(OTA_BLOCK_SIZE - cur.len) ? n : (size_t)(OTA_BLOCK_SIZE - cur.len);
+            memcpy(cur.data + cur.len, d, k);
+            cur.len += (uint16_t)k;
+            d += k;
+            n -= k;
+            st.raw_bytes += (uint32_t)k;
+            if (st.raw_bytes > h.raw_size) return false;
+            if (cur.len == OTA_BLOCK_SIZE) {
+                xQueueSend(pipe.full, &cur, portMAX_DELAY);
+                cur.data = nullptr;
+            }
+        }
+        return pipe.err == ESP_OK;
+    };
+
+    do {
+        http.begin(_url);
+        const int code = http.GET();
+        if (code != HTTP_CODE_OK) { error = "http"; break; }
+        s = http.getStreamPtr();
+        if (!read_exact(s, reinterpret_cast<uint8_t*>(&h), sizeof(h), &st.net_ms)) { error = "header read"; break; }
+        st.net_bytes = sizeof(h);
+        if (memcmp(h.magic, OTA_IMAGE_MAGIC, 4) != 0 || h.version != 1 ||
+            crc32_le(0, reinterpret_cast<const uint8_t*>(&h), offsetof(OtaImageHeader, header_crc)) != h.header_crc) {
+            error = "bad header";
+            break;
+        }
+        const int len = http.getSize();
+        if (len > 0 && (uint32_t)len != sizeof(h) + h.body_size) { error = "length"; break; }
+        st.compressed = h.compression == (uint8_t)OtaCompression::Zlib;
+        st.raw_total = h.raw_size;
+
+        part = esp_ota_get_next_update_partition(nullptr);
+        if (!part || h.raw_size > part->size) { error = "no slot"; break; }
+#ifdef OTA_WITH_SEQUENTIAL_WRITES
+        if (esp_ota_begin(part, OTA_WITH_SEQUENTIAL_WRITES, &pipe.handle) != ESP_OK) { error = "ota begin"; break; }
+#else
+        if (esp_ota_begin(part, h.raw_size, &pipe.handle) != ESP_OK) { error = "ota begin"; break; }
+#endif
+        begun = true;
+
+        pipe.full = xQueueCreate(OTA_UPDATE_BLOCKS + 1, sizeof(OtaBlock));
+        pipe.free = xQueueCreate(OTA_UPDATE_BLOCKS, sizeof(OtaBlock));
+        pipe.done = xSemaphoreCreateBinary();
+        if (!pipe.full || !pipe.free || !pipe.done) { error = "no memory"; break; }
+        for (int i = 0; i < OTA_UPDATE_BLOCKS; ++i) {
+            blocks[i].data = static_cast<uint8_t*>(malloc(OTA_BLOCK_SIZE));
+            if (!blocks[i].data) { error = "no memory"; break; }
+            xQueueSend(pipe.free, &blocks[i], 0);
+        }
+        if (error) break;
+        if (st.compressed) {
+            inf = static_cast<tinfl_decompressor*>(malloc(sizeof(tinfl_decompressor)));
+            dict = static_cast<uint8_t*>(malloc(TINFL_LZ_DICT_SIZE));
+            if (!inf || !dict) { error = "no memory"; break; }
+            tinfl_init(inf);
+        }
+        mbedtls_sha256_init(&pipe.sha);
+        ota_sha256_starts(&pipe.sha);
+        if (xTaskCreatePinnedToCore(flash_task, "ota_flash", 4096, &pipe, 3, nullptr, 1) != pdPASS) {
+            error = "task";
+            break;
+        }
+        writer = true;
+
+        uint32_t remaining = h.body_size;
+        size_t in_len = 0, in_pos = 0, dict_ofs = 0;
+        for (;;) {
+            if (in_pos == in_len && remaining) {
+                const size_t n = remaining < sizeof(in) ? remaining : sizeof(in);
+                if (!read_exact(s, in, n, &st.net_ms)) { error = "read"; break; }
+                remaining -= (uint32_t)n;
+                st.net_bytes += (uint32_t)n;
+                in_len = n;
+                in_pos = 0;
+            }
+            if (!st.compressed) {
+                if (!emit(in, in_len)) { error = "write"; break; }
+                in_pos = in_len;
+                if (!remaining) break;
+                continue;
+            }
+            const uint32_t t0 = millis();
+            size_t in_bytes = in_len - in_pos;
+            size_t out_bytes = TINFL_LZ_DICT_SIZE - dict_ofs;
+            const int flags = TINFL_FLAG_PARSE_ZLIB_HEADER | (remaining ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+            const tinfl_status status = tinfl_decompress(inf, in + in_pos, &in_bytes, dict, dict + dict_ofs,
+                                                         &out_bytes, flags);
+            st.inflate_ms += millis() - t0;
+            in_pos += in_bytes;
+            if (!emit(dict + dict_ofs, out_bytes)) { error = "write"; break; }
+            dict_ofs = (dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+            if (status == TINFL_STATUS_DONE) break;
+            if (status < 0) { error = "inflate"; break; }
+            if (status == TINFL_STATUS_NEEDS_MORE_INPUT && !remaining && in_pos == in_len) { error = "truncated"; break; }
+        }
+        if (error) break;
+        if (cur.data && cur.len) { xQueueSend(pipe.full, &cur, portMAX_DELAY); cur.data = nullptr; }
+    } while (false);
+
+    // 書き込みタスクを終わらせる（失敗時も、渡したブロックを書き終えるのを待つ）
+    if (writer) {
+        OtaBlock end = {nullptr, 0};
+        xQueueSend(pipe.full, &end, portMAX_DELAY);
+        xSemaphoreTake(pipe.done, portMAX_DELAY);
+        st.flash_ms = pipe.flash_ms;
+        if (!error && pipe.err != ESP_OK) error = "flash write";
+    }
+    if (!error && st.raw_bytes != h.raw_size) error = "size";
+    if (!error) {
+        uint8_t digest[32];
+        ota_sha256_finish(&pipe.sha, digest);
+        if (memcmp(digest, h.sha256, sizeof(digest)) != 0) error = "sha256";
+    }
+    if (writer) mbedtls_sha256_free(&pipe.sha);
+    if (begun) {
+        // esp_ota_end は書いたイメージの形式とチェックサムも確かめる
+        if (!error && esp_ota_end(pipe.handle) != ESP_OK) error = "image verify";
+        else if (error) esp_ota_abort(pipe.handle);
+    }
+    if (!error && esp_ota_set_boot_partition(part) != ESP_OK) error = "set boot";
+
+    http.end();
+    for (int i = 0; i < OTA_UPDATE_BLOCKS; ++i) free(blocks[i].data);
+    free(inf);
+    free(dict);
+    if (pipe.full) vQueueDelete(pipe.full);
+    if (pipe.free) vQueueDelete(pipe.free);
+    if (pipe.done) vSemaphoreDelete(pipe.done);
+
+    st.total_ms = millis() - t_start;
+    st.error = error;
+    st.state = error ? OtaState::Failed : OtaState::Done;
+}
+
+void OtaUpdater::report(Print& out) {
+    const OtaStats s = _stats;
+    out.printf("[OTA] %s%s%s %s net=%luB raw=%lu/%luB (%.2fx) total=%lums net_wait=%lums inflate=%lums "
+               "flash=%lums writer_wait=%lums\n",
+               s.state == OtaState::Done ? "done" : s.state == OtaState::Failed ? "failed" : "running",
+               s.error ? ": " : "", s.error ? s.error : "", s.compressed ? "zlib" : "raw",
+               (unsigned long)s.net_bytes, (unsigned long)s.raw_bytes, (unsigned long)s.raw_total,
+               s.net_bytes ? (double)s.raw_bytes / s.net_bytes : 0.0, (unsigned long)s.total_ms,
+               (unsigned long)s.net_ms, (unsigned long)s.inflate_ms, (unsigned long)s.flash_ms,
+               (unsigned long)s.wait_ms);
+}
+
+void ota_mark_valid() {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+    if (running && esp_ota_get_state_partition(running, &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY) {
+        esp_ota_mark_app_valid_cancel_rollback();
+    }
+}
+#endif
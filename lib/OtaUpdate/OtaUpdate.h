@@ -0,0 +1,58 @@
+#pragma once
+
+// HTTP から OTA イメージを受けながら展開して、使っていない側の app スロット（A/B）へ書く。
+//   受信 + 展開（このタスク） ─ 4KB ブロック x OTA_UPDATE_BLOCKS ─> 書き込みタスク（消去 + 書き込み + SHA-256）
+// 書き込み側がセクタを消して書いている間に、受信側は次のブロックを読んで展開できる。
+// 展開は ESP32 の ROM にある miniz（tinfl）を使う（フラッシュを食わない。作業領域は 32KB 辞書 + 約 11KB）。
+// 全部書いたら SHA-256 とイメージの検証（esp_ota_end）を通ったときだけ起動先を切り替える。
+
+#include <stdint.h>
+#include <stddef.h>
+#include "OtaImage.h"
+
+// 書き込み待ちのブロック数（4KB ずつ）
+#ifndef OTA_UPDATE_BLOCKS
+#define OTA_UPDATE_BLOCKS 3
+#endif
+
+enum class OtaState : uint8_t { Idle, Running, Done, Failed };
+
+struct OtaStats {
+    OtaState    state;
+    const char* error;        // Failed のときの理由
+    bool        compressed;
+    uint32_t    net_bytes;    // 受信したバイト（ヘッダ込み）
+    uint32_t    raw_bytes;    // 書いたバイト
+    uint32_t    raw_total;
+    uint32_t    total_ms;
+    uint32_t    net_ms;       // 受信待ち
+    uint32_t    inflate_ms;   // 展開
+    uint32_t    wait_ms;      // 書き込み側が空くのを待った時間
+    uint32_t    flash_ms;     // 書き込みタスクの消去 + 書き込み時間
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class OtaUpdater {
+public:
+    // http:// の URL。すぐ戻り、進み具合は stats() で見る
+    bool start(const char* url);
+    bool busy() const { return _task != nullptr; }
+    OtaStats stats() const { return _stats; }
+    void report(Print& out);
+
+private:
+    static void task(void* arg);
+    void run();
+
+    char _url[160] = "";
+    volatile TaskHandle_t _task = nullptr;
+    OtaStats _stats = {};
+};
+
+// 新しいイメージで起動できたら呼ぶ（ロールバック有効時に、この版を正常として確定する）
+void ota_mark_valid();
+#endif
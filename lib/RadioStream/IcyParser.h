@@ -0,0 +1,90 @@
+#pragma once
+
+// ICY（SHOUTcast/Icecast）ストリームから音声とメタデータを分ける。
+// metaint バイトの音声ごとに「長さ(1B, x16) + メタデータ」が挟まる。metaint=0 なら素通し。
+// Arduino 非依存。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class IcyParser {
+public:
+    void reset(uint32_t metaint) {
+        _metaint = metaint;
+        _until_meta = metaint;
+        _meta_left = 0;
+        _meta_len = 0;
+        _in_len = false;
+    }
+
+    // in から音声だけを out（n バイト以上）に詰める。戻り値は音声のバイト数
+    size_t feed(const uint8_t* in, size_t n, uint8_t* out) {
+        if (_metaint == 0) {
+            if (out != in) memmove(out, in, n);
+            return n;
+        }
+        size_t o = 0;
+        for (size_t i = 0; i < n;) {
+            if (_in_len) {
+                _meta_left = (uint16_t)in[i++] * 16;
+                _meta_len = 0;
+                _in_len = false;
+                if (_meta_left == 0) _until_meta = _metaint;
+            } else if (_meta_left > 0) {
+                size_t k = n - i < _meta_left ? n - i : _meta_left;
+                for (size_t j = 0; j < k; ++j) {
+                    if (_meta_len < sizeof(_meta) - 1) _meta[_meta_len++] = (char)in[i + j];
+                }
+                i += k;
+                _meta_left -= (uint16_t)k;
+                if (_meta_left == 0) {
+                    _meta[_meta_len] = '\0';
+                    parse_meta();
+                    _until_meta = _metaint;
+                }
+            } else {
+                size_t k = n - i < _until_meta ? n - i : _until_meta;
+                memmove(out + o, in + i, k);
+                o += k;
+                i += k;
+                _until_meta -= (uint32_t)k;
+                if (_until_meta == 0) _in_len = true;
+            }
+        }
+        return o;
+    }
+
+    // 曲名が変わったら true（読むとリセット）
+    bool title_changed() {
+        bool c = _title_changed;
+        _title_changed = false;
+        return c;
+    }
+    const char* title() const { return _title; }
+
+private:
+    // StreamTitle='...'; を取り出す
+    void parse_meta() {
+        const char* p = strstr(_meta, "StreamTitle='");
+        if (!p) return;
+        p += 13;
+        const char* e = strstr(p, "';");
+        if (!e) e = p + strlen(p);
+        size_t n = (size_t)(e - p);
+        if (n >= sizeof(_title)) n = sizeof(_title) - 1;
+        if (strncmp(_title, p, n) == 0 && _title[n] == '\0') return;
+        memcpy(_title, p, n);
+        _title[n] = '\0';
+        _title_changed = true;
+    }
+
+    uint32_t _metaint = 0;
+    uint32_t _until_meta = 0;
+    uint16_t _meta_left = 0;
+    uint16_t _meta_len = 0;
+    bool _in_len = false;
+    char _meta[256] = "";
+    char _title[96] = "";
+    bool _title_changed = false;
+};
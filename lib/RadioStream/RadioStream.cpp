@@ -0,0 +1,379 @@
+#ifdef ARDUINO
+#include "RadioStream.h"
+#include <WiFi.h>
+#include "AudioTools/AudioCodecs/CodecMP3Helix.h"
+#include "AudioTools/AudioCodecs/CodecAACHelix.h"
+
+// デコードタスクが一度に取り出す量
+#define RADIO_CHUNK 1024
+
+// _done のビット。タスクが抜ける直前に立てる
+#define RADIO_NET_DONE (1u << 0)
+#define RADIO_DEC_DONE (1u << 1)
+#define RADIO_TASKS_DONE (RADIO_NET_DONE | RADIO_DEC_DONE)
+
+// デコーダの出力を I2S へ。I2S 待ちの時間はデコード時間から除く
+class RadioSink : public audio_tools::AudioOutput {
+public:
+    explicit RadioSink(RadioPlayer& p) : _p(p) {}
+    size_t write(const uint8_t* data, size_t len) override {
+        const uint32_t t0 = micros();
+        i2s_out_write16(*_p._i2s, reinterpret_cast<const int16_t*>(data), len / sizeof(int16_t),
+                        _channels, _buf);
+        const uint32_t dt = micros() - t0;
+        spent_us += dt;
+        if (dt > _p._stats.i2s_us_max) _p._stats.i2s_us_max = dt;
+        return len;
+    }
+    void setAudioInfo(audio_tools::AudioInfo info) override {
+        audio_tools::AudioOutput::setAudioInfo(info);
+        _channels = info.channels == 1 ? 1 : 2;
+        _p.on_audio_info(info.sample_rate, _channels);
+    }
+    uint32_t spent_us = 0;
+
+private:
+    RadioPlayer& _p;
+    uint8_t _channels = 2;
+    std::vector<int32_t> _buf;
+};
+
+// "http://host[:port]/path" を分解する
+static bool parse_url(const char* url, char* host, size_t host_len, uint16_t* port, const char** path) {
+    if (strncmp(url, "http://", 7) != 0) return false;
+    const char* h = url + 7;
+    const char* p = strchr(h, '/');
+    if (!p) p = h + strlen(h);
+    const char* colon = (const char*)memchr(h, ':', (size_t)(p - h));
+    const char* he = colon ? colon : p;
+    if (he == h || (size_t)(he - h) >= host_len) return false;
+    memcpy(host, h, (size_t)(he - h));
+    host[he - h] = '\0';
+    *port = colon ? (uint16_t)atoi(colon + 1) : 80;
+    *path = *p ? p : "/";
+    return *port != 0;
+}
+
+// 1行（CRLF を除く）を読む。タイムアウトや切断、停止の指示で false
+static bool read_line(WiFiClient& c, char* buf, size_t len, uint32_t timeout_ms, const volatile bool& run) {
+    size_t n = 0;
+    const uint32_t t0 = millis();
+    while (run && millis() - t0 < timeout_ms) {
+        if (!c.available()) {
+            if (!c.connected()) return false;
+            vTaskDelay(pdMS_TO_TICKS(5));
+            continue;
+        }
+        const int ch = c.read();
+        if (ch < 0) continue;
+        if (ch == '\n') {
+            if (n && buf[n - 1] == '\r') --n;
+            buf[n] = '\0';
+            return true;
+        }
+        if (n < len - 1) buf[n++] = (char)ch;
+    }
+    return false;
+}
+
+// GET してヘッダを読み終えたところで返す。リダイレクトは3回まで追う
+static bool open_stream(WiFiClient& c, const char* url, uint32_t* metaint, RadioCodec* codec,
+                        const volatile bool& run) {
+    char target[RADIO_URL_MAX];
+    strncpy(target, url, sizeof(target) - 1);
+    target[sizeof(target) - 1] = '\0';
+    for (int hop = 0; hop < 4; ++hop) {
+        char host[64];
+        uint16_t port;
+        const char* path;
+        if (!parse_url(target, host, sizeof(host), &port, &path)) {
+            Serial.printf("[RADIO] unsupported url: %s\n", target);
+            return false;
+        }
+        if (!c.connect(host, port)) return false;
+        // 80 以外は Host にポートも付ける（サーバが Location を Host から組み立てる場合がある）
+        char host_hdr[72];
+        if (port == 80) snprintf(host_hdr, sizeof(host_hdr), "%s", host);
+        else snprintf(host_hdr, sizeof(host_hdr), "%s:%u", host, (unsigned)port);
+        c.printf("GET %s HTTP/1.0\r\nHost: %s\r\nIcy-MetaData: 1\r\nUser-Agent: JC2432W328C\r\n"
+                 "Connection: close\r\n\r\n", path, host_hdr);
+
+        char line[RADIO_URL_MAX + 16];
+        if (!read_line(c, line, sizeof(line), 5000, run)) { c.stop(); return false; }
+        // "HTTP/1.x 200 OK" / "ICY 200 OK"
+        const char* sp = strchr(line, ' ');
+        const int status = sp ? atoi(sp + 1) : 0;
+        char location[RADIO_URL_MAX] = "";
+        *metaint = 0;
+        *codec = RadioCodec::Unknown;
+        while (read_line(c, line, sizeof(line), 5000, run)) {
+            if (!line[0]) break;
+            char* colon = strchr(line, ':');
+            if (!colon) continue;
+            *colon = '\0';
+            const char* v = colon + 1;
+            while (*v == ' ') ++v;
+            if (!strcasecmp(line, "icy-metaint")) *metaint = (uint32_t)atol(v);
+            else if (!strcasecmp(line, "content-type")) *codec = radio_codec_from_type(v);
+            else if (!strcasecmp(line, "location")) {
+                strncpy(location, v, sizeof(location) - 1);
+                location[sizeof(location) - 1] = '\0';
+            }
+        }
+        if (!run) { c.stop(); return false; }
+        if (status >= 300 && status < 400 && location[0]) {
+            c.stop();
+            strncpy(target, location, sizeof(target) - 1);
+            continue;
+        }
+        if (status != 200) {
+            Serial.printf("[RADIO] http status %d\n", status);
+            c.stop();
+            return false;
+        }
+        return true;
+    }
+    c.stop();
+    return false;
+}
+
+bool RadioPlayer::begin(audio_tools::I2SStream& i2s, size_t buffer_bytes) {
+    _i2s = &i2s;
+    if (!_sb) {
+        _sb = xStreamBufferCreate(buffer_bytes, 1);
+        _sb_size = buffer_bytes;
+    }
+    if (!_done) {
+        _done = xEventGroupCreate();
+        if (_done) xEventGroupSetBits(_done, RADIO_TASKS_DONE);
+    }
+    return _sb != nullptr && _done != nullptr;
+}
+
+bool RadioPlayer::stopping() const {
+    return _done && (xEventGroupGetBits(_done) & RADIO_TASKS_DONE) != RADIO_TASKS_DONE;
+}
+
+bool RadioPlayer::play(const char* url, uint32_t wait_ms) {
+    if (!_sb || !_i2s || !_done) return false;
+    stop();
+    // 前の受信タスクが StreamBuffer に書いている間は始めない（書き手は1つだけ）。
+    // 接続やヘッダ待ちの途中だと抜けるまで数秒かかることがある
+    const EventBits_t bits = xEventGroupWaitBits(_done, RADIO_TASKS_DONE, pdFALSE, pdTRUE, pdMS_TO_TICKS(wait_ms));
+    if ((bits & RADIO_TASKS_DONE) != RADIO_TASKS_DONE) return false;
+    strncpy(_url, url, sizeof(_url) - 1);
+    _url[sizeof(_url) - 1] = '\0';
+    xStreamBufferReset(_sb);
+    portENTER_CRITICAL(&_mux);
+    _stats = {};
+    _stats.buf_size = _sb_size;
+    _stats.buf_min = _sb_size;
+    _decode_sum = 0;
+    _decode_n = 0;
+    _title[0] = '\0';
+    _title_new = false;
+    portEXIT_CRITICAL(&_mux);
+    xEventGroupClearBits(_done, RADIO_TASKS_DONE);
+    _run = true;
+    // 受信は WiFi と同じ core 0、デコードは UI と同じ core 1（I2S の書き込み待ちで寝る時間が長い）
+    const bool net_ok = xTaskCreatePinnedToCore(net_task, "radio_net", 4096, this, 3, nullptr, 0) == pdPASS;
+    if (!net_ok) xEventGroupSetBits(_done, RADIO_NET_DONE);
+    if (!net_ok || xTaskCreatePinnedToCore(decode_task, "radio_dec", 12288, this, 3, nullptr, 1) != pdPASS) {
+        xEventGroupSetBits(_done, RADIO_DEC_DONE);
+        stop();
+        return false;
+    }
+    return true;
+}
+
+bool RadioPlayer::title(char* buf, size_t len) {
+    bool changed = false;
+    portENTER_CRITICAL(&_mux);
+    if (_title_new) {
+        strncpy(buf, _title, len - 1);
+        buf[len - 1] = '\0';
+        _title_new = false;
+        changed = true;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return changed;
+}
+
+RadioStats RadioPlayer::stats() {
+    portENTER_CRITICAL(&_mux);
+    RadioStats s = _stats;
+    s.decode_us_avg = _decode_n ? (uint32_t)(_decode_sum / _decode_n) : 0;
+    portEXIT_CRITICAL(&_mux);
+    s.buf_level = _sb ? (uint32_t)xStreamBufferBytesAvailable(_sb) : 0;
+    return s;
+}
+
+void RadioPlayer::report(Print& out) {
+    RadioStats s = stats();
+    const uint32_t size = s.buf_size ? s.buf_size : 1;
+    out.printf("[RADIO] %s %s %luHz/%uch net=%luKB reconn=%lu underrun=%lu buf=%lu%% min=%lu%% "
+               "dec_avg=%luus dec_max=%luus i2s_max=%luus\n",
+               s.connected ? (s.playing ? "play" : "buffering") : "offline", radio_codec_name(s.codec),
+               (unsigned long)s.sample_rate, (unsigned)s.channels, (unsigned long)(s.net_bytes / 1024),
+               (unsigned long)s.reconnects, (unsigned long)s.underruns,
+               (unsigned long)(s.buf_level * 100 / size), (unsigned long)(s.buf_min * 100 / size),
+               (unsigned long)s.decode_us_avg, (unsigned long)s.decode_us_max, (unsigned long)s.i2s_us_max);
+    portENTER_CRITICAL(&_mux);
+    _stats.buf_min = s.buf_level;
+    _stats.decode_us_max = 0;
+    _stats.i2s_us_max = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void RadioPlayer::on_audio_info(uint32_t rate, uint8_t channels) {
+    if (rate && rate != _stats.sample_rate) {
+        _i2s->end();
+        i2s_out_begin(*_i2s, (int)rate);
+    }
+    portENTER_CRITICAL(&_mux);
+    _stats.sample_rate = rate;
+    _stats.channels = channels;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void RadioPlayer::net_task(void* arg) {
+    RadioPlayer* self = static_cast<RadioPlayer*>(arg);
+    self->net_loop();
+    xEventGroupSetBits(self->_done, RADIO_NET_DONE);
+    vTaskDelete(nullptr);
+}
+
+void RadioPlayer::decode_task(void* arg) {
+    RadioPlayer* self = static_cast<RadioPlayer*>(arg);
+    self->decode_loop();
+    xEventGroupSetBits(self->_done, RADIO_DEC_DONE);
+    vTaskDelete(nullptr);
+}
+
+void RadioPlayer::net_loop() {
+    static uint8_t buf[1460];
+    uint32_t backoff = 500;
+    bool first = true;
+    while (_run) {
+        if (!first) {
+            // 再接続まで待つ（その間もデコード側はバッファで鳴り続ける）
+            for (uint32_t t = 0; _run && t < backoff; t += 50) vTaskDelay(pdMS_TO_TICKS(50));
+            backoff = backoff < 8000 ? backoff * 2 : 8000;
+            if (!_run) break;
+            portENTER_CRITICAL(&_mux);
+            ++_stats.reconnects;
+            portEXIT_CRITICAL(&_mux);
+        }
+        first = false;
+
+        WiFiClient c;
+        uint32_t metaint = 0;
+        RadioCodec codec = RadioCodec::Unknown;
+        if (WiFi.status() != WL_CONNECTED || !open_stream(c, _url, &metaint, &codec, _run)) continue;
+        if (codec == RadioCodec::Unknown) codec = RadioCodec::Mp3;
+        _icy.reset(metaint);
+        portENTER_CRITICAL(&_mux);
+        _stats.codec = codec;
+        _stats.connected = true;
+        portEXIT_CRITICAL(&_mux);
+
+        uint32_t last_rx = millis();
+        while (_run && (c.connected() || c.available())) {
+            const int avail = c.available();
+            if (avail <= 0) {
+                if (millis() - last_rx > RADIO_STALL_MS) break;
+                vTaskDelay(pdMS_TO_TICKS(5));
+                continue;
+            }
+            const int n = c.read(buf, (size_t)avail < sizeof(buf) ? (size_t)avail : sizeof(buf));
+            if (n <= 0) continue;
+            backoff = 500;
+            const size_t m = _icy.feed(buf, (size_t)n, buf);
+            if (_icy.title_changed()) {
+                portENTER_CRITICAL(&_mux);
+                strncpy(_title, _icy.title(), sizeof(_title) - 1);
+                _title[sizeof(_title) - 1] = '\0';
+                _title_new = true;
+                portEXIT_CRITICAL(&_mux);
+            }
+            portENTER_CRITICAL(&_mux);
+            _stats.net_bytes += m;
+            portEXIT_CRITICAL(&_mux);
+            // バッファが一杯ならここで待つ（TCP のウィンドウで送信側も止まる）
+            size_t off = 0;
+            while (_run && off < m) off += xStreamBufferSend(_sb, buf + off, m - off, pdMS_TO_TICKS(100));
+            last_rx = millis();
+        }
+        c.stop();
+        portENTER_CRITICAL(&_mux);
+        _stats.connected = false;
+        portEXIT_CRITICAL(&_mux);
+    }
+}
+
+void RadioPlayer::decode_loop() {
+    static uint8_t chunk[RADIO_CHUNK];
+    RadioSink sink(*this);
+    audio_tools::AudioDecoder* decoder = nullptr;
+    audio_tools::EncodedAudioStream* dec = nullptr;
+    RadioCodec cur = RadioCodec::Unknown;
+    const size_t prebuffer = _sb_size * RADIO_PREBUFFER_PCT / 100;
+    bool buffering = true;
+
+    while (_run) {
+        if (buffering) {
+            if (xStreamBufferBytesAvailable(_sb) < prebuffer) {
+                vTaskDelay(pdMS_TO_TICKS(20));
+                continue;
+            }
+            buffering = false;
+            // コーデックは接続ごとに Content-Type で決まる。変わったときだけ作り直す
+            const RadioCodec codec = _stats.codec;
+            if (!dec || codec != cur) {
+                if (dec) { dec->end(); delete dec; }
+                delete decoder;
+                if (codec == RadioCodec::Aac) decoder = new audio_tools::AACDecoderHelix();
+                else decoder = new audio_tools::MP3DecoderHelix();
+                dec = new audio_tools::EncodedAudioStream(&sink, decoder);
+                dec->begin();
+                cur = codec;
+            }
+            portENTER_CRITICAL(&_mux);
+            _stats.playing = true;
+            portEXIT_CRITICAL(&_mux);
+        }
+
+        const size_t n = xStreamBufferReceive(_sb, chunk, sizeof(chunk), pdMS_TO_TICKS(100));
+        if (n == 0) {
+            // 空になった: 溜まるまで止める
+            buffering = true;
+            portENTER_CRITICAL(&_mux);
+            ++_stats.underruns;
+            _stats.playing = false;
+            _stats.buf_min = 0;
+            portEXIT_CRITICAL(&_mux);
+            continue;
+        }
+        const uint32_t level = (uint32_t)xStreamBufferBytesAvailable(_sb);
+
+        sink.spent_us = 0;
+        const uint32_t t0 = micros();
+        dec->write(chunk, n);
+        const uint32_t total = micros() - t0;
+        const uint32_t decode_us = total > sink.spent_us ? total - sink.spent_us : 0;
+
+        portENTER_CRITICAL(&_mux);
+        if (level < _stats.buf_min) _stats.buf_min = level;
+        if (decode_us > _stats.decode_us_max) _stats.decode_us_max = decode_us;
+        _decode_sum += decode_us;
+        ++_decode_n;
+        portEXIT_CRITICAL(&_mux);
+    }
+
+    if (dec) { dec->end(); delete dec; }
+    delete decoder;
+    portENTER_CRITICAL(&_mux);
+    _stats.playing = false;
+    portEXIT_CRITICAL(&_mux);
+}
+#endif
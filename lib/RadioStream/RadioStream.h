@@ -0,0 +1,111 @@
+#pragma once
+
+// HTTP/ICY ネットラジオ再生。
+// 受信（core 0）→ ジッタバッファ（StreamBuffer）→ デコード（core 1）→ I2S DMA の3段で動かし、
+// WiFi が数秒止まってもバッファが尽きるまでは音を切らさない。
+// 出力は I2sOut（a2dp と同じ PCM5102A 設定）。MP3/AAC は Content-Type で選ぶ。
+// ホストでの試験は tools/radio_server.py（帯域制限・途切れの再現つき）を使う。
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ジッタバッファ [KB]（128kbps の MP3 で 32KB ≒ 2秒）
+#ifndef RADIO_BUFFER_KB
+#define RADIO_BUFFER_KB 32
+#endif
+// この割合まで溜まってから再生を始める（アンダーラン後も同じ）
+#ifndef RADIO_PREBUFFER_PCT
+#define RADIO_PREBUFFER_PCT 50
+#endif
+// 受信が止まってから再接続するまで [ms]
+#ifndef RADIO_STALL_MS
+#define RADIO_STALL_MS 5000
+#endif
+#ifndef RADIO_URL_MAX
+#define RADIO_URL_MAX 160
+#endif
+
+enum class RadioCodec : uint8_t { Unknown, Mp3, Aac };
+
+inline RadioCodec radio_codec_from_type(const char* content_type) {
+    if (strstr(content_type, "audio/aac") || strstr(content_type, "audio/aacp") ||
+        strstr(content_type, "audio/mp4")) return RadioCodec::Aac;
+    if (strstr(content_type, "audio/mpeg") || strstr(content_type, "audio/mp3")) return RadioCodec::Mp3;
+    return RadioCodec::Unknown;
+}
+
+inline const char* radio_codec_name(RadioCodec c) {
+    return c == RadioCodec::Mp3 ? "mp3" : c == RadioCodec::Aac ? "aac" : "-";
+}
+
+struct RadioStats {
+    uint64_t   net_bytes;       // 受信した音声バイト（ICY メタデータを除く）
+    uint32_t   reconnects;
+    uint32_t   underruns;       // バッファが空になって再プリバッファした回数
+    uint32_t   buf_level;       // 現在のバッファ量 [bytes]
+    uint32_t   buf_min;         // 再生中の最小バッファ量（前回の report 以降）
+    uint32_t   buf_size;
+    uint32_t   decode_us_avg;   // 1チャンク（RADIO_CHUNK）のデコード時間。I2S 待ちは除く
+    uint32_t   decode_us_max;
+    uint32_t   i2s_us_max;      // I2S への書き込み待ちの最大
+    uint32_t   sample_rate;
+    uint8_t    channels;
+    RadioCodec codec;
+    bool       connected;
+    bool       playing;         // プリバッファ中は false
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/stream_buffer.h>
+#include <freertos/task.h>
+#include "I2sOut.h"
+#include "IcyParser.h"
+
+class RadioSink;
+
+class RadioPlayer {
+public:
+    // バッファは begin() で一度だけ確保する
+    bool begin(audio_tools::I2SStream& i2s, size_t buffer_bytes = RADIO_BUFFER_KB * 1024);
+    // http:// のみ（https は未対応）。再生中なら止め、前のタスクが抜けるのを wait_ms まで待ってから始める。
+    // 待ち切れなければ false（stopping() の間は UI から呼んでも始まらない）
+    bool play(const char* url, uint32_t wait_ms = 0);
+    // 止めるよう指示するだけで待たない（LVGL のコールバックから呼べる）
+    void stop() { _run = false; }
+    bool active() const { return _run; }
+    // stop() 後、受信・デコードのタスクがまだ抜けていない
+    bool stopping() const;
+
+    // 曲名（ICY StreamTitle）が変わったら true を返して buf にコピーする
+    bool title(char* buf, size_t len);
+    RadioStats stats();
+    // 統計を1行出し、buf_min / *_max をリセットする
+    void report(Print& out);
+
+private:
+    friend class RadioSink;
+    static void net_task(void* arg);
+    static void decode_task(void* arg);
+    void net_loop();
+    void decode_loop();
+    void on_audio_info(uint32_t rate, uint8_t channels);
+
+    audio_tools::I2SStream* _i2s = nullptr;
+    StreamBufferHandle_t _sb = nullptr;
+    size_t _sb_size = 0;
+    EventGroupHandle_t _done = nullptr;   // 抜けたタスクのビット（両方立っていれば停止済み）
+    volatile bool _run = false;
+    char _url[RADIO_URL_MAX] = "";
+    IcyParser _icy;
+    char _title[96] = "";
+    bool _title_new = false;
+    uint64_t _decode_sum = 0;
+    uint32_t _decode_n = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    RadioStats _stats = {};
+};
+#endif
@@ -0,0 +1,181 @@
+#include <SD.h>
+#include <esp_heap_caps.h>
+#include <vector>
+#include "SdBench.h"
+
+namespace {
+
+constexpr uint8_t kBuckets = 12;  // <128us, <256us, ... , <128ms, それ以上
+
+enum class Op : uint8_t { SeqWrite, SeqRead, RandRead, RandWrite };
+const char* const kOpNames[] = {"seq_write", "seq_read", "rand_read", "rand_write"};
+
+struct Row {
+    uint32_t clock_hz;
+    uint32_t size;
+    Op       op;
+    uint32_t bytes;
+    uint32_t total_us;
+    uint32_t ops;
+    uint32_t min_us, max_us;
+    uint64_t sum_us;
+    uint32_t hist[kBuckets];
+    bool     ok;
+};
+
+void add_sample(Row& r, uint32_t us) {
+    r.ops++;
+    r.sum_us += us;
+    if (us < r.min_us) r.min_us = us;
+    if (us > r.max_us) r.max_us = us;
+    uint8_t b = 0;
+    while (b < kBuckets - 1 && us >= (128UL << b)) ++b;
+    r.hist[b]++;
+}
+
+uint32_t percentile_us(const Row& r, uint8_t pct) {
+    uint32_t target = (r.ops * pct + 99) / 100, acc = 0;
+    for (uint8_t i = 0; i < kBuckets; ++i) {
+        acc += r.hist[i];
+        if (acc >= target) return i < kBuckets - 1 ? (128UL << i) : r.max_us;
+    }
+    return 0;
+}
+
+void print_header(Print& out) {
+    out.print("clock_hz,size,op,bytes,total_ms,kbps,ops,lat_min_us,lat_avg_us,lat_p50_us,lat_p99_us,lat_max_us");
+    for (uint8_t i = 0; i < kBuckets; ++i) out.printf(",h%u", (unsigned)i);
+    out.println();
+}
+
+void print_row(Print& out, const Row& r) {
+    if (!r.ok) {
+        out.printf("%u,%u,%s,0,0,0,0,0,0,0,0,0", (unsigned)r.clock_hz, (unsigned)r.size, kOpNames[(int)r.op]);
+        for (uint8_t i = 0; i < kBuckets; ++i) out.print(",0");
+        out.println();
+        return;
+    }
+    uint32_t kbps = r.total_us ? (uint32_t)((uint64_t)r.bytes * 1000000ULL / r.total_us / 1024) : 0;
+    out.printf("%u,%u,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u",
+               (unsigned)r.clock_hz, (unsigned)r.size, kOpNames[(int)r.op],
+               (unsigned)r.bytes, (unsigned)(r.total_us / 1000), (unsigned)kbps, (unsigned)r.ops,
+               (unsigned)r.min_us, (unsigned)(r.ops ? r.sum_us / r.ops : 0),
+               (unsigned)percentile_us(r, 50), (unsigned)percentile_us(r, 99), (unsigned)r.max_us);
+    for (uint8_t i = 0; i < kBuckets; ++i) out.printf(",%u", (unsigned)r.hist[i]);
+    out.println();
+}
+
+Row make_row(uint32_t clock_hz, uint32_t size, Op op) {
+    Row r = {};
+    r.clock_hz = clock_hz;
+    r.size = size;
+    r.op = op;
+    r.min_us = UINT32_MAX;
+    return r;
+}
+
+void run_sequential(Row& r, const SdBenchConfig& cfg, uint8_t* buf) {
+    const bool write = r.op == Op::SeqWrite;
+    File f = SD.open(cfg.data_path, write ? FILE_WRITE : FILE_READ);
+    if (!f) return;
+    uint32_t start = micros();
+    for (uint32_t done = 0; done < cfg.file_bytes; done += r.size) {
+        uint32_t t0 = micros();
+        size_t n = write ? f.write(buf, r.size) : f.read(buf, r.size);
+        add_sample(r, micros() - t0);
+        if (n != r.size) { f.close(); return; }
+        r.bytes += n;
+    }
+    if (write) f.flush();
+    f.close();
+    r.total_us = micros() - start;
+    r.ok = true;
+}
+
+void run_random(Row& r, const SdBenchConfig& cfg, uint8_t* buf) {
+    const bool write = r.op == Op::RandWrite;
+    File f = SD.open(cfg.data_path, write ? "r+" : FILE_READ);
+    if (!f) return;
+    const uint32_t slots = cfg.file_bytes / r.size;
+    uint32_t seed = 0x2545F491u ^ r.size;
+    uint32_t start = micros();
+    for (uint16_t i = 0; i < cfg.random_ops; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t t0 = micros();
+        f.seek((seed >> 8) % slots * r.size);
+        size_t n = write ? f.write(buf, r.size) : f.read(buf, r.size);
+        add_sample(r, micros() - t0);
+        if (n != r.size) { f.close(); return; }
+        r.bytes += n;
+    }
+    if (write) f.flush();
+    f.close();
+    r.total_us = micros() - start;
+    r.ok = true;
+}
+
+}  // namespace
+
+SdBenchConfig sd_bench_default_config(uint8_t cs, uint32_t restore_hz) {
+    static const uint32_t clocks[] = {10000000, 20000000, 40000000};
+    static const uint32_t sizes[] = {512, 1024, 2048, 4096, 8192, 16384, 32768};
+    SdBenchConfig cfg;
+    cfg.cs = cs;
+    cfg.clocks = clocks;
+    cfg.n_clocks = sizeof(clocks) / sizeof(clocks[0]);
+    cfg.sizes = sizes;
+    cfg.n_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    cfg.file_bytes = SD_BENCH_FILE_KB * 1024UL;
+    cfg.random_ops = 64;
+    cfg.restore_hz = restore_hz;
+    cfg.data_path = "/sdbench.bin";
+    cfg.csv_path = "/sdbench.csv";
+    return cfg;
+}
+
+bool sd_bench_run(SPIClass& spi, const SdBenchConfig& cfg, Print& out) {
+    // 最大サイズのバッファが取れなければ半分ずつ諦める（取れない大きさの行は出さない）
+    uint32_t max_size = 0;
+    for (uint8_t i = 0; i < cfg.n_sizes; ++i) max_size = max(max_size, cfg.sizes[i]);
+    uint8_t* buf = nullptr;
+    while (max_size >= 512 && !(buf = (uint8_t*)heap_caps_malloc(max_size, MALLOC_CAP_DMA))) max_size /= 2;
+    if (!buf) {
+        out.println("[SDBENCH] no buffer");
+        return false;
+    }
+    for (uint32_t i = 0; i < max_size; ++i) buf[i] = (uint8_t)(i * 31 + 7);
+
+    std::vector<Row> rows;
+    rows.reserve(cfg.n_clocks * cfg.n_sizes * 4);
+    out.println("# sdbench begin");
+    print_header(out);
+    for (uint8_t c = 0; c < cfg.n_clocks; ++c) {
+        SD.end();
+        bool mounted = SD.begin(cfg.cs, spi, cfg.clocks[c]);
+        for (uint8_t s = 0; s < cfg.n_sizes; ++s) {
+            if (cfg.sizes[s] > max_size) continue;
+            for (uint8_t o = 0; o < 4; ++o) {
+                Row r = make_row(cfg.clocks[c], cfg.sizes[s], (Op)o);
+                if (mounted) {
+                    if (r.op == Op::SeqWrite || r.op == Op::SeqRead) run_sequential(r, cfg, buf);
+                    else run_random(r, cfg, buf);
+                }
+                print_row(out, r);
+                rows.push_back(r);
+            }
+        }
+    }
+    out.println("# sdbench end");
+    heap_caps_free(buf);
+
+    SD.end();
+    if (!SD.begin(cfg.cs, spi, cfg.restore_hz)) return false;
+    SD.remove(cfg.data_path);
+    File csv = SD.open(cfg.csv_path, FILE_WRITE);
+    if (csv) {
+        print_header(csv);
+        for (const Row& r : rows) print_row(csv, r);
+        csv.close();
+    }
+    return true;
+}
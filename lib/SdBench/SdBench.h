@@ -0,0 +1,35 @@
+#pragma once
+
+// SDカードのスループット/レイテンシ計測。
+// SPIクロック x バッファサイズ毎に、順次書き込み/順次読み出し/ランダム読み出し/ランダム書き込みを行い、
+// 1操作毎のレイテンシを log2 ヒストグラムにして CSV でシリアルとカード（csv_path）へ出力する。
+// 計測中は SD を何度もマウントし直すので、終わったら restore_hz で再マウントして戻る。
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#ifndef SD_BENCH_ENABLE
+#define SD_BENCH_ENABLE 0
+#endif
+#ifndef SD_BENCH_FILE_KB
+#define SD_BENCH_FILE_KB 512
+#endif
+
+struct SdBenchConfig {
+    uint8_t         cs;
+    const uint32_t* clocks;       // SPIクロック [Hz]
+    uint8_t         n_clocks;
+    const uint32_t* sizes;        // 1操作のバイト数
+    uint8_t         n_sizes;
+    uint32_t        file_bytes;   // 順次アクセスで読み書きする総量
+    uint16_t        random_ops;   // ランダムアクセスの回数
+    uint32_t        restore_hz;   // 終了後に再マウントするクロック
+    const char*     data_path;
+    const char*     csv_path;
+};
+
+// 既定: 10/20/40MHz x 512B..32KB
+SdBenchConfig sd_bench_default_config(uint8_t cs, uint32_t restore_hz);
+
+// 戻り値: restore_hz での再マウントに成功したか
+bool sd_bench_run(SPIClass& spi, const SdBenchConfig& cfg, Print& out);
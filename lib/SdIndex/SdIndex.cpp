@@ -0,0 +1,329 @@
+#include "SdIndex.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp32/rom/crc.h>
+
+namespace {
+
+const char* base_name(const char* name) {
+    const char* s = strrchr(name, '/');
+    return s ? s + 1 : name;
+}
+
+// 索引自身と一時ファイルは数えない
+bool skip_name(const char* name) {
+    return strncmp(name, ".sdindex", 8) == 0;
+}
+
+uint32_t entry_crc(uint32_t crc, const SdIndexEntry& e, const char* name) {
+    const uint32_t meta[3] = {e.size, e.mtime, e.flags};
+    crc = crc32_le(crc, reinterpret_cast<const uint8_t*>(meta), sizeof(meta));
+    return crc32_le(crc, reinterpret_cast<const uint8_t*>(name), e.name_len);
+}
+
+void tmp_path(char* out, size_t len, const char* path, char suffix) {
+    snprintf(out, len, "%s.%c", path, suffix);
+}
+
+bool copy_all(File& src, File& dst) {
+    uint8_t buf[512];
+    for (;;) {
+        size_t n = src.read(buf, sizeof(buf));
+        if (n == 0) return true;
+        if (dst.write(buf, n) != n) return false;
+    }
+}
+
+bool copy_n(File& src, File& dst, uint32_t len) {
+    uint8_t buf[512];
+    while (len) {
+        size_t n = src.read(buf, len < sizeof(buf) ? len : sizeof(buf));
+        if (n == 0 || dst.write(buf, n) != n) return false;
+        len -= n;
+    }
+    return true;
+}
+
+void make_header(SdIndexHeader* h, uint32_t count, uint32_t pool, uint32_t mtime, uint32_t crc) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, SD_INDEX_MAGIC, 4);
+    h->version = SD_INDEX_VERSION;
+    h->entry_size = sizeof(SdIndexEntry);
+    h->count = count;
+    h->pool_bytes = pool;
+    h->dir_mtime = mtime;
+    h->content_crc = crc;
+}
+
+uint32_t dir_mtime(fs::FS& fs, const char* dir) {
+    File d = fs.open(dir);
+    uint32_t t = d ? (uint32_t)d.getLastWrite() : 0;
+    if (d) d.close();
+    return t;
+}
+
+}  // namespace
+
+bool SdIndex::open(fs::FS& fs, const char* dir, const char* path) {
+    _fs = &fs;
+    strncpy(_dir, dir, sizeof(_dir) - 1);
+    strncpy(_path, path, sizeof(_path) - 1);
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    _valid = load_header();
+    if (!_valid) memset(&_hdr, 0, sizeof(_hdr));
+    return _valid;
+}
+
+bool SdIndex::load_header() {
+    File f = _fs->open(_path, FILE_READ);
+    if (!f) return false;
+    SdIndexHeader h;
+    bool ok = f.read(reinterpret_cast<uint8_t*>(&h), sizeof(h)) == sizeof(h) &&
+              memcmp(h.magic, SD_INDEX_MAGIC, 4) == 0 &&
+              h.version == SD_INDEX_VERSION &&
+              h.entry_size == sizeof(SdIndexEntry) &&
+              f.size() == sizeof(h) + (size_t)h.count * sizeof(SdIndexEntry) + h.pool_bytes;
+    f.close();
+    if (ok) _hdr = h;
+    return ok;
+}
+
+uint32_t SdIndex::page(uint32_t start, SdIndexItem* out, uint32_t n) {
+    if (!_valid || start >= _hdr.count) return 0;
+    if (n > _hdr.count - start) n = _hdr.count - start;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    File f = _fs->open(_path, FILE_READ);
+    uint32_t got = 0;
+    if (f) {
+        const uint32_t pool_base = sizeof(SdIndexHeader) + _hdr.count * sizeof(SdIndexEntry);
+        for (; got < n; ++got) {
+            SdIndexEntry e;
+            if (!f.seek(sizeof(SdIndexHeader) + (start + got) * sizeof(SdIndexEntry)) ||
+                f.read(reinterpret_cast<uint8_t*>(&e), sizeof(e)) != sizeof(e)) break;
+            SdIndexItem& it = out[got];
+            size_t len = e.name_len < SD_INDEX_NAME_MAX - 1 ? e.name_len : SD_INDEX_NAME_MAX - 1;
+            if (!f.seek(pool_base + e.name_off) ||
+                f.read(reinterpret_cast<uint8_t*>(it.name), len) != len) break;
+            it.name[len] = '\0';
+            it.size = e.size;
+            it.mtime = e.mtime;
+            it.dir = (e.flags & 1) != 0;
+        }
+        f.close();
+    }
+    xSemaphoreGive(_lock);
+    return got;
+}
+
+bool SdIndex::start_scan() {
+#if SD_INDEX_TRUST_DIR_MTIME
+    // ディレクトリの更新日時が取れて保存値と同じなら走査しない（opt-in。FAT では追加しても変わらないことがある）
+    if (_valid && _hdr.dir_mtime != 0 && dir_mtime(*_fs, _dir) == _hdr.dir_mtime) {
+        _verified = true;
+        return false;
+    }
+#endif
+    _walk = _fs->open(_dir);
+    if (!_walk || !_walk.isDirectory()) {
+        if (_walk) _walk.close();
+        return false;
+    }
+    if (_valid) _old = _fs->open(_path, FILE_READ);
+    _scan_count = 0;
+    _scan_crc = 0;
+    _pool = 0;
+    _npatch = 0;
+    _phase = Phase::Scan;
+    return true;
+}
+
+// 既存の索引の同じ位置と照合する。一致か、大きさ/日時だけの違い（その場で書き換える）なら true
+bool SdIndex::match_old(const SdIndexEntry& e, const char* name) {
+    if (!_old || _scan_count >= _hdr.count) return false;
+    SdIndexEntry o;
+    char oname[256];
+    const uint32_t pool_base = sizeof(SdIndexHeader) + _hdr.count * sizeof(SdIndexEntry);
+    if (!_old.seek(sizeof(SdIndexHeader) + _scan_count * sizeof(SdIndexEntry)) ||
+        _old.read(reinterpret_cast<uint8_t*>(&o), sizeof(o)) != sizeof(o) ||
+        o.name_len != e.name_len || o.flags != e.flags || o.name_len > sizeof(oname) ||
+        !_old.seek(pool_base + o.name_off) ||
+        _old.read(reinterpret_cast<uint8_t*>(oname), o.name_len) != o.name_len ||
+        memcmp(oname, name, o.name_len) != 0) return false;
+    if (o.size == e.size && o.mtime == e.mtime) return true;
+    if (_npatch == kMaxPatch) return false;
+    _patch_at[_npatch] = _scan_count;
+    _patch[_npatch++] = e;
+    return true;
+}
+
+bool SdIndex::step(uint16_t budget) {
+    if (_phase == Phase::Idle && !start_scan()) _phase = Phase::Done;
+    if (_phase == Phase::Done) return true;
+
+    for (uint16_t i = 0; i < budget; ++i) {
+        File f = _walk.openNextFile();
+        if (!f) {
+            _walk.close();
+            // 索引が無い/末尾が削除されただけなら、ここから後ろ（0件）を書き直す
+            if (_phase == Phase::Scan && (!_valid || _scan_count < _hdr.count)) begin_build();
+            if (_phase == Phase::Build) finish_build();
+            else if (_valid && _scan_count == _hdr.count) patch_in_place();
+            if (_old) _old.close();
+            _phase = Phase::Done;
+            return true;
+        }
+        const char* name = base_name(f.name());
+        if (skip_name(name)) { f.close(); continue; }
+        SdIndexEntry e;
+        e.name_off = _pool;
+        e.size = f.isDirectory() ? 0 : (uint32_t)f.size();
+        e.mtime = (uint32_t)f.getLastWrite();
+        e.name_len = (uint16_t)strlen(name);
+        e.flags = f.isDirectory() ? 1 : 0;
+        f.close();
+        _scan_crc = entry_crc(_scan_crc, e, name);
+        if (_phase == Phase::Scan && !match_old(e, name) && !begin_build()) {
+            if (_old) _old.close();
+            _walk.close();
+            _phase = Phase::Done;
+            return true;
+        }
+        if (_phase == Phase::Build) {
+            _ef.write(reinterpret_cast<const uint8_t*>(&e), sizeof(e));
+            _nf.write(reinterpret_cast<const uint8_t*>(name), e.name_len);
+        }
+        _pool += e.name_len;
+        ++_scan_count;
+    }
+    return false;
+}
+
+// ここ（_scan_count 番目）から後ろを一時ファイルに書き出し始める
+bool SdIndex::begin_build() {
+    char ep[40], np[40];
+    tmp_path(ep, sizeof(ep), _path, 'e');
+    tmp_path(np, sizeof(np), _path, 'n');
+    _ef = _fs->open(ep, FILE_WRITE);
+    _nf = _fs->open(np, FILE_WRITE);
+    if (!_ef || !_nf) {
+        abort_build();
+        return false;
+    }
+    _tail_at = _scan_count;
+    _tail_pool = _pool;
+    _phase = Phase::Build;
+    return true;
+}
+
+// 書きかけの一時ファイルを閉じて消す
+void SdIndex::abort_build() {
+    char ep[40], np[40];
+    tmp_path(ep, sizeof(ep), _path, 'e');
+    tmp_path(np, sizeof(np), _path, 'n');
+    if (_ef) _ef.close();
+    if (_nf) _nf.close();
+    _fs->remove(ep);
+    _fs->remove(np);
+}
+
+// 並びが同じなら、大きさ/日時の変わったエントリとヘッダだけを書き換える
+bool SdIndex::patch_in_place() {
+    if (_old) _old.close();
+    const uint32_t mtime = dir_mtime(*_fs, _dir);
+    if (_npatch == 0 && mtime == _hdr.dir_mtime) {
+        _verified = true;
+        return true;
+    }
+    SdIndexHeader h;
+    make_header(&h, _hdr.count, _hdr.pool_bytes, mtime, _scan_crc);
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    File f = _fs->open(_path, "r+");
+    bool ok = (bool)f;
+    for (uint8_t i = 0; ok && i < _npatch; ++i) {
+        ok = f.seek(sizeof(SdIndexHeader) + _patch_at[i] * sizeof(SdIndexEntry)) &&
+             f.write(reinterpret_cast<const uint8_t*>(&_patch[i]), sizeof(SdIndexEntry)) == sizeof(SdIndexEntry);
+    }
+    ok = ok && f.seek(0) && f.write(reinterpret_cast<const uint8_t*>(&h), sizeof(h)) == sizeof(h);
+    if (f) f.close();
+    if (ok) {
+        _hdr = h;
+        _verified = true;
+    } else {
+        _valid = false;   // 途中まで書いた索引は使わない（次回作り直す）
+        _fs->remove(_path);
+    }
+    xSemaphoreGive(_lock);
+    return ok;
+}
+
+// 既存の索引の前半（書き換え分を反映）＋一時ファイルの後半をつないで差し替える
+bool SdIndex::finish_build() {
+    char ep[40], np[40], tp[40];
+    tmp_path(ep, sizeof(ep), _path, 'e');
+    tmp_path(np, sizeof(np), _path, 'n');
+    tmp_path(tp, sizeof(tp), _path, 't');
+    _ef.close();
+    _nf.close();
+
+    SdIndexHeader h;
+    make_header(&h, _scan_count, _pool, dir_mtime(*_fs, _dir), _scan_crc);
+
+    File out = _fs->open(tp, FILE_WRITE);
+    File ef = _fs->open(ep, FILE_READ);
+    File nf = _fs->open(np, FILE_READ);
+    bool ok = out && ef && nf && (_tail_at == 0 || _old) &&
+              out.write(reinterpret_cast<const uint8_t*>(&h), sizeof(h)) == sizeof(h);
+    if (ok && _tail_at) {
+        // 前半のエントリ（名前オフセットは変わらない）
+        ok = _old.seek(sizeof(SdIndexHeader));
+        uint8_t p = 0;
+        for (uint32_t i = 0; ok && i < _tail_at; ++i) {
+            SdIndexEntry e;
+            ok = _old.read(reinterpret_cast<uint8_t*>(&e), sizeof(e)) == sizeof(e);
+            if (p < _npatch && _patch_at[p] == i) e = _patch[p++];
+            ok = ok && out.write(reinterpret_cast<const uint8_t*>(&e), sizeof(e)) == sizeof(e);
+        }
+    }
+    ok = ok && copy_all(ef, out);
+    if (ok && _tail_pool) {
+        ok = _old.seek(sizeof(SdIndexHeader) + _hdr.count * sizeof(SdIndexEntry)) &&
+             copy_n(_old, out, _tail_pool);
+    }
+    ok = ok && copy_all(nf, out);
+    if (out) out.close();
+    if (ef) ef.close();
+    if (nf) nf.close();
+    if (_old) _old.close();
+    _fs->remove(ep);
+    _fs->remove(np);
+    if (!ok) { _fs->remove(tp); return false; }
+
+    // page() と入れ替えが重ならないようにする
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _fs->remove(_path);
+    ok = _fs->rename(tp, _path);
+    if (ok) {
+        _hdr = h;
+        _valid = true;
+        _verified = true;
+    }
+    xSemaphoreGive(_lock);
+    return ok;
+}
+
+bool SdIndex::start_background(uint16_t budget, UBaseType_t priority, BaseType_t core) {
+    if (!_fs || _task) return false;
+    _budget = budget;
+    _phase = Phase::Idle;
+    return xTaskCreatePinnedToCore(task, "sdindex", 4096, this, priority, &_task, core) == pdPASS;
+}
+
+void SdIndex::task(void* arg) {
+    SdIndex* self = static_cast<SdIndex*>(arg);
+    while (!self->step(self->_budget)) vTaskDelay(1);
+    self->_task = nullptr;
+    vTaskDelete(nullptr);
+}
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+
+// SD のディレクトリ索引（/.sdindex）
+//   ヘッダ 32B + エントリ 16B x count + 名前プール（NUL なしで連結）
+//   エントリは固定長なので、任意の位置からファイルを開かずにページ単位で読める。
+// 起動時はヘッダだけを読んで使い、裏のタスクが少しずつ走査して既存のエントリと1件ずつ照合する。
+//   - 名前が同じで大きさ/日時だけ違うエントリは索引をその場で書き換える
+//   - 名前の並びが変わったら、その位置から後ろだけを一時ファイルに書き出し、前半は既存の索引から写す
+// FAT はファイルの追加や書き換えでディレクトリの更新日時を変えないので、既定では日時に頼らない。
+// 書き込むたびに日時を更新する運用なら SD_INDEX_TRUST_DIR_MTIME=1 で、日時が保存値と同じ時の走査を省ける。
+
+#include <stdint.h>
+
+#define SD_INDEX_MAGIC   "SDX1"
+#define SD_INDEX_VERSION 1
+
+#ifndef SD_INDEX_NAME_MAX
+#define SD_INDEX_NAME_MAX 64
+#endif
+#ifndef SD_INDEX_TRUST_DIR_MTIME
+#define SD_INDEX_TRUST_DIR_MTIME 0
+#endif
+
+struct SdIndexHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t entry_size;    // sizeof(SdIndexEntry)
+    uint32_t count;
+    uint32_t pool_bytes;
+    uint32_t dir_mtime;     // 作成時のディレクトリ更新日時（取れなければ 0）
+    uint32_t content_crc;   // 全エントリの (size, mtime, flags, name) の CRC32
+    uint32_t reserved[2];
+};
+
+struct SdIndexEntry {
+    uint32_t name_off;      // 名前プール内のオフセット
+    uint32_t size;
+    uint32_t mtime;
+    uint16_t name_len;
+    uint16_t flags;         // bit0: ディレクトリ
+};
+
+static_assert(sizeof(SdIndexHeader) == 32, "SdIndexHeader layout");
+static_assert(sizeof(SdIndexEntry) == 16, "SdIndexEntry layout");
+
+struct SdIndexItem {
+    char     name[SD_INDEX_NAME_MAX];   // 長い名前は切り詰める
+    uint32_t size;
+    uint32_t mtime;
+    bool     dir;
+};
+
+#ifdef ARDUINO
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+class SdIndex {
+public:
+    // 索引を開く（ヘッダの検査のみ）。索引が無い/壊れていれば false（count() は 0）
+    bool open(fs::FS& fs, const char* dir = "/", const char* path = "/.sdindex");
+    // 裏で走査して、変わっていれば作り直す。budget は1ステップで読むエントリ数
+    bool start_background(uint16_t budget = 16, UBaseType_t priority = 1, BaseType_t core = 0);
+
+    bool valid() const { return _valid; }
+    bool verified() const { return _verified; }    // 裏の走査で内容が一致した/作り直した
+    bool busy() const { return _task != nullptr; }
+    uint32_t count() const { return _hdr.count; }
+
+    // start 番目から最大 n 件を読む。戻り値は読めた件数
+    uint32_t page(uint32_t start, SdIndexItem* out, uint32_t n);
+
+    // 走査を1ステップ進める（タスクを使わない場合）。終わったら true
+    bool step(uint16_t budget);
+
+private:
+    enum class Phase : uint8_t { Idle, Scan, Build, Done };
+    static constexpr uint8_t kMaxPatch = 8;   // その場で書き換えるエントリの上限（超えたら後ろを書き直す）
+
+    bool load_header();
+    bool start_scan();
+    bool match_old(const SdIndexEntry& e, const char* name);
+    bool begin_build();
+    void abort_build();
+    bool patch_in_place();
+    bool finish_build();
+    static void task(void* arg);
+
+    fs::FS* _fs = nullptr;
+    char _dir[32] = "/";
+    char _path[32] = "/.sdindex";
+    SdIndexHeader _hdr = {};
+    bool _valid = false;
+    volatile bool _verified = false;
+    SemaphoreHandle_t _lock = nullptr;
+    TaskHandle_t _task = nullptr;
+    uint16_t _budget = 16;
+
+    // 走査状態
+    Phase _phase = Phase::Idle;
+    File _walk;
+    File _old;                  // 既存の索引（照合用）
+    File _ef, _nf;              // 書き直す後半のエントリと名前
+    uint32_t _scan_count = 0;
+    uint32_t _scan_crc = 0;
+    uint32_t _pool = 0;
+    uint32_t _tail_at = 0;      // 書き直しを始めたエントリ番号（それより前は既存の索引から写す）
+    uint32_t _tail_pool = 0;    // そこまでの名前プールのバイト数
+    uint8_t _npatch = 0;
+    uint32_t _patch_at[kMaxPatch];
+    SdIndexEntry _patch[kMaxPatch];
+};
+#endif
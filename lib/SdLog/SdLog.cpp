@@ -0,0 +1,217 @@
+#include "SdLog.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp32/rom/crc.h>
+
+namespace {
+
+constexpr uint16_t kPerSector = SD_LOG_SECTOR / sizeof(SdLogRecord);
+constexpr uint8_t kFlushCmd = 0xFF;
+
+uint32_t record_crc(const SdLogRecord& r) {
+    return crc32_le(0, reinterpret_cast<const uint8_t*>(&r), offsetof(SdLogRecord, crc));
+}
+
+bool record_valid(const SdLogRecord& r) {
+    return r.seq != 0 && r.crc == record_crc(r);
+}
+
+}  // namespace
+
+bool SdLog::begin(fs::FS& fs, const char* path, uint32_t bytes) {
+    _fs = &fs;
+    strncpy(_path, path, sizeof(_path) - 1);
+    _sectors = bytes / SD_LOG_SECTOR;
+    if (_sectors < 2 || !preallocate(_sectors * SD_LOG_SECTOR)) return false;
+    _file = fs.open(_path, "r+");
+    if (!_file) return false;
+    recover();
+    _queue = xQueueCreate(2, sizeof(uint8_t));
+    return _queue && xTaskCreatePinnedToCore(task, "sdlog", 3072, this, 1, nullptr, 0) == pdPASS;
+}
+
+bool SdLog::preallocate(uint32_t bytes) {
+    File f = _fs->open(_path, FILE_READ);
+    const bool ok = f && f.size() == bytes;
+    if (f) f.close();
+    if (ok) return true;
+
+    // 最初に一度だけゼロで埋めて確保する（以後はこの範囲を上書きするだけ）
+    f = _fs->open(_path, FILE_WRITE);
+    if (!f) return false;
+    static uint8_t zero[SD_LOG_SECTOR];
+    for (uint32_t off = 0; off < bytes; off += SD_LOG_SECTOR) {
+        if (f.write(zero, SD_LOG_SECTOR) != SD_LOG_SECTOR) { f.close(); return false; }
+    }
+    f.close();
+    return true;
+}
+
+bool SdLog::read_record(uint32_t offset, SdLogRecord* r) {
+    return _file.seek(offset) &&
+           _file.read(reinterpret_cast<uint8_t*>(r), sizeof(*r)) == sizeof(*r) &&
+           record_valid(*r);
+}
+
+void SdLog::recover() {
+    // 各セクタ先頭の seq は「今周回で書いた分（>= セクタ0の seq）」の後に「前周回/未使用」が続く。
+    // 条件が成り立つ最後のセクタを二分探索し、その中を先頭から見て末尾を決める。
+    SdLogRecord r;
+    Sector& s = _buf[_cur];
+    s.index = 0;
+    s.used = 0;
+    if (!read_record(0, &r)) return;
+    const uint32_t seq0 = r.seq;
+    uint32_t lo = 0, hi = _sectors - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if (read_record(mid * SD_LOG_SECTOR, &r) && r.seq >= seq0) lo = mid;
+        else hi = mid - 1;
+    }
+
+    uint32_t last_seq = 0;
+    uint16_t used = 0;
+    _file.seek(lo * SD_LOG_SECTOR);
+    _file.read(reinterpret_cast<uint8_t*>(s.rec), sizeof(s.rec));
+    for (; used < kPerSector; ++used) {
+        const SdLogRecord& x = s.rec[used];
+        if (!record_valid(x) || (used && x.seq != last_seq + 1)) break;
+        last_seq = x.seq;
+    }
+    _next_seq = last_seq + 1;
+    _stats.recovered_seq = last_seq;
+    if (used == kPerSector) {
+        // 満杯なら次のセクタから（末尾なら先頭へ）
+        s.index = (lo + 1) % _sectors;
+        s.used = 0;
+    } else {
+        s.index = lo;
+        s.used = used;
+    }
+}
+
+bool SdLog::append(SdLogType type, const void* data, uint8_t len) {
+    if (!_queue) return false;
+    const uint32_t t0 = micros();
+    if (len > sizeof(SdLogRecord::data)) len = sizeof(SdLogRecord::data);
+
+    bool ok = true;
+    uint8_t full = 0xFF;
+    portENTER_CRITICAL(&_mux);
+    Sector& s = _buf[_cur];
+    if (s.used == kPerSector) {
+        ok = false;    // 前のセクタを書き出し中で切り替えられない
+        ++_stats.dropped;
+    } else {
+        SdLogRecord& r = s.rec[s.used];
+        memset(&r, 0, sizeof(r));
+        r.seq = _next_seq++;
+        r.t_ms = millis();
+        r.type = (uint8_t)type;
+        r.len = len;
+        memcpy(r.data, data, len);
+        r.crc = record_crc(r);
+        ++_stats.appended;
+        if (++s.used == kPerSector && !_busy) {
+            // 満杯になったらもう一方へ切り替えて、こちらを書き込みタスクに渡す
+            full = _cur;
+            _busy = true;
+            Sector& n = _buf[_cur ^ 1];
+            n.index = (s.index + 1) % _sectors;
+            n.used = 0;
+            _cur ^= 1;
+        }
+    }
+    _stats.append_us += micros() - t0;
+    portEXIT_CRITICAL(&_mux);
+    if (full != 0xFF) xQueueSend(_queue, &full, 0);
+    return ok;
+}
+
+void SdLog::write_sector(const Sector& s) {
+    const uint32_t t0 = micros();
+    // 未使用部分はゼロのまま書く（回復時に CRC で弾かれる）
+    static uint8_t raw[SD_LOG_SECTOR];
+    memset(raw, 0, sizeof(raw));
+    memcpy(raw, s.rec, s.used * sizeof(SdLogRecord));
+    if (_file.seek(s.index * SD_LOG_SECTOR)) {
+        _file.write(raw, sizeof(raw));
+        _file.flush();
+    }
+    const uint32_t dt = micros() - t0;
+    portENTER_CRITICAL(&_mux);
+    ++_stats.sectors_written;
+    _stats.write_us += dt;
+    if (dt > _stats.write_max_us) _stats.write_max_us = dt;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void SdLog::task(void* arg) {
+    SdLog* self = static_cast<SdLog*>(arg);
+    static Sector partial;
+    uint32_t flushed_seq = 0;
+    for (;;) {
+        uint8_t idx;
+        if (xQueueReceive(self->_queue, &idx, pdMS_TO_TICKS(SD_LOG_FLUSH_MS)) == pdTRUE && idx != kFlushCmd) {
+            self->write_sector(self->_buf[idx]);
+            portENTER_CRITICAL(&self->_mux);
+            self->_busy = false;
+            // 書いている間に現在のバッファも満杯になっていたら続けて渡す
+            if (self->_buf[self->_cur].used == kPerSector) {
+                uint8_t next = self->_cur;
+                Sector& n = self->_buf[self->_cur ^ 1];
+                n.index = (self->_buf[next].index + 1) % self->_sectors;
+                n.used = 0;
+                self->_cur ^= 1;
+                self->_busy = true;
+                portEXIT_CRITICAL(&self->_mux);
+                xQueueSend(self->_queue, &next, 0);
+                continue;
+            }
+            portEXIT_CRITICAL(&self->_mux);
+            continue;
+        }
+        // 一定時間ごとに書きかけのセクタを書き出す（電源断で失う範囲を抑える）
+        portENTER_CRITICAL(&self->_mux);
+        const Sector& cur = self->_buf[self->_cur];
+        const bool dirty = cur.used > 0 && cur.used < kPerSector &&
+                           cur.rec[cur.used - 1].seq != flushed_seq;
+        if (dirty) {
+            partial.index = cur.index;
+            partial.used = cur.used;
+            memcpy(partial.rec, cur.rec, cur.used * sizeof(SdLogRecord));
+            ++self->_stats.partial_rewrites;
+        }
+        portEXIT_CRITICAL(&self->_mux);
+        if (dirty) {
+            self->write_sector(partial);
+            flushed_seq = partial.rec[partial.used - 1].seq;
+        }
+    }
+}
+
+SdLogStats SdLog::stats() {
+    SdLogStats s;
+    portENTER_CRITICAL(&_mux);
+    s = _stats;
+    portEXIT_CRITICAL(&_mux);
+    return s;
+}
+
+float SdLog::write_amplification() {
+    SdLogStats s = stats();
+    return s.appended ? (float)(s.sectors_written * SD_LOG_SECTOR) / (s.appended * sizeof(SdLogRecord)) : 0.0f;
+}
+
+void SdLog::report(Print& out) {
+    SdLogStats s = stats();
+    out.printf("[SDLOG] rec=%lu drop=%lu sect=%lu partial=%lu wa=%.2f append_avg=%luus write_avg=%luus max=%luus\n",
+               (unsigned long)s.appended, (unsigned long)s.dropped,
+               (unsigned long)s.sectors_written, (unsigned long)s.partial_rewrites,
+               write_amplification(),
+               (unsigned long)(s.appended ? s.append_us / s.appended : 0),
+               (unsigned long)(s.sectors_written ? s.write_us / s.sectors_written : 0),
+               (unsigned long)s.write_max_us);
+}
+#endif
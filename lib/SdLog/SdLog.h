@@ -0,0 +1,90 @@
+#pragma once
+
+// SD 上の追記専用テレメトリログ。
+// 起動時にファイルを固定サイズで確保し（以後はサイズもクラスタも変わらない）、32B の固定長レコードを
+// RAM のセクタバッファ（512B = 16件）に溜めて、セクタ境界単位で書く。末尾に達したら先頭に戻る（リング）。
+// 各レコードは通し番号と CRC を持つので、電源断の後は通し番号の二分探索で末尾を見つけて続きから書ける。
+// append() はどのタスクからでも呼べ、SD への書き込みは待たない（書き込みタスクが満杯で詰まれば捨てて数える）。
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SD_LOG_ENABLE
+#define SD_LOG_ENABLE 0
+#endif
+#ifndef SD_LOG_KB
+#define SD_LOG_KB 1024
+#endif
+#ifndef SD_LOG_FLUSH_MS
+#define SD_LOG_FLUSH_MS 2000     // 書きかけのセクタを書き出す間隔
+#endif
+
+#define SD_LOG_SECTOR 512
+
+enum class SdLogType : uint8_t { Boot = 1, Heap, Audio, Touch, Mark };
+
+struct SdLogRecord {
+    uint32_t seq;           // 1 から始まる通し番号（0 は未使用）
+    uint32_t t_ms;
+    uint8_t  type;          // SdLogType
+    uint8_t  len;           // data の有効バイト数
+    uint16_t reserved;
+    uint8_t  data[16];
+    uint32_t crc;           // seq..data の CRC32
+};
+
+static_assert(sizeof(SdLogRecord) == 32, "SdLogRecord layout");
+static_assert(SD_LOG_SECTOR % sizeof(SdLogRecord) == 0, "SdLogRecord must tile a sector");
+
+struct SdLogStats {
+    uint32_t appended;          // 受け付けたレコード数
+    uint32_t dropped;           // 書き込みが追いつかず捨てた数
+    uint32_t sectors_written;   // 実際に書いたセクタ数（書きかけの再書き込みを含む）
+    uint32_t partial_rewrites;  // 書きかけセクタの書き出し回数
+    uint32_t append_us;         // append() の累計 CPU 時間
+    uint32_t write_us;          // 書き込みタスクの累計時間
+    uint32_t write_max_us;
+    uint32_t recovered_seq;     // 起動時に見つけた最後の通し番号
+};
+
+#ifdef ARDUINO
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+class SdLog {
+public:
+    bool begin(fs::FS& fs, const char* path, uint32_t bytes = SD_LOG_KB * 1024UL);
+    bool append(SdLogType type, const void* data, uint8_t len);
+    SdLogStats stats();
+    // 論理的な書き込み増幅（書いたバイト / 受け付けたレコードのバイト）。カード内部の増幅は含まない
+    float write_amplification();
+    void report(Print& out);
+
+private:
+    struct Sector {
+        uint32_t index;                 // ファイル内のセクタ番号
+        uint16_t used;                  // 埋まっているレコード数
+        SdLogRecord rec[SD_LOG_SECTOR / sizeof(SdLogRecord)];
+    };
+
+    bool preallocate(uint32_t bytes);
+    bool read_record(uint32_t offset, SdLogRecord* r);
+    void recover();
+    void write_sector(const Sector& s);
+    static void task(void* arg);
+
+    fs::FS* _fs = nullptr;
+    File _file;
+    char _path[32] = "";
+    uint32_t _sectors = 0;
+    uint32_t _next_seq = 1;
+
+    Sector _buf[2];
+    uint8_t _cur = 0;
+    volatile bool _busy = false;    // もう一方のバッファを書き込みタスクが使用中
+    QueueHandle_t _queue = nullptr;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    SdLogStats _stats = {};
+};
+#endif
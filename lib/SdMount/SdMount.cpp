@@ -0,0 +1,170 @@
+#include <SD.h>
+#include <Preferences.h>
+#include <esp32/rom/crc.h>
+#include "SdMount.h"
+
+namespace {
+
+// 80MHz を整数分周できる値だけを候補にする
+const uint32_t kClocks[] = {10000000, 16000000, 20000000, 26666666, 40000000};
+constexpr uint8_t kNumClocks = sizeof(kClocks) / sizeof(kClocks[0]);
+constexpr uint8_t kRounds = 2;       // 1段あたりの検証回数
+constexpr uint8_t kTopRounds = 6;    // 最上段は一段下げる余裕が無いので多めに検証する
+const uint32_t kProbeSectors[] = {0, 1, 2, 8, 32, 64};
+const char* kProbePath = "/.sdclk.tmp";
+constexpr size_t kProbeBytes = 4096;
+
+uint32_t sectors_crc() {
+    static uint8_t sector[512];
+    uint32_t crc = 0;
+    for (uint32_t s : kProbeSectors) {
+        if (!SD.readRAW(sector, s)) return 0;
+        crc = crc32_le(crc, sector, sizeof(sector));
+    }
+    return crc;
+}
+
+uint32_t card_id() {
+    static uint8_t mbr[512];
+    uint32_t info[2] = {(uint32_t)SD.cardType(), (uint32_t)SD.numSectors()};
+    uint32_t crc = crc32_le(0, reinterpret_cast<const uint8_t*>(info), sizeof(info));
+    if (SD.readRAW(mbr, 0)) crc = crc32_le(crc, mbr, sizeof(mbr));
+    return crc;
+}
+
+bool write_readback(uint32_t seed) {
+    static uint8_t buf[kProbeBytes];
+    for (size_t i = 0; i < kProbeBytes; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+    const uint32_t expect = crc32_le(0, buf, kProbeBytes);
+
+    File f = SD.open(kProbePath, FILE_WRITE);
+    if (!f) return false;
+    bool ok = f.write(buf, kProbeBytes) == kProbeBytes;
+    f.close();
+    memset(buf, 0, kProbeBytes);
+    f = SD.open(kProbePath, FILE_READ);
+    if (!f) return false;
+    ok = ok && f.read(buf, kProbeBytes) == kProbeBytes;
+    f.close();
+    SD.remove(kProbePath);
+    return ok && crc32_le(0, buf, kProbeBytes) == expect;
+}
+
+bool mount(SPIClass& spi, uint8_t cs, uint32_t hz) {
+    SD.end();
+    return SD.begin(cs, spi, hz);
+}
+
+bool verify(uint32_t ref_crc, uint8_t rounds, uint32_t hz) {
+    for (uint8_t r = 0; r < rounds; ++r) {
+        if (sectors_crc() != ref_crc) return false;
+        if (!write_readback(hz ^ (r * 0x9E3779B9u))) return false;
+    }
+    return true;
+}
+
+void key_for(uint32_t id, char* key) {
+    snprintf(key, 9, "%08x", (unsigned)id);
+}
+
+// カードごとの実績。crc は安全なクロックで読んだ検証セクタの CRC（高速側の読み出し確認に使う）
+struct CachedClock {
+    uint32_t hz;
+    uint32_t crc;
+};
+
+bool load_cached(Preferences& prefs, const char* key, CachedClock* c) {
+    return prefs.getBytes(key, c, sizeof(*c)) == sizeof(*c) && c->hz != 0;
+}
+
+// 実績のあるクロックでマウントし、読み出しだけで確かめる（書き込みはしない）
+bool try_cached(SPIClass& spi, uint8_t cs, uint32_t id, const CachedClock& c) {
+    return mount(spi, cs, c.hz) && card_id() == id && sectors_crc() == c.crc;
+}
+
+}  // namespace
+
+SdMountResult sd_mount_auto(SPIClass& spi, uint8_t cs, uint32_t safe_hz) {
+    SdMountResult res = {false, false, safe_hz, 0};
+    char key[9];
+    CachedClock cached;
+    Preferences prefs;
+    prefs.begin("sdclk", false);
+
+    // 前回のカードなら、そのクロックで直接マウントしてセクタの CRC を照合するだけで済ませる
+    const uint32_t last = prefs.getUInt("last", 0);
+    key_for(last, key);
+    if (last && load_cached(prefs, key, &cached) && try_cached(spi, cs, last, cached)) {
+        prefs.end();
+        res.ok = res.cached = true;
+        res.hz = cached.hz;
+        res.card_id = last;
+        return res;
+    }
+
+    if (!mount(spi, cs, safe_hz)) {
+        prefs.end();
+        return res;
+    }
+    res.ok = true;
+    res.card_id = card_id();
+    const uint32_t ref_crc = sectors_crc();
+    if (ref_crc == 0) {  // RAW 読み出しができないなら安全側のまま
+        prefs.end();
+        return res;
+    }
+    key_for(res.card_id, key);
+    prefs.putUInt("last", res.card_id);
+
+    // 差し替えられた別のカードでも、実績があれば読み出しの照合だけで使う
+    if (res.card_id != last && load_cached(prefs, key, &cached) && cached.crc == ref_crc) {
+        if (cached.hz == safe_hz || try_cached(spi, cs, res.card_id, cached)) {
+            prefs.end();
+            res.cached = true;
+            res.hz = cached.hz;
+            return res;
+        }
+    }
+    prefs.remove(key);
+
+    // 段階的に上げて、最初に失敗した段の2つ下（=成功した最上段の1つ下）を採用する。
+    // 書き込みの読み戻しまで確かめるのはこの選び直しのときだけ
+    int8_t best = -1;
+    bool failed = false;
+    for (uint8_t i = 0; i < kNumClocks; ++i) {
+        if (kClocks[i] <= safe_hz) continue;
+        const uint8_t rounds = (i == kNumClocks - 1) ? kTopRounds : kRounds;
+        if (!mount(spi, cs, kClocks[i]) || !verify(ref_crc, rounds, kClocks[i])) {
+            failed = true;
+            break;
+        }
+        best = i;
+    }
+    uint32_t chosen = safe_hz;
+    if (best >= 0) {
+        int8_t pick = failed ? best - 1 : best;
+        if (pick >= 0 && kClocks[pick] > safe_hz) chosen = kClocks[pick];
+    }
+
+    if (!mount(spi, cs, chosen)) {
+        chosen = safe_hz;
+        res.ok = mount(spi, cs, chosen);
+    }
+    if (res.ok) {
+        cached = CachedClock{chosen, ref_crc};
+        prefs.putBytes(key, &cached, sizeof(cached));
+    }
+    prefs.end();
+    res.hz = chosen;
+    return res;
+}
+
+void sd_mount_forget() {
+    Preferences prefs;
+    if (!prefs.begin("sdclk", false)) return;
+    prefs.clear();
+    prefs.end();
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// SD のマウントクロック自動選択。
+// NVS（"sdclk"）に前回のカードの実績があれば、そのクロックで直接マウントしてカードの識別値と
+// RAWセクタの CRC を照合する（読み出しのみ）。合わなければ安全なクロックでマウントし直してカードを識別し、
+// 段階的にクロックを上げて読み出し（RAWセクタのCRC）と書き込み（パターンの読み戻し）を検証して、
+// 余裕を持たせた速度を保存する。
+//
+// SPI の SD ドライバは CID を公開していないため、カード識別は種別・セクタ数・MBR の CRC32 で代用する。
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#ifndef SD_MOUNT_SAFE_HZ
+#define SD_MOUNT_SAFE_HZ 10000000
+#endif
+
+struct SdMountResult {
+    bool     ok;
+    bool     cached;    // NVS の値をそのまま使えた（書き込みの検証はしていない）
+    uint32_t hz;        // 実際にマウントしたクロック
+    uint32_t card_id;
+};
+
+SdMountResult sd_mount_auto(SPIClass& spi, uint8_t cs, uint32_t safe_hz = SD_MOUNT_SAFE_HZ);
+// 保存済みの結果を消す（次回起動で再選択させる）
+void sd_mount_forget();
@@ -0,0 +1,52 @@
+#pragma once
+
+// SdBackend のメモリ上の実装（ホストでの確認用）。ディレクトリは区別せず、パスの前方一致で一覧する。
+
+#include <map>
+#include <string>
+#include <string.h>
+#include "SdService.h"
+
+class SdMemBackend : public SdBackend {
+public:
+    int32_t read(const char* path, uint32_t offset, uint8_t* buf, size_t len) override {
+        auto it = _files.find(path);
+        if (it == _files.end()) return -1;
+        if (offset >= it->second.size()) return 0;
+        size_t n = it->second.size() - offset;
+        if (n > len) n = len;
+        memcpy(buf, it->second.data() + offset, n);
+        return (int32_t)n;
+    }
+    int32_t write(const char* path, const uint8_t* buf, size_t len, bool append) override {
+        std::string& f = _files[path];
+        if (!append) f.clear();
+        f.append(reinterpret_cast<const char*>(buf), len);
+        return (int32_t)len;
+    }
+    int32_t list(const char* dir, char* buf, size_t len) override {
+        std::string prefix(dir);
+        if (prefix.empty() || prefix.back() != '/') prefix += '/';
+        int32_t count = 0;
+        size_t used = 0;
+        if (len) buf[0] = '\0';
+        for (auto& kv : _files) {
+            if (kv.first.compare(0, prefix.size(), prefix) != 0) continue;
+            const std::string name = kv.first.substr(prefix.size());
+            if (used + name.size() + 2 <= len) {
+                memcpy(buf + used, name.data(), name.size());
+                used += name.size();
+                buf[used++] = '\n';
+                buf[used] = '\0';
+            }
+            ++count;
+        }
+        return count;
+    }
+    bool remove(const char* path) override { return _files.erase(path) > 0; }
+
+    std::map<std::string, std::string>& files() { return _files; }
+
+private:
+    std::map<std::string, std::string> _files;
+};
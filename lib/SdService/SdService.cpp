@@ -0,0 +1,159 @@
+#include <string.h>
+#include "SdService.h"
+
+SdResult sd_service_execute(SdBackend& be, const SdRequest& req) {
+    SdResult res = {req.op, false, -1, 0, 0};
+    switch (req.op) {
+    case SdOp::Read:
+        res.bytes = be.read(req.path, req.offset, req.buf, req.len);
+        break;
+    case SdOp::Write:
+    case SdOp::Append:
+        res.bytes = be.write(req.path, req.buf, req.len, req.op == SdOp::Append);
+        res.ok = res.bytes == (int32_t)req.len;
+        return res;
+    case SdOp::List:
+        res.bytes = be.list(req.path, reinterpret_cast<char*>(req.buf), req.len);
+        break;
+    case SdOp::Remove:
+        res.ok = be.remove(req.path);
+        res.bytes = 0;
+        return res;
+    }
+    res.ok = res.bytes >= 0;
+    return res;
+}
+
+#ifdef ARDUINO
+int32_t SdFsBackend::read(const char* path, uint32_t offset, uint8_t* buf, size_t len) {
+    File f = _fs.open(path, FILE_READ);
+    if (!f) return -1;
+    int32_t n = (offset == 0 || f.seek(offset)) ? (int32_t)f.read(buf, len) : -1;
+    f.close();
+    return n;
+}
+
+int32_t SdFsBackend::write(const char* path, const uint8_t* buf, size_t len, bool append) {
+    File f = _fs.open(path, append ? FILE_APPEND : FILE_WRITE);
+    if (!f) return -1;
+    int32_t n = (int32_t)f.write(buf, len);
+    f.close();
+    return n;
+}
+
+int32_t SdFsBackend::list(const char* dir, char* buf, size_t len) {
+    File d = _fs.open(dir);
+    if (!d || !d.isDirectory()) return -1;
+    int32_t count = 0;
+    size_t used = 0;
+    if (len) buf[0] = '\0';
+    for (File f = d.openNextFile(); f; f = d.openNextFile()) {
+        const char* name = f.name();
+        size_t n = strlen(name);
+        if (used + n + 2 <= len) {
+            memcpy(buf + used, name, n);
+            used += n;
+            buf[used++] = '\n';
+            buf[used] = '\0';
+        }
+        f.close();
+        ++count;
+    }
+    d.close();
+    return count;
+}
+
+bool SdFsBackend::remove(const char* path) {
+    return _fs.remove(path);
+}
+
+bool SdService::begin(UBaseType_t priority, BaseType_t core) {
+    if (_task) return true;
+    for (uint8_t i = 0; i < 2; ++i) {
+        _q[i] = xQueueCreate(SD_SERVICE_QUEUE_LEN, sizeof(SdRequest));
+        if (!_q[i]) return false;
+    }
+    return xTaskCreatePinnedToCore(task, "sdsvc", 4096, this, priority, &_task, core) == pdPASS;
+}
+
+bool SdService::submit(SdPrio prio, SdOp op, const char* path, uint32_t offset,
+                       uint8_t* buf, size_t len, SdDoneCb cb, void* user,
+                       SdFuture* fut, uint32_t wait_ms) {
+    const uint8_t q = (uint8_t)prio;
+    if (!_task || strlen(path) >= SD_SERVICE_PATH_MAX) return false;
+    SdRequest req;
+    req.op = op;
+    strncpy(req.path, path, SD_SERVICE_PATH_MAX);
+    req.offset = offset;
+    req.buf = buf;
+    req.len = len;
+    req.cb = cb;
+    req.user = user;
+    req.fut = fut;
+    req.t_enq_us = micros();
+    if (xQueueSend(_q[q], &req, pdMS_TO_TICKS(wait_ms)) != pdTRUE) {
+        portENTER_CRITICAL(&_mux);
+        ++_stats.rejected[q];
+        portEXIT_CRITICAL(&_mux);
+        return false;
+    }
+    uint16_t depth = (uint16_t)uxQueueMessagesWaiting(_q[q]);
+    portENTER_CRITICAL(&_mux);
+    if (depth > _stats.depth_max[q]) _stats.depth_max[q] = depth;
+    portEXIT_CRITICAL(&_mux);
+    // 1要求につき通知1回。タスクは通知1回ごとに High を優先して1件取り出す
+    xTaskNotifyGive(_task);
+    return true;
+}
+
+SdServiceStats SdService::stats() {
+    SdServiceStats s;
+    portENTER_CRITICAL(&_mux);
+    s = _stats;
+    portEXIT_CRITICAL(&_mux);
+    for (uint8_t i = 0; i < 2; ++i) s.depth[i] = _q[i] ? (uint16_t)uxQueueMessagesWaiting(_q[i]) : 0;
+    return s;
+}
+
+void SdService::report(Print& out) {
+    SdServiceStats s = stats();
+    static const char* const names[2] = {"high", "low"};
+    for (uint8_t i = 0; i < 2; ++i) {
+        const uint32_t n = s.done[i] + s.failed[i];
+        out.printf("[SDSVC] %s done=%lu fail=%lu rej=%lu depth=%u/%u wait_max=%luus svc_avg=%luus svc_max=%luus\n",
+                   names[i], (unsigned long)s.done[i], (unsigned long)s.failed[i], (unsigned long)s.rejected[i],
+                   s.depth[i], s.depth_max[i], (unsigned long)s.wait_max_us[i],
+                   (unsigned long)(n ? s.service_sum_us[i] / n : 0), (unsigned long)s.service_max_us[i]);
+    }
+}
+
+void SdService::task(void* arg) {
+    SdService* self = static_cast<SdService*>(arg);
+    SdRequest req;
+    for (;;) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+        if (xQueueReceive(self->_q[0], &req, 0) == pdTRUE) self->handle(req, 0);
+        else if (xQueueReceive(self->_q[1], &req, 0) == pdTRUE) self->handle(req, 1);
+    }
+}
+
+void SdService::handle(SdRequest& req, uint8_t q) {
+    const uint32_t t0 = micros();
+    SdResult res = sd_service_execute(_be, req);
+    res.wait_us = t0 - req.t_enq_us;
+    res.service_us = micros() - t0;
+
+    portENTER_CRITICAL(&_mux);
+    if (res.ok) ++_stats.done[q]; else ++_stats.failed[q];
+    if (res.wait_us > _stats.wait_max_us[q]) _stats.wait_max_us[q] = res.wait_us;
+    if (res.service_us > _stats.service_max_us[q]) _stats.service_max_us[q] = res.service_us;
+    _stats.service_sum_us[q] += res.service_us;
+    portEXIT_CRITICAL(&_mux);
+
+    if (req.cb) req.cb(res, req.user);
+    if (req.fut) {
+        req.fut->_res = res;
+        xSemaphoreGive(req.fut->_sem);
+    }
+}
+#endif
@@ -0,0 +1,138 @@
+#pragma once
+
+// SD I/O サービス。
+// begin() 以降、SD（fs::FS と SPI バス）はこのサービスのタスクだけが触る。
+// 要求は High（音声ストリームなど）/ Low（一覧・メタデータなど）の2本のキューに積み、
+// 常に High を先に処理する。完了はコールバック（SDタスク上で呼ばれる）か SdFuture で受け取る。
+// 要求の実行部分（SdBackend / sd_service_execute）は Arduino 非依存で、ホストでは SdMemBackend を使える。
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SD_SERVICE_PATH_MAX
+#define SD_SERVICE_PATH_MAX 48
+#endif
+#ifndef SD_SERVICE_QUEUE_LEN
+#define SD_SERVICE_QUEUE_LEN 8
+#endif
+// 1 で各ビルドの loop() が10秒ごとに統計をシリアルへ出す
+#ifndef SD_SERVICE_REPORT
+#define SD_SERVICE_REPORT 0
+#endif
+
+enum class SdOp : uint8_t { Read, Write, Append, List, Remove };
+enum class SdPrio : uint8_t { High = 0, Low = 1 };
+
+struct SdResult {
+    SdOp     op;
+    bool     ok;
+    int32_t  bytes;        // Read/Write/Append: バイト数、List: 件数
+    uint32_t wait_us;      // キューに積まれてから処理開始まで
+    uint32_t service_us;   // 処理にかかった時間
+};
+
+typedef void (*SdDoneCb)(const SdResult& res, void* user);
+
+class SdBackend {
+public:
+    virtual ~SdBackend() {}
+    // 失敗時は -1
+    virtual int32_t read(const char* path, uint32_t offset, uint8_t* buf, size_t len) = 0;
+    // append=false なら作り直して先頭から書く
+    virtual int32_t write(const char* path, const uint8_t* buf, size_t len, bool append) = 0;
+    // 名前を '\n' 区切りで buf に詰める（入りきらない分は件数だけ数える）。戻り値は件数
+    virtual int32_t list(const char* dir, char* buf, size_t len) = 0;
+    virtual bool remove(const char* path) = 0;
+};
+
+class SdFuture;
+
+struct SdRequest {
+    SdOp      op;
+    char      path[SD_SERVICE_PATH_MAX];
+    uint32_t  offset;
+    uint8_t*  buf;
+    size_t    len;
+    SdDoneCb  cb;
+    void*     user;
+    SdFuture* fut;
+    uint32_t  t_enq_us;
+};
+
+// 1要求をバックエンドで実行する（時間の計測は呼び出し側）
+SdResult sd_service_execute(SdBackend& be, const SdRequest& req);
+
+struct SdServiceStats {
+    // [0]=High, [1]=Low
+    uint32_t done[2];
+    uint32_t failed[2];
+    uint32_t rejected[2];        // キュー満杯で積めなかった
+    uint16_t depth[2];           // 現在のキュー長
+    uint16_t depth_max[2];
+    uint32_t wait_max_us[2];
+    uint32_t service_max_us[2];
+    uint64_t service_sum_us[2];
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// fs::FS（SD など）をそのまま使うバックエンド
+class SdFsBackend : public SdBackend {
+public:
+    explicit SdFsBackend(fs::FS& fs) : _fs(fs) {}
+    int32_t read(const char* path, uint32_t offset, uint8_t* buf, size_t len) override;
+    int32_t write(const char* path, const uint8_t* buf, size_t len, bool append) override;
+    int32_t list(const char* dir, char* buf, size_t len) override;
+    bool remove(const char* path) override;
+
+private:
+    fs::FS& _fs;
+};
+
+// 完了待ち用。1回の要求に1つ使い、wait() が true を返したら result() が有効
+class SdFuture {
+public:
+    SdFuture() { _sem = xSemaphoreCreateBinaryStatic(&_sem_buf); }
+    bool wait() { return xSemaphoreTake(_sem, portMAX_DELAY) == pdTRUE; }
+    bool wait(uint32_t timeout_ms) { return xSemaphoreTake(_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE; }
+    const SdResult& result() const { return _res; }
+
+private:
+    friend class SdService;
+    StaticSemaphore_t _sem_buf;
+    SemaphoreHandle_t _sem;
+    SdResult _res;
+};
+
+class SdService {
+public:
+    explicit SdService(SdBackend& be) : _be(be) {}
+    // core 0 にタスクを作る。以降 SD へ直接アクセスしないこと
+    bool begin(UBaseType_t priority = 2, BaseType_t core = 0);
+
+    // buf は完了まで呼び出し側が保持する。Write/Append では読み出しのみ
+    bool submit(SdPrio prio, SdOp op, const char* path, uint32_t offset,
+                uint8_t* buf, size_t len, SdDoneCb cb = nullptr, void* user = nullptr,
+                SdFuture* fut = nullptr, uint32_t wait_ms = 0);
+
+    bool running() const { return _task != nullptr; }
+    SdServiceStats stats();
+    void report(Print& out);
+
+private:
+    static void task(void* arg);
+    void handle(SdRequest& req, uint8_t q);
+
+    SdBackend& _be;
+    QueueHandle_t _q[2] = {nullptr, nullptr};
+    TaskHandle_t _task = nullptr;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    SdServiceStats _stats = {};
+};
+#endif
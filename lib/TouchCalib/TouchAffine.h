@@ -0,0 +1,74 @@
+#pragma once
+
+// タッチ生座標 → 画面座標の 2x3 アフィン変換（Q16 固定小数点）
+//   sx = (a*rx + b*ry + c) >> 16
+//   sy = (d*rx + e*ry + f) >> 16
+// 回転・反転・スケール・オフセットを1つの行列にまとめ、サンプル毎には分岐なしで適用する。
+
+#include <stdint.h>
+#include <math.h>
+
+struct TouchAffine {
+    int32_t a, b, c;
+    int32_t d, e, f;
+};
+
+#define TOUCH_AFFINE_ONE ((int32_t)1 << 16)
+
+inline void touch_affine_apply(const TouchAffine& m, int32_t rx, int32_t ry, int16_t* sx, int16_t* sy) {
+    *sx = (int16_t)((m.a * rx + m.b * ry + m.c) >> 16);
+    *sy = (int16_t)((m.d * rx + m.e * ry + m.f) >> 16);
+}
+
+// 整数係数の行列（回転/反転用）。c,f には丸め用の 0.5 を足しておく
+inline TouchAffine touch_affine_make(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f) {
+    TouchAffine m = {a * TOUCH_AFFINE_ONE, b * TOUCH_AFFINE_ONE, c * TOUCH_AFFINE_ONE + TOUCH_AFFINE_ONE / 2,
+                     d * TOUCH_AFFINE_ONE, e * TOUCH_AFFINE_ONE, f * TOUCH_AFFINE_ONE + TOUCH_AFFINE_ONE / 2};
+    return m;
+}
+
+// 3点の対応（raw[i] → scr[i]）から行列を求める。3点が一直線上なら false
+inline bool touch_affine_solve(const int32_t raw[3][2], const int32_t scr[3][2], TouchAffine* out) {
+    double x0 = raw[0][0], y0 = raw[0][1];
+    double x1 = raw[1][0], y1 = raw[1][1];
+    double x2 = raw[2][0], y2 = raw[2][1];
+    double det = x0 * (y1 - y2) - y0 * (x1 - x2) + (x1 * y2 - x2 * y1);
+    if (fabs(det) < 1.0) return false;
+
+    double coef[2][3];
+    for (int k = 0; k < 2; ++k) {
+        double s0 = scr[0][k], s1 = scr[1][k], s2 = scr[2][k];
+        coef[k][0] = (s0 * (y1 - y2) - y0 * (s1 - s2) + (s1 * y2 - s2 * y1)) / det;
+        coef[k][1] = (x0 * (s1 - s2) - s0 * (x1 - x2) + (x1 * s2 - x2 * s1)) / det;
+        coef[k][2] = (x0 * (y1 * s2 - y2 * s1) - y0 * (x1 * s2 - x2 * s1) + s0 * (x1 * y2 - x2 * y1)) / det;
+    }
+    // Q16 で int32 に収まらない係数は誤タッチとみなす
+    for (int k = 0; k < 2; ++k)
+        for (int i = 0; i < 2; ++i)
+            if (fabs(coef[k][i]) > 4.0) return false;
+
+    out->a = (int32_t)lround(coef[0][0] * TOUCH_AFFINE_ONE);
+    out->b = (int32_t)lround(coef[0][1] * TOUCH_AFFINE_ONE);
+    out->c = (int32_t)lround(coef[0][2] * TOUCH_AFFINE_ONE) + TOUCH_AFFINE_ONE / 2;
+    out->d = (int32_t)lround(coef[1][0] * TOUCH_AFFINE_ONE);
+    out->e = (int32_t)lround(coef[1][1] * TOUCH_AFFINE_ONE);
+    out->f = (int32_t)lround(coef[1][2] * TOUCH_AFFINE_ONE) + TOUCH_AFFINE_ONE / 2;
+    return true;
+}
+
+// 行列の向き（軸の入れ替えと各軸の符号）を 0..7 で返す。ビルドごとに画面の向きが違っても
+// 同じ向きの保存分だけを使うよう、NVS のキーに含める
+inline uint8_t touch_affine_orient(const TouchAffine& m) {
+    const bool swap = (m.b < 0 ? -m.b : m.b) > (m.a < 0 ? -m.a : m.a);
+    const int32_t kx = swap ? m.b : m.a;
+    const int32_t ky = swap ? m.d : m.e;
+    return (uint8_t)((swap ? 4 : 0) | (kx < 0 ? 2 : 0) | (ky < 0 ? 1 : 0));
+}
+
+#ifdef ARDUINO
+// NVS（Preferences "touchcal"）への保存/読み出し。向き（touch_affine_orient）ごとに別のキーに置く。
+// load は *m に入っている既定行列と同じ向きの保存分を読み、無ければ false（*m はそのまま）
+bool touch_calib_load(TouchAffine* m);
+bool touch_calib_save(const TouchAffine& m);
+void touch_calib_clear();
+#endif
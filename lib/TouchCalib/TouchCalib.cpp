@@ -0,0 +1,50 @@
+#ifdef ARDUINO
+#include <Preferences.h>
+#include "TouchAffine.h"
+
+static const char* kNamespace = "touchcal";
+static const uint32_t kMagic = 0x54434131;  // "TCA1"
+
+struct StoredAffine {
+    uint32_t magic;
+    TouchAffine m;
+};
+
+// "m0".."m7"。向きの違うビルド（adagfx の TOUCH_ROTATE_180 など）の結果を取り違えない
+static void orient_key(const TouchAffine& m, char key[3]) {
+    key[0] = 'm';
+    key[1] = (char)('0' + touch_affine_orient(m));
+    key[2] = '\0';
+}
+
+bool touch_calib_load(TouchAffine* m) {
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, true)) return false;
+    char key[3];
+    orient_key(*m, key);
+    StoredAffine s;
+    size_t n = prefs.getBytes(key, &s, sizeof(s));
+    prefs.end();
+    if (n != sizeof(s) || s.magic != kMagic || touch_affine_orient(s.m) != touch_affine_orient(*m)) return false;
+    *m = s.m;
+    return true;
+}
+
+bool touch_calib_save(const TouchAffine& m) {
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, false)) return false;
+    char key[3];
+    orient_key(m, key);
+    StoredAffine s = {kMagic, m};
+    size_t n = prefs.putBytes(key, &s, sizeof(s));
+    prefs.end();
+    return n == sizeof(s);
+}
+
+void touch_calib_clear() {
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, false)) return;
+    prefs.clear();
+    prefs.end();
+}
+#endif
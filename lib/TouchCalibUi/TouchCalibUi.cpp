@@ -0,0 +1,126 @@
+#include <lvgl.h>
+#include "TouchCalibUi.h"
+
+namespace {
+
+constexpr uint8_t kPoints = 3;
+constexpr uint8_t kMinSamples = 4;   // これ未満の押下は誤タッチとして捨てる
+
+struct CalibState {
+    bool active;
+    TouchAffine* target;
+    lv_obj_t* scr;
+    lv_obj_t* prev_scr;
+    lv_obj_t* cross;
+    lv_obj_t* msg;
+    lv_timer_t* timer;
+    uint8_t step;          // 取得済みの点数
+    bool captured;         // feed() が1点取り終えた（timer で画面を進める）
+    bool released;         // start() 後に一度離された（起動時から押されたままの分は数えない）
+    uint32_t sum_x, sum_y, cnt;
+    int32_t raw[kPoints][2];
+    int32_t scr_pt[kPoints][2];
+};
+
+CalibState s;
+
+void place_cross() {
+    lv_obj_set_pos(s.cross, s.scr_pt[s.step][0] - 10, s.scr_pt[s.step][1] - 10);
+    lv_label_set_text_fmt(s.msg, "Touch the cross (%u/%u)", (unsigned)(s.step + 1), (unsigned)kPoints);
+}
+
+void finish(lv_timer_t* t) {
+    lv_disp_load_scr(s.prev_scr);
+    lv_obj_del(s.scr);
+    s.scr = nullptr;
+    lv_timer_del(t);
+}
+
+void on_timer(lv_timer_t* t) {
+    if (!s.captured) return;
+    s.captured = false;
+    if (++s.step < kPoints) { place_cross(); return; }
+
+    TouchAffine m;
+    if (!touch_affine_solve(s.raw, s.scr_pt, &m)) {
+        s.step = 0;
+        lv_label_set_text(s.msg, "Calibration failed, retry");
+        place_cross();
+        return;
+    }
+    *s.target = m;
+#ifdef ARDUINO
+    touch_calib_save(m);
+#endif
+    s.active = false;
+    lv_obj_add_flag(s.cross, LV_OBJ_FLAG_HIDDEN);
+    lv_label_set_text(s.msg, "Calibration saved");
+    lv_timer_set_cb(t, finish);
+    lv_timer_set_period(t, 800);
+}
+
+lv_obj_t* make_bar(lv_obj_t* parent, lv_coord_t x, lv_coord_t y, lv_coord_t w, lv_coord_t h) {
+    lv_obj_t* bar = lv_obj_create(parent);
+    lv_obj_remove_style_all(bar);
+    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(bar, lv_color_white(), 0);
+    lv_obj_set_pos(bar, x, y);
+    lv_obj_set_size(bar, w, h);
+    return bar;
+}
+
+}  // namespace
+
+void touch_calib_ui_start(TouchAffine* target) {
+    if (s.active || s.scr) return;
+    lv_coord_t w = lv_disp_get_hor_res(nullptr);
+    lv_coord_t h = lv_disp_get_ver_res(nullptr);
+
+    s = CalibState{};
+    s.active = true;
+    s.target = target;
+    s.prev_scr = lv_scr_act();
+    // 3点は画面の端寄りで、一直線にならない配置にする
+    const int32_t pts[kPoints][2] = {{w / 10, h / 10}, {w * 9 / 10, h / 2}, {w / 2, h * 9 / 10}};
+    for (uint8_t i = 0; i < kPoints; ++i) { s.scr_pt[i][0] = pts[i][0]; s.scr_pt[i][1] = pts[i][1]; }
+
+    s.scr = lv_obj_create(nullptr);
+    lv_obj_set_style_bg_color(s.scr, lv_color_black(), 0);
+    lv_obj_clear_flag(s.scr, LV_OBJ_FLAG_SCROLLABLE);
+
+    s.msg = lv_label_create(s.scr);
+    lv_obj_set_style_text_color(s.msg, lv_color_white(), 0);
+    lv_obj_center(s.msg);
+
+    s.cross = lv_obj_create(s.scr);
+    lv_obj_remove_style_all(s.cross);
+    lv_obj_set_size(s.cross, 21, 21);
+    make_bar(s.cross, 0, 10, 21, 1);
+    make_bar(s.cross, 10, 0, 1, 21);
+
+    place_cross();
+    lv_disp_load_scr(s.scr);
+    s.timer = lv_timer_create(on_timer, 30, nullptr);
+}
+
+bool touch_calib_ui_active() {
+    return s.active;
+}
+
+void touch_calib_ui_feed(bool pressed, uint16_t rx, uint16_t ry) {
+    if (!s.active || s.captured) return;
+    if (!s.released) {
+        s.released = !pressed;
+        return;
+    }
+    if (pressed) {
+        s.sum_x += rx; s.sum_y += ry; s.cnt++;
+        return;
+    }
+    if (s.cnt >= kMinSamples) {
+        s.raw[s.step][0] = (int32_t)(s.sum_x / s.cnt);
+        s.raw[s.step][1] = (int32_t)(s.sum_y / s.cnt);
+        s.captured = true;
+    }
+    s.sum_x = s.sum_y = s.cnt = 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// LVGL 上の3点キャリブレーション画面。
+// 開始後は read_cb で取得した生座標を touch_calib_ui_feed() に渡し、
+// touch_calib_ui_active() の間は LVGL へは「離した」を返す。開始時に押されていた分は、一度離すまで捨てる。
+// 完了すると行列を *target に反映して NVS に保存し、元の画面へ戻る。
+
+#include <stdint.h>
+#include "TouchAffine.h"
+
+void touch_calib_ui_start(TouchAffine* target);
+bool touch_calib_ui_active();
+void touch_calib_ui_feed(bool pressed, uint16_t rx, uint16_t ry);
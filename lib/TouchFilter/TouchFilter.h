@@ -0,0 +1,195 @@
+#pragma once
+
+// タッチ座標フィルタ（ヘッダオンリー）
+// 各段を TouchFilterChain<...> に並べてコンパイル時に構成する。空の TouchFilterChain<> は何もしない。
+// Arduino に依存しないので、ホスト側でも同じコードでトレースを再生できる。
+
+#include <stdint.h>
+#include <math.h>
+
+#ifndef TOUCH_FILTER_ENABLE
+#define TOUCH_FILTER_ENABLE 0
+#endif
+
+struct TouchPoint {
+    int16_t  x;
+    int16_t  y;
+    bool     pressed;
+    uint32_t t_ms;
+};
+
+template <typename... Stages> class TouchFilterChain;
+
+template <> class TouchFilterChain<> {
+public:
+    void reset() {}
+    void process(TouchPoint&) {}
+};
+
+template <typename Head, typename... Tail>
+class TouchFilterChain<Head, Tail...> {
+public:
+    void reset() { _head.reset(); _tail.reset(); }
+    void process(TouchPoint& p) { _head.process(p); _tail.process(p); }
+
+private:
+    Head _head;
+    TouchFilterChain<Tail...> _tail;
+};
+
+namespace touch_filter {
+
+// 押下/離しをそれぞれ N 回連続で確定させる。離し確定待ちの間は最後の座標を保持する
+template <uint8_t PressN, uint8_t ReleaseN>
+class Debounce {
+public:
+    void reset() { _state = false; _press_cnt = 0; _release_cnt = 0; }
+    void process(TouchPoint& p) {
+        if (p.pressed) {
+            _release_cnt = 0;
+            if (_press_cnt < PressN) ++_press_cnt;
+            if (_press_cnt >= PressN) _state = true;
+            if (_state) { _x = p.x; _y = p.y; }
+        } else {
+            _press_cnt = 0;
+            if (_release_cnt < ReleaseN) ++_release_cnt;
+            if (_release_cnt >= ReleaseN) _state = false;
+            if (_state) { p.x = _x; p.y = _y; }
+        }
+        p.pressed = _state;
+    }
+
+private:
+    bool _state = false;
+    uint8_t _press_cnt = 0, _release_cnt = 0;
+    int16_t _x = 0, _y = 0;
+};
+
+// 前回出力から R px 以内の動きは捨てる（平滑化はしないので遅延は増えない）
+template <uint8_t R>
+class Deadzone {
+public:
+    void reset() { _active = false; }
+    void process(TouchPoint& p) {
+        if (!p.pressed) { _active = false; return; }
+        if (_active) {
+            int dx = p.x - _x, dy = p.y - _y;
+            if (dx <= R && dx >= -R && dy <= R && dy >= -R) { p.x = _x; p.y = _y; return; }
+        }
+        _active = true; _x = p.x; _y = p.y;
+    }
+
+private:
+    bool _active = false;
+    int16_t _x = 0, _y = 0;
+};
+
+// 固定係数の指数移動平均（旧 TOUCH_FILTER_ENABLE の (f*3+s)/4 は WeightQ8=64）
+template <uint8_t WeightQ8>
+class Ema {
+public:
+    void reset() { _active = false; }
+    void process(TouchPoint& p) {
+        if (!p.pressed) { _active = false; return; }
+        if (!_active) { _active = true; _fx = p.x << 8; _fy = p.y << 8; }
+        else {
+            _fx += ((int32_t)(p.x << 8) - _fx) * WeightQ8 / 256;
+            _fy += ((int32_t)(p.y << 8) - _fy) * WeightQ8 / 256;
+        }
+        p.x = (int16_t)((_fx + 128) >> 8);
+        p.y = (int16_t)((_fy + 128) >> 8);
+    }
+
+private:
+    bool _active = false;
+    int32_t _fx = 0, _fy = 0;
+};
+
+// 1€ Filter（Casiez et al.）: 低速時は強く、高速時は弱く平滑化する
+// 係数はテンプレート引数に浮動小数を使えないため 1/1000 単位（MinCutoff=1000 → 1.0Hz）
+template <uint16_t MinCutoffMilliHz, uint16_t BetaMilli, uint16_t DCutoffMilliHz = 1000>
+class OneEuro {
+public:
+    void reset() { _active = false; }
+    void process(TouchPoint& p) {
+        if (!p.pressed) { _active = false; return; }
+        if (!_active) {
+            _active = true; _t = p.t_ms;
+            _ax.init(p.x); _ay.init(p.y);
+            return;
+        }
+        float dt = (p.t_ms - _t) * 0.001f;
+        _t = p.t_ms;
+        if (dt <= 0.0f) dt = 0.001f;
+        p.x = (int16_t)lroundf(_ax.step(p.x, dt));
+        p.y = (int16_t)lroundf(_ay.step(p.y, dt));
+    }
+
+private:
+    static float alpha(float cutoff, float dt) {
+        float tau = 1.0f / (2.0f * (float)M_PI * cutoff);
+        return 1.0f / (1.0f + tau / dt);
+    }
+    struct Axis {
+        float x = 0.0f, dx = 0.0f;
+        void init(float v) { x = v; dx = 0.0f; }
+        float step(float v, float dt) {
+            float d = (v - x) / dt;
+            float ad = alpha(DCutoffMilliHz * 0.001f, dt);
+            dx += ad * (d - dx);
+            float cutoff = MinCutoffMilliHz * 0.001f + BetaMilli * 0.001f * fabsf(dx);
+            x += alpha(cutoff, dt) * (v - x);
+            return x;
+        }
+    };
+    bool _active = false;
+    uint32_t _t = 0;
+    Axis _ax, _ay;
+};
+
+// α-β フィルタ + 速度による先読み（PredictMs 先の位置を出力して描画遅延を打ち消す）
+template <uint8_t AlphaQ8, uint8_t BetaQ8, uint8_t PredictMs = 0>
+class AlphaBeta {
+public:
+    void reset() { _active = false; }
+    void process(TouchPoint& p) {
+        if (!p.pressed) { _active = false; return; }
+        if (!_active) {
+            _active = true; _t = p.t_ms;
+            _ax.init(p.x); _ay.init(p.y);
+            return;
+        }
+        float dt = (float)(p.t_ms - _t);
+        _t = p.t_ms;
+        if (dt <= 0.0f) dt = 1.0f;
+        p.x = (int16_t)lroundf(_ax.step(p.x, dt));
+        p.y = (int16_t)lroundf(_ay.step(p.y, dt));
+    }
+
+private:
+    struct Axis {
+        float x = 0.0f, v = 0.0f;  // 位置[px], 速度[px/ms]
+        void init(float m) { x = m; v = 0.0f; }
+        float step(float m, float dt) {
+            float xp = x + v * dt;
+            float r = m - xp;
+            x = xp + (AlphaQ8 / 256.0f) * r;
+            v += (BetaQ8 / 256.0f) * r / dt;
+            return x + v * PredictMs;
+        }
+    };
+    bool _active = false;
+    uint32_t _t = 0;
+    Axis _ax, _ay;
+};
+
+}  // namespace touch_filter
+
+// 全ビルド共通の既定構成（-D TOUCH_FILTER_ENABLE=1 で有効）。構成を変えたいビルドだけ main.cpp で別の型を使う
+#if TOUCH_FILTER_ENABLE
+using TouchFilterDefault = TouchFilterChain<touch_filter::Debounce<1, 2>,
+                                            touch_filter::Deadzone<2>,
+                                            touch_filter::OneEuro<1000, 50>>;
+#else
+using TouchFilterDefault = TouchFilterChain<>;
+#endif
@@ -0,0 +1,99 @@
+#include <math.h>
+#include <stdlib.h>
+#include "TouchGesture.h"
+
+bool TouchGesture::update(const TouchPoint& p, TouchGestureEvent* ev) {
+    if (p.pressed) {
+        if (!_down) {
+            _down = true;
+            _moved = false;
+            _long_sent = false;
+            _sx = p.x; _sy = p.y;
+            _t_down = p.t_ms;
+            _count = 0;
+            _vx = _vy = 0.0f;
+        }
+        _hist[_head] = p;
+        _head = (_head + 1) % kHistory;
+        if (_count < kHistory) ++_count;
+        estimate_velocity();
+
+        int dx = p.x - _sx, dy = p.y - _sy;
+        if (dx * dx + dy * dy > _cfg.tap_slop_px * _cfg.tap_slop_px) _moved = true;
+        if (!_moved && !_long_sent && p.t_ms - _t_down >= _cfg.long_press_ms) {
+            _long_sent = true;
+            return emit(TouchGestureType::LongPress, ev);
+        }
+        return false;
+    }
+
+    if (!_down) return false;
+    _down = false;
+    if (_long_sent) return false;
+
+    const TouchPoint& last = _hist[(_head + kHistory - 1) % kHistory];
+    if (!_moved) {
+        if (last.t_ms - _t_down > _cfg.tap_max_ms) return false;
+        int dx = last.x - _last_tap_x, dy = last.y - _last_tap_y;
+        bool dbl = _have_tap && _t_down - _last_tap_ms <= _cfg.double_tap_gap_ms &&
+                   dx * dx + dy * dy <= 4 * _cfg.tap_slop_px * _cfg.tap_slop_px;
+        _have_tap = !dbl;
+        _last_tap_ms = p.t_ms;
+        _last_tap_x = last.x; _last_tap_y = last.y;
+        return emit(dbl ? TouchGestureType::DoubleTap : TouchGestureType::Tap, ev);
+    }
+
+    int dx = last.x - _sx, dy = last.y - _sy;
+    float speed = sqrtf(_vx * _vx + _vy * _vy);
+    int dist2 = dx * dx + dy * dy;
+    if (dist2 < _cfg.swipe_min_px * _cfg.swipe_min_px && speed < _cfg.swipe_min_speed) return false;
+    if (abs(dx) >= abs(dy)) return emit(dx < 0 ? TouchGestureType::SwipeLeft : TouchGestureType::SwipeRight, ev);
+    return emit(dy < 0 ? TouchGestureType::SwipeUp : TouchGestureType::SwipeDown, ev);
+}
+
+// 直近 kVelocityWindowMs 内のサンプルに直線を当てはめて速度を求める（最小二乗）
+void TouchGesture::estimate_velocity() {
+    const TouchPoint& last = _hist[(_head + kHistory - 1) % kHistory];
+    float st = 0, sx = 0, sy = 0, stt = 0, stx = 0, sty = 0;
+    int n = 0;
+    for (uint8_t i = 0; i < _count; ++i) {
+        const TouchPoint& q = _hist[(_head + kHistory - 1 - i) % kHistory];
+        uint32_t age = last.t_ms - q.t_ms;
+        if (age > kVelocityWindowMs) break;
+        float t = -(float)age * 0.001f;
+        st += t; sx += q.x; sy += q.y;
+        stt += t * t; stx += t * q.x; sty += t * q.y;
+        ++n;
+    }
+    float den = n * stt - st * st;
+    if (n < 2 || den <= 0.0f) { _vx = _vy = 0.0f; return; }
+    _vx = (n * stx - st * sx) / den;
+    _vy = (n * sty - st * sy) / den;
+}
+
+bool TouchGesture::emit(TouchGestureType type, TouchGestureEvent* ev) {
+    const TouchPoint& last = _hist[(_head + kHistory - 1) % kHistory];
+    ev->type = type;
+    ev->x = last.x; ev->y = last.y;
+    ev->start_x = _sx; ev->start_y = _sy;
+    ev->vx = _vx; ev->vy = _vy;
+    return true;
+}
+
+void TouchGesture::predict(uint16_t dt_ms, int16_t* x, int16_t* y) const {
+    const TouchPoint& last = _hist[(_head + kHistory - 1) % kHistory];
+    *x = (int16_t)lroundf(last.x + _vx * dt_ms * 0.001f);
+    *y = (int16_t)lroundf(last.y + _vy * dt_ms * 0.001f);
+}
+
+int32_t KineticScroller::step(uint32_t dt_ms) {
+    if (_v == 0.0f) return 0;
+    float dt = dt_ms * 0.001f;
+    float decay = expf(-dt / _tau);
+    float d = _v * _tau * (1.0f - decay) + _residual;
+    _v *= decay;
+    if (fabsf(_v) < _stop) _v = 0.0f;
+    int32_t out = (int32_t)d;
+    _residual = d - out;
+    return out;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// 点列（画面座標）からのソフトウェアジェスチャ認識と、フリック後の慣性スクロール。
+// CST820 のハードウェアジェスチャは機種/設定で出方が違うため使わない。
+// Arduino に依存しないので、合成トレースでホスト上でも動かせる。
+
+#include <stdint.h>
+#include "TouchFilter.h"
+
+enum class TouchGestureType : uint8_t {
+    None = 0,
+    Tap,          // 押して短時間で離した（DoubleTap の1回目でも通知する）
+    DoubleTap,
+    LongPress,    // 押したまま動かずに long_press_ms 経過（押下中に1回通知）
+    SwipeLeft,
+    SwipeRight,
+    SwipeUp,
+    SwipeDown,
+};
+
+struct TouchGestureEvent {
+    TouchGestureType type;
+    int16_t x, y;               // 確定時の位置
+    int16_t start_x, start_y;   // 押し始めの位置
+    float vx, vy;               // 離した瞬間の速度 [px/s]（フリック速度）
+};
+
+struct TouchGestureConfig {
+    uint16_t tap_max_ms        = 250;
+    uint8_t  tap_slop_px       = 10;   // これ以内の移動は「動いていない」
+    uint16_t double_tap_gap_ms = 300;
+    uint16_t long_press_ms     = 600;
+    uint16_t swipe_min_px      = 40;
+    uint16_t swipe_min_speed   = 300;  // [px/s]
+};
+
+class TouchGesture {
+public:
+    explicit TouchGesture(const TouchGestureConfig& cfg = TouchGestureConfig()) : _cfg(cfg) {}
+
+    // サンプル毎に呼ぶ。ジェスチャが確定したら true を返し *ev に入れる
+    bool update(const TouchPoint& p, TouchGestureEvent* ev);
+
+    bool pressed() const { return _down; }
+    float vx() const { return _vx; }
+    float vy() const { return _vy; }
+    // 現在の速度から dt_ms 先の指の位置を予測する（押下中のみ意味がある）
+    void predict(uint16_t dt_ms, int16_t* x, int16_t* y) const;
+
+private:
+    static constexpr uint8_t kHistory = 8;
+    static constexpr uint16_t kVelocityWindowMs = 80;
+
+    void estimate_velocity();
+    bool emit(TouchGestureType type, TouchGestureEvent* ev);
+
+    TouchGestureConfig _cfg;
+    TouchPoint _hist[kHistory] = {};
+    uint8_t _head = 0, _count = 0;
+    bool _down = false;
+    bool _moved = false;
+    bool _long_sent = false;
+    int16_t _sx = 0, _sy = 0;
+    uint32_t _t_down = 0;
+    uint32_t _last_tap_ms = 0;
+    int16_t _last_tap_x = 0, _last_tap_y = 0;
+    bool _have_tap = false;
+    float _vx = 0.0f, _vy = 0.0f;
+};
+
+// フリック速度から、指数減衰する慣性スクロールの移動量を作る
+class KineticScroller {
+public:
+    explicit KineticScroller(uint16_t tau_ms = 325, uint16_t stop_speed = 20) : _tau(tau_ms * 0.001f), _stop(stop_speed) {}
+
+    void fling(float v) { _v = v; _residual = 0.0f; }
+    void stop() { _v = 0.0f; _residual = 0.0f; }
+    bool active() const { return _v != 0.0f; }
+    // dt_ms 経過分の移動量 [px] を返す（小数部は次回に繰り越す）
+    int32_t step(uint32_t dt_ms);
+
+private:
+    float _tau;
+    uint16_t _stop;
+    float _v = 0.0f;
+    float _residual = 0.0f;
+};
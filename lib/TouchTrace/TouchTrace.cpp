@@ -0,0 +1,174 @@
+#ifdef ARDUINO
+#include "TouchTrace.h"
+
+bool TouchTraceRecorder::begin(SdService& sd, const char* path) {
+    if (_sd) return true;
+    if (strlen(path) >= sizeof(_path)) return false;
+
+    _start_ms = _submit_ms = millis();
+    TouchTraceHeader h;
+    touch_trace_init_header(&h, _start_ms);
+    SdFuture fut;
+    if (!sd.submit(SdPrio::Low, SdOp::Write, path, 0, reinterpret_cast<uint8_t*>(&h), sizeof(h),
+                   nullptr, nullptr, &fut, 100) || !fut.wait() || !fut.result().ok) return false;
+
+    strcpy(_path, path);
+    for (uint8_t i = 0; i < 2; ++i) _chunk[i] = Chunk{this, i};
+    _sd = &sd;
+    return true;
+}
+
+void TouchTraceRecorder::end() {
+    if (!_sd) return;
+    submit(millis());
+    _sd = nullptr;   // 積んだ追記は SDタスクがそのまま書き終える
+}
+
+void TouchTraceRecorder::push(uint32_t now_ms, uint16_t x, uint16_t y, uint8_t gesture, bool finger) {
+    if (!_sd) return;
+    if (now_ms - _submit_ms >= TOUCH_TRACE_FLUSH_MS) submit(now_ms);
+    if (!finger && !_last_finger) return;  // 離しっぱなしは記録しない
+    _last_finger = finger;
+
+    if (_busy[_cur]) { ++_dropped; return; }
+    TouchTraceSample s = {now_ms - _start_ms, x, y, gesture, finger};
+    _buf[_cur][_len[_cur]++] = touch_trace_encode(s);
+    ++_recorded;
+    if (_len[_cur] == kRecords) submit(now_ms);
+}
+
+void TouchTraceRecorder::submit(uint32_t now_ms) {
+    const uint8_t idx = _cur;
+    _submit_ms = now_ms;
+    if (_len[idx] == 0 || _busy[idx]) return;
+    _busy[idx] = true;
+    if (!_sd->submit(SdPrio::Low, SdOp::Append, _path, 0, reinterpret_cast<uint8_t*>(_buf[idx]),
+                     _len[idx] * sizeof(TouchTraceRecord), on_written, &_chunk[idx])) {
+        // キュー満杯: このバッファは捨てて使い回す
+        _dropped += _len[idx];
+        _len[idx] = 0;
+        _busy[idx] = false;
+        return;
+    }
+    _cur ^= 1;  // 書き込み中なら push() 側で破棄する（_len は完了時に空にする）
+}
+
+// SDタスク上で呼ばれる
+void TouchTraceRecorder::on_written(const SdResult& res, void* user) {
+    Chunk* c = static_cast<Chunk*>(user);
+    if (!res.ok) ++c->self->_write_errors;
+    c->self->_len[c->idx] = 0;
+    c->self->_busy[c->idx] = false;
+}
+
+bool TouchTracePlayer::begin(SdService& sd, const char* path, bool loop) {
+    if (strlen(path) >= sizeof(_path)) return false;
+    TouchTraceHeader h;
+    SdFuture fut;
+    if (!sd.submit(SdPrio::High, SdOp::Read, path, 0, reinterpret_cast<uint8_t*>(&h), sizeof(h),
+                   nullptr, nullptr, &fut, 100) || !fut.wait() ||
+        fut.result().bytes != (int32_t)sizeof(h) || !touch_trace_check_header(&h)) return false;
+
+    strcpy(_path, path);
+    for (Slot& s : _slot) {
+        s.self = this;
+        s.state = kEmpty;
+    }
+    _sd = &sd;
+    _loop = loop;
+    _started = false;
+    _have_next = false;
+    _cur = TouchTraceSample{};
+    rewind();
+    return true;
+}
+
+void TouchTracePlayer::load(Slot& s) {
+    s.state = kLoading;   // 完了は submit() から戻る前に来ることがある
+    if (!_sd->submit(SdPrio::High, SdOp::Read, _path, s.offset, reinterpret_cast<uint8_t*>(s.rec),
+                     sizeof(s.rec), on_read, &s)) {
+        s.state = kEmpty;  // キュー満杯: 次の fetch() で積み直す
+    }
+}
+
+// SDタスク上で呼ばれる
+void TouchTracePlayer::on_read(const SdResult& res, void* user) {
+    Slot* s = static_cast<Slot*>(user);
+    s->len = res.ok ? (size_t)res.bytes / sizeof(TouchTraceRecord) : 0;
+    s->state = kReady;
+}
+
+// 先頭から読み直す。先読みがまだ返っていなければ false（次の呼び出しでやり直す）
+bool TouchTracePlayer::rewind() {
+    for (Slot& s : _slot) if (s.state == kLoading) return false;
+    _next_off = sizeof(TouchTraceHeader);
+    for (Slot& s : _slot) {
+        s.offset = _next_off;
+        _next_off += sizeof(s.rec);
+        load(s);
+    }
+    _cur_slot = 0;
+    _pos = 0;
+    return true;
+}
+
+TouchTracePlayer::Fetch TouchTracePlayer::fetch(TouchTraceSample* s) {
+    for (uint8_t i = 0; i < 2; ++i) {
+        Slot& c = _slot[_cur_slot];
+        if (c.state == kDone) return Fetch::End;
+        if (c.state == kEmpty) load(c);
+        if (c.state != kReady) return Fetch::Wait;
+        if (_pos < c.len) {
+            *s = touch_trace_decode(c.rec[_pos++]);
+            return Fetch::Ok;
+        }
+        // 読み切った。満杯でなければ末尾、そうでなければ次の区間を先読みして隣へ移る
+        if (c.len < kRecords) {
+            c.state = kDone;
+            return Fetch::End;
+        }
+        c.offset = _next_off;
+        _next_off += sizeof(c.rec);
+        load(c);
+        _cur_slot ^= 1;
+        _pos = 0;
+    }
+    return Fetch::Wait;
+}
+
+bool TouchTracePlayer::getTouch(uint32_t now_ms, uint16_t* x, uint16_t* y, uint8_t* gesture) {
+    if (!_sd) return false;
+    Fetch f = Fetch::Ok;
+    if (!_started) {
+        // 先頭のレコードが届くまでは離した状態のまま
+        f = fetch(&_next);
+        if (f != Fetch::Wait) {
+            _started = true;
+            _cur = TouchTraceSample{};
+            _have_next = f == Fetch::Ok;
+            _base_ms = _have_next ? now_ms - _next.t_ms : now_ms;
+        }
+    }
+    // now_ms までに到達したレコードを進める
+    while (_started) {
+        if (!_have_next) {
+            f = fetch(&_next);
+            if (f != Fetch::Ok) break;
+            _have_next = true;
+        }
+        if (_next.t_ms > now_ms - _base_ms) break;
+        _cur = _next;
+        _have_next = false;
+    }
+    if (f == Fetch::End) {
+        // 末尾に達したら離した状態で終える
+        _cur.finger = false;
+        if (!_loop) _sd = nullptr;
+        else if (rewind()) _started = false;
+    }
+    *x = _cur.x;
+    *y = _cur.y;
+    *gesture = _cur.gesture;
+    return _cur.finger;
+}
+#endif
@@ -0,0 +1,156 @@
+#pragma once
+
+// タッチトレースのバイナリ形式（*.ctt）
+//   ヘッダ 16B + レコード 8B の並び。レコードは CST820 の生値（パネル座標）をそのまま持つ。
+//   連続する「離した」サンプルは先頭の1件だけ記録する。
+// この定義は Arduino 非依存なので、ホスト側ツールからもそのまま読める。
+
+#include <stdint.h>
+#include <string.h>
+
+#define TOUCH_TRACE_MAGIC   "CTT1"
+#define TOUCH_TRACE_VERSION 1
+
+struct TouchTraceHeader {
+    char     magic[4];      // "CTT1"
+    uint16_t version;
+    uint16_t record_size;   // sizeof(TouchTraceRecord)
+    uint32_t start_ms;      // 記録開始時の millis()
+    uint32_t reserved;
+};
+
+struct TouchTraceRecord {
+    uint32_t t_ms;          // start_ms からの経過時間
+    uint32_t packed;        // x:12 | y:12 | gesture:7 | finger:1
+};
+
+static_assert(sizeof(TouchTraceHeader) == 16, "TouchTraceHeader layout");
+static_assert(sizeof(TouchTraceRecord) == 8, "TouchTraceRecord layout");
+
+struct TouchTraceSample {
+    uint32_t t_ms;
+    uint16_t x, y;
+    uint8_t  gesture;
+    bool     finger;
+};
+
+inline void touch_trace_init_header(TouchTraceHeader* h, uint32_t start_ms) {
+    memcpy(h->magic, TOUCH_TRACE_MAGIC, 4);
+    h->version = TOUCH_TRACE_VERSION;
+    h->record_size = sizeof(TouchTraceRecord);
+    h->start_ms = start_ms;
+    h->reserved = 0;
+}
+
+inline bool touch_trace_check_header(const TouchTraceHeader* h) {
+    return memcmp(h->magic, TOUCH_TRACE_MAGIC, 4) == 0 &&
+           h->version == TOUCH_TRACE_VERSION &&
+           h->record_size == sizeof(TouchTraceRecord);
+}
+
+inline TouchTraceRecord touch_trace_encode(const TouchTraceSample& s) {
+    TouchTraceRecord r;
+    r.t_ms = s.t_ms;
+    r.packed = (uint32_t)(s.x & 0x0FFF) |
+               ((uint32_t)(s.y & 0x0FFF) << 12) |
+               ((uint32_t)(s.gesture & 0x7F) << 24) |
+               ((uint32_t)(s.finger ? 1 : 0) << 31);
+    return r;
+}
+
+inline TouchTraceSample touch_trace_decode(const TouchTraceRecord& r) {
+    TouchTraceSample s;
+    s.t_ms = r.t_ms;
+    s.x = r.packed & 0x0FFF;
+    s.y = (r.packed >> 12) & 0x0FFF;
+    s.gesture = (r.packed >> 24) & 0x7F;
+    s.finger = (r.packed >> 31) != 0;
+    return s;
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "SdService.h"
+
+// 満杯でなくてもこの間隔で端数を追記する [ms]（電源断で失うのはこの分まで）
+#ifndef TOUCH_TRACE_FLUSH_MS
+#define TOUCH_TRACE_FLUSH_MS 1000
+#endif
+
+// 生サンプルをRAMにためて、満杯になったバッファ単位か TOUCH_TRACE_FLUSH_MS ごとに SdService に追記を頼む
+// （SD には直接触らない）。push() はUIスレッドから呼ばれ、SDの書き込み完了を待たない。
+class TouchTraceRecorder {
+public:
+    // ヘッダの書き込みまでは待つ（sd.begin() の後、setup() から呼ぶ）
+    bool begin(SdService& sd, const char* path);
+    // 端数を追記して記録を止める（シリアルの "trace stop"）
+    void end();
+    // read_cb から毎回（離している間も）呼ぶ。時間での追記もここで行う
+    void push(uint32_t now_ms, uint16_t x, uint16_t y, uint8_t gesture, bool finger);
+
+    bool active() const { return _sd != nullptr; }
+    uint32_t recorded() const { return _recorded; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t write_errors() const { return _write_errors; }
+
+private:
+    static constexpr size_t kRecords = 128;  // 1KB/バッファ x2
+    struct Chunk { TouchTraceRecorder* self; uint8_t idx; };
+    static void on_written(const SdResult& res, void* user);
+    void submit(uint32_t now_ms);
+
+    TouchTraceRecord _buf[2][kRecords];
+    size_t _len[2] = {0, 0};
+    volatile bool _busy[2] = {false, false};
+    Chunk _chunk[2];
+    uint8_t _cur = 0;
+    bool _last_finger = false;
+    uint32_t _start_ms = 0;
+    uint32_t _submit_ms = 0;   // 最後に追記を頼んだ時刻
+    uint32_t _recorded = 0;
+    uint32_t _dropped = 0;
+    volatile uint32_t _write_errors = 0;   // SDタスクが数える
+    SdService* _sd = nullptr;
+    char _path[SD_SERVICE_PATH_MAX] = "";
+};
+
+// *.ctt を記録時と同じ時間軸で再生する。getTouch() は CST820::getTouch() と同じ意味の値を返す。
+// 読み出しは SdService へ2面のバッファで先読みし、届いていなければ直前のサンプルを保つ（UIは待たせない）。
+class TouchTracePlayer {
+public:
+    // ヘッダの確認までは待つ（sd.begin() の後、setup() から呼ぶ）
+    bool begin(SdService& sd, const char* path, bool loop = false);
+    void end() { _sd = nullptr; }
+    bool active() const { return _sd != nullptr; }
+    bool getTouch(uint32_t now_ms, uint16_t* x, uint16_t* y, uint8_t* gesture);
+
+private:
+    enum class Fetch : uint8_t { Ok, Wait, End };
+    enum : uint8_t { kEmpty, kLoading, kReady, kDone };
+    static constexpr size_t kRecords = 64;
+    struct Slot {
+        TouchTracePlayer* self;
+        TouchTraceRecord rec[kRecords];
+        uint32_t offset;
+        volatile size_t len;
+        volatile uint8_t state;
+    };
+    static void on_read(const SdResult& res, void* user);
+    void load(Slot& s);
+    bool rewind();
+    Fetch fetch(TouchTraceSample* s);
+
+    Slot _slot[2];
+    uint8_t _cur_slot = 0;
+    size_t _pos = 0;
+    uint32_t _next_off = 0;
+    bool _loop = false;
+    bool _started = false;
+    bool _have_next = false;
+    uint32_t _base_ms = 0;
+    TouchTraceSample _cur = {};
+    TouchTraceSample _next = {};
+    SdService* _sd = nullptr;
+    char _path[SD_SERVICE_PATH_MAX] = "";
+};
+#endif
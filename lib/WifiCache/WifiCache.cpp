@@ -0,0 +1,79 @@
+#ifdef ARDUINO
+#include <Preferences.h>
+#include <WiFi.h>
+#include "WifiCache.h"
+
+static const char* kNamespace = "wificache";
+static const uint32_t kMagic = 0x57434331;  // "WCC1"
+
+struct StoredCache {
+    uint32_t magic;
+    WifiCacheEntry e;
+};
+
+bool wifi_cache_load(WifiCacheEntry* e) {
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, true)) return false;
+    StoredCache s;
+    size_t n = prefs.getBytes("e", &s, sizeof(s));
+    prefs.end();
+    if (n != sizeof(s) || s.magic != kMagic || s.e.ssid[0] == '\0') return false;
+    *e = s.e;
+    return true;
+}
+
+bool wifi_cache_save(const WifiCacheEntry& e) {
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, false)) return false;
+    StoredCache s = {kMagic, e};
+    // 内容が同じなら書かない（フラッシュの消耗を避ける）
+    StoredCache old;
+    if (prefs.getBytes("e", &old, sizeof(old)) == sizeof(old) && memcmp(&old, &s, sizeof(s)) == 0) {
+        prefs.end();
+        return true;
+    }
+    size_t n = prefs.putBytes("e", &s, sizeof(s));
+    prefs.end();
+    return n == sizeof(s);
+}
+
+void wifi_cache_clear() {
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, false)) return;
+    prefs.clear();
+    prefs.end();
+}
+
+bool wifi_cache_store_current(const char* ssid, const char* pass) {
+    WifiCacheEntry e;
+    memset(&e, 0, sizeof(e));
+    strncpy(e.ssid, ssid, sizeof(e.ssid) - 1);
+    strncpy(e.pass, pass, sizeof(e.pass) - 1);
+    const uint8_t* bssid = WiFi.BSSID();
+    if (!bssid) return false;
+    memcpy(e.bssid, bssid, sizeof(e.bssid));
+    e.channel = (uint8_t)WiFi.channel();
+    e.has_ip = 1;
+    e.ip = (uint32_t)WiFi.localIP();
+    e.gateway = (uint32_t)WiFi.gatewayIP();
+    e.mask = (uint32_t)WiFi.subnetMask();
+    e.dns = (uint32_t)WiFi.dnsIP();
+    return wifi_cache_save(e);
+}
+
+void wifi_begin_fast(const WifiCacheEntry& e) {
+    if (!(WiFi.getMode() & WIFI_MODE_STA)) WiFi.mode(WIFI_STA);
+#if WIFI_CACHE_STATIC_IP
+    if (e.has_ip) WiFi.config(IPAddress(e.ip), IPAddress(e.gateway), IPAddress(e.mask), IPAddress(e.dns));
+#endif
+    WiFi.begin(e.ssid, e.pass, e.channel, e.bssid, true);
+}
+
+void wifi_begin_full(const char* ssid, const char* pass) {
+    if (!(WiFi.getMode() & WIFI_MODE_STA)) WiFi.mode(WIFI_STA);
+    WiFi.disconnect();
+    // 固定 IP を外して DHCP に戻す
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    WiFi.begin(ssid, pass);
+}
+#endif
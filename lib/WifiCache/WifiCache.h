@@ -0,0 +1,36 @@
+#pragma once
+
+// 最後に接続できた AP の情報を NVS（"wificache"）に持ち、次回はスキャンせずに直接接続する。
+//   BSSID とチャネルを指定した WiFi.begin() はスキャンを省ける。
+//   WIFI_CACHE_STATIC_IP=1 なら前回の DHCP の結果を固定 IP として使い、DHCP も省く
+//   （アドレスの重複に注意。既定は DHCP のまま）。
+// 直接接続に失敗したら wifi_begin_full() で通常の接続（スキャン + DHCP）に戻す。
+
+#include <stdint.h>
+
+#ifndef WIFI_CACHE_STATIC_IP
+#define WIFI_CACHE_STATIC_IP 0
+#endif
+#ifndef WIFI_FAST_TIMEOUT_MS
+#define WIFI_FAST_TIMEOUT_MS 4000    // 直接接続をあきらめるまで
+#endif
+
+struct WifiCacheEntry {
+    char     ssid[33];
+    char     pass[65];
+    uint8_t  bssid[6];
+    uint8_t  channel;
+    uint8_t  has_ip;
+    uint32_t ip, gateway, mask, dns;
+};
+
+bool wifi_cache_load(WifiCacheEntry* e);
+bool wifi_cache_save(const WifiCacheEntry& e);
+void wifi_cache_clear();
+
+// 接続直後（WL_CONNECTED）に呼ぶ。現在の BSSID/チャネル/IP を保存する
+bool wifi_cache_store_current(const char* ssid, const char* pass);
+// キャッシュの AP へスキャンなしで接続を始める
+void wifi_begin_fast(const WifiCacheEntry& e);
+// DHCP に戻して通常の接続を始める
+void wifi_begin_full(const char* ssid, const char* pass);
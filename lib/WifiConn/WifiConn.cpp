@@ -0,0 +1,76 @@
+#ifdef ARDUINO
+#include <WiFi.h>
+#include "WifiCache.h"
+#include "WifiConn.h"
+
+QueueHandle_t WifiConn::s_queue = nullptr;
+
+WifiConnPolicy WifiConn::default_policy() {
+    WifiConnPolicy p;
+    p.fast_timeout_ms = WIFI_FAST_TIMEOUT_MS;
+    return p;
+}
+
+void WifiConn::begin() {
+    if (s_queue) return;
+    s_queue = xQueueCreate(8, sizeof(WifiConnEvent));
+    // 再接続は状態機械が行う
+    WiFi.setAutoReconnect(false);
+    WiFi.onEvent([](arduino_event_id_t id, arduino_event_info_t info) {
+        WifiConnEvent ev = {WifiConnEventType::Associated, 0, 0};
+        switch (id) {
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+            break;
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            ev.type = WifiConnEventType::GotIp;
+            ev.ip = info.got_ip.ip_info.ip.addr;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            ev.type = WifiConnEventType::Disconnected;
+            ev.reason = info.wifi_sta_disconnected.reason;
+            break;
+        default:
+            return;
+        }
+        xQueueSend(s_queue, &ev, 0);
+    });
+}
+
+void WifiConn::connect(const char* ssid, const char* pass) {
+    strncpy(_ssid, ssid, sizeof(_ssid) - 1);
+    _ssid[sizeof(_ssid) - 1] = '\0';
+    strncpy(_pass, pass, sizeof(_pass) - 1);
+    _pass[sizeof(_pass) - 1] = '\0';
+    // 前の接続のイベントは捨てる
+    if (s_queue) xQueueReset(s_queue);
+    _m.start(millis());
+}
+
+void WifiConn::poll() {
+    WifiConnEvent ev;
+    while (s_queue && xQueueReceive(s_queue, &ev, 0) == pdTRUE) _m.on_event(ev, millis());
+    _m.tick(millis());
+}
+
+bool WifiConn::has_cache() {
+    WifiCacheEntry e;
+    return wifi_cache_load(&e) && strcmp(e.ssid, _ssid) == 0 && strcmp(e.pass, _pass) == 0;
+}
+
+void WifiConn::begin_fast() {
+    WifiCacheEntry e;
+    if (wifi_cache_load(&e)) wifi_begin_fast(e);
+}
+
+void WifiConn::begin_full() {
+    wifi_begin_full(_ssid, _pass);
+}
+
+void WifiConn::disconnect() {
+    WiFi.disconnect();
+}
+
+void WifiConn::connected() {
+    wifi_cache_store_current(_ssid, _pass);
+}
+#endif
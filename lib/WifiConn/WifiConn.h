@@ -0,0 +1,43 @@
+#pragma once
+
+// WifiConnMachine の実機側。
+// WiFi.onEvent のコールバック（WiFi のイベントタスク）はイベントをキューに積むだけで、
+// 状態機械の更新と状態通知は poll() を呼ぶスレッド（LVGL の lv_timer）で行う。
+// 接続には WifiCache（キャッシュがあれば直接接続）を使い、接続できたらキャッシュを更新する。
+
+#include "WifiConnMachine.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+class WifiConn : private WifiConnDriver {
+public:
+    explicit WifiConn(const WifiConnPolicy& policy = default_policy()) : _m(*this, policy) {}
+
+    void begin();
+    void on_status(WifiConnStatusCb cb, void* user = nullptr) { _m.on_status(cb, user); }
+    void connect(const char* ssid, const char* pass);
+    void cancel() { _m.cancel(); }
+    // イベントを処理して状態を進める（UI スレッドから短い周期で呼ぶ）
+    void poll();
+
+    const char* ssid() const { return _ssid; }
+    const WifiConnStatus& status() const { return _m.status(); }
+
+    static WifiConnPolicy default_policy();
+
+private:
+    bool has_cache() override;
+    void begin_fast() override;
+    void begin_full() override;
+    void disconnect() override;
+    void connected() override;
+
+    WifiConnMachine _m;
+    char _ssid[33] = "";
+    char _pass[65] = "";
+    static QueueHandle_t s_queue;
+};
+#endif
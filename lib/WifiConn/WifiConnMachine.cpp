@@ -0,0 +1,122 @@
+#include "WifiConnMachine.h"
+
+namespace {
+
+bool is_auth_failure(uint8_t reason) {
+    return reason == WIFI_CONN_REASON_AUTH_FAIL || reason == WIFI_CONN_REASON_AUTH_EXPIRE ||
+           reason == WIFI_CONN_REASON_4WAY_TIMEOUT || reason == WIFI_CONN_REASON_HANDSHAKE_TIMEOUT;
+}
+
+// 時刻の比較（millis() の一周を考慮）
+bool reached(uint32_t now, uint32_t t) { return (int32_t)(now - t) >= 0; }
+
+}  // namespace
+
+void WifiConnMachine::start(uint32_t now) {
+    _st = {WifiConnState::Idle, WifiConnFail::None, 0, 0, false, 0, 0};
+    _t0 = now;
+    if (_drv.has_cache()) enter_fast(now);
+    else enter_full(now);
+}
+
+void WifiConnMachine::cancel() {
+    if (_st.state == WifiConnState::Idle) return;
+    _st.state = WifiConnState::Idle;
+    _drv.disconnect();
+    notify();
+}
+
+void WifiConnMachine::enter_fast(uint32_t now) {
+    _st.state = WifiConnState::Fast;
+    _deadline = now + _policy.fast_timeout_ms;
+    _drv.begin_fast();
+    notify();
+}
+
+void WifiConnMachine::enter_full(uint32_t now) {
+    _st.state = WifiConnState::Full;
+    ++_st.attempt;
+    _deadline = now + _policy.attempt_timeout_ms;
+    _drv.begin_full();
+    notify();
+}
+
+void WifiConnMachine::fail(WifiConnFail why) {
+    _st.state = WifiConnState::Failed;
+    _st.fail = why;
+    _drv.disconnect();
+    notify();
+}
+
+void WifiConnMachine::attempt_failed(uint32_t now, WifiConnFail why) {
+    if (_st.attempt > _policy.max_retries) {
+        fail(why == WifiConnFail::Timeout ? WifiConnFail::Timeout : WifiConnFail::Retries);
+        return;
+    }
+    uint32_t wait = _policy.backoff_base_ms << (_st.attempt > 0 ? _st.attempt - 1 : 0);
+    if (wait > _policy.backoff_max_ms || wait < _policy.backoff_base_ms) wait = _policy.backoff_max_ms;
+    _st.state = WifiConnState::Backoff;
+    _st.fail = why;
+    _deadline = now + wait;
+    notify();
+}
+
+void WifiConnMachine::on_event(const WifiConnEvent& ev, uint32_t now) {
+    switch (ev.type) {
+    case WifiConnEventType::Associated:
+        break;
+    case WifiConnEventType::GotIp:
+        if (_st.state == WifiConnState::Fast || _st.state == WifiConnState::Full) {
+            _st.via_cache = _st.state == WifiConnState::Fast;
+            _st.state = WifiConnState::Connected;
+            _st.fail = WifiConnFail::None;
+            _st.ip = ev.ip;
+            _st.time_to_ip_ms = now - _t0;
+            _drv.connected();
+            notify();
+        }
+        break;
+    case WifiConnEventType::Disconnected:
+        // 自分で切った分（begin の前の disconnect など）は数えない
+        if (ev.reason == WIFI_CONN_REASON_ASSOC_LEAVE) break;
+        _st.reason = ev.reason;
+        if (_st.state == WifiConnState::Fast) {
+            enter_full(now);   // キャッシュが古い: スキャンからやり直す
+        } else if (_st.state == WifiConnState::Full) {
+            if (is_auth_failure(ev.reason)) fail(WifiConnFail::Auth);
+            else attempt_failed(now, ev.reason == WIFI_CONN_REASON_NO_AP_FOUND ? WifiConnFail::NoAp : WifiConnFail::None);
+        } else if (_st.state == WifiConnState::Connected) {
+            if (!_policy.auto_reconnect) {
+                _st.state = WifiConnState::Idle;
+                notify();
+                break;
+            }
+            _t0 = now;
+            _st.attempt = 0;
+            _st.via_cache = false;
+            _st.ip = 0;
+            _st.time_to_ip_ms = 0;
+            if (_drv.has_cache()) enter_fast(now);
+            else enter_full(now);
+        }
+        break;
+    }
+}
+
+void WifiConnMachine::tick(uint32_t now) {
+    if (!reached(now, _deadline)) return;
+    switch (_st.state) {
+    case WifiConnState::Fast:
+        enter_full(now);
+        break;
+    case WifiConnState::Full:
+        _drv.disconnect();
+        attempt_failed(now, WifiConnFail::Timeout);
+        break;
+    case WifiConnState::Backoff:
+        enter_full(now);
+        break;
+    default:
+        break;
+    }
+}
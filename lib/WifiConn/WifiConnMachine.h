@@ -0,0 +1,93 @@
+#pragma once
+
+// WiFi 接続の状態機械（Arduino 非依存）。
+// 入力は WiFi のイベント（on_event）と時刻（tick）、出力は WifiConnDriver の呼び出しと状態通知。
+//   Fast    : キャッシュした BSSID/チャネルへ直接接続。失敗/タイムアウトで Full へ
+//   Full    : スキャンして接続。認証エラーは即 Failed、それ以外はバックオフして再試行
+//   Backoff : 次の試行まで待つ（base * 2^n、上限あり）
+//   Connected で切断されたら、auto_reconnect なら Fast から接続し直す
+// 実機では WifiConn（WiFi.onEvent → キュー → LVGL スレッド）から使う。
+
+#include <stdint.h>
+
+enum class WifiConnState : uint8_t { Idle, Fast, Full, Backoff, Connected, Failed };
+enum class WifiConnEventType : uint8_t { Associated, GotIp, Disconnected };
+enum class WifiConnFail : uint8_t { None, Auth, NoAp, Timeout, Retries };
+
+// 切断理由（esp_wifi_types.h の wifi_err_reason_t と同じ値）
+enum : uint8_t {
+    WIFI_CONN_REASON_AUTH_EXPIRE       = 2,
+    WIFI_CONN_REASON_ASSOC_LEAVE       = 8,     // 自分から切った
+    WIFI_CONN_REASON_4WAY_TIMEOUT      = 15,
+    WIFI_CONN_REASON_NO_AP_FOUND       = 201,
+    WIFI_CONN_REASON_AUTH_FAIL         = 202,
+    WIFI_CONN_REASON_HANDSHAKE_TIMEOUT = 204,
+};
+
+struct WifiConnEvent {
+    WifiConnEventType type;
+    uint8_t  reason;     // Disconnected の理由
+    uint32_t ip;         // GotIp のアドレス
+};
+
+struct WifiConnPolicy {
+    uint32_t fast_timeout_ms    = 4000;
+    uint32_t attempt_timeout_ms = 15000;
+    uint8_t  max_retries        = 4;      // Full の再試行回数
+    uint32_t backoff_base_ms    = 1000;
+    uint32_t backoff_max_ms     = 30000;
+    bool     auto_reconnect     = true;
+};
+
+struct WifiConnStatus {
+    WifiConnState state;
+    WifiConnFail  fail;
+    uint8_t  attempt;        // Full の試行回数（1〜）
+    uint8_t  reason;         // 最後の切断理由
+    bool     via_cache;      // Fast で繋がった
+    uint32_t ip;
+    uint32_t time_to_ip_ms;  // start() から GotIp まで
+};
+
+class WifiConnDriver {
+public:
+    virtual ~WifiConnDriver() {}
+    virtual bool has_cache() = 0;
+    virtual void begin_fast() = 0;
+    virtual void begin_full() = 0;
+    virtual void disconnect() = 0;
+    virtual void connected() = 0;    // キャッシュの保存など
+};
+
+typedef void (*WifiConnStatusCb)(const WifiConnStatus& st, void* user);
+
+class WifiConnMachine {
+public:
+    WifiConnMachine(WifiConnDriver& drv, const WifiConnPolicy& policy = WifiConnPolicy())
+        : _drv(drv), _policy(policy) {}
+
+    void on_status(WifiConnStatusCb cb, void* user = nullptr) { _cb = cb; _user = user; }
+
+    void start(uint32_t now);
+    void cancel();
+    void on_event(const WifiConnEvent& ev, uint32_t now);
+    void tick(uint32_t now);
+
+    const WifiConnStatus& status() const { return _st; }
+    WifiConnState state() const { return _st.state; }
+
+private:
+    void enter_fast(uint32_t now);
+    void enter_full(uint32_t now);
+    void attempt_failed(uint32_t now, WifiConnFail why);
+    void fail(WifiConnFail why);
+    void notify() { if (_cb) _cb(_st, _user); }
+
+    WifiConnDriver& _drv;
+    WifiConnPolicy _policy;
+    WifiConnStatusCb _cb = nullptr;
+    void* _user = nullptr;
+    WifiConnStatus _st = {WifiConnState::Idle, WifiConnFail::None, 0, 0, false, 0, 0};
+    uint32_t _t0 = 0;
+    uint32_t _deadline = 0;
+};
@@ -0,0 +1,103 @@
+#include <WiFi.h>
+#include "WifiScan.h"
+
+bool WifiScanner::start(const uint8_t* channels, uint8_t n, uint16_t ms_per_chan) {
+    cancel();
+    if (!channels || n == 0) {
+        for (uint8_t i = 0; i < WIFI_SCAN_CHANNELS; ++i) _channels[i] = i + 1;
+        n = WIFI_SCAN_CHANNELS;
+    } else {
+        if (n > WIFI_SCAN_CHANNELS) n = WIFI_SCAN_CHANNELS;
+        memcpy(_channels, channels, n);
+    }
+    _n = n;
+    _pos = 0;
+    _retry = 0;
+    _ms_per_chan = ms_per_chan;
+    _count = 0;
+    _t_start = _t_end = millis();
+    // 接続は切らない（接続中でもスキャンできる）。STA が無効な時だけ有効にする
+    if (!(WiFi.getMode() & WIFI_MODE_STA)) WiFi.mode(WIFI_STA);
+    return start_channel();
+}
+
+bool WifiScanner::start_known(uint16_t ms_per_chan) {
+    uint8_t ch[WIFI_SCAN_CHANNELS];
+    uint8_t n = 0;
+    for (uint8_t c = 1; c <= WIFI_SCAN_CHANNELS; ++c) {
+        for (uint8_t i = 0; i < _count; ++i) {
+            if (_aps[i].channel == c) { ch[n++] = c; break; }
+        }
+    }
+    return start(n ? ch : nullptr, n, ms_per_chan);
+}
+
+void WifiScanner::cancel() {
+    if (_running) {
+        // 実行中のスキャンは止められないので、結果だけ捨てる
+        WiFi.scanDelete();
+        _running = false;
+    }
+    _pos = _n = 0;
+}
+
+bool WifiScanner::start_channel() {
+    int16_t r = WiFi.scanNetworks(/*async=*/true, /*hidden=*/false, /*passive=*/false, _ms_per_chan, _channels[_pos]);
+    _running = (r == WIFI_SCAN_RUNNING);
+    return _running;
+}
+
+void WifiScanner::poll() {
+    if (!busy()) return;
+    if (!_running) {
+        // 開始に失敗したチャネルは次の poll でやり直す
+        if (!start_channel() && ++_retry > 3) { _retry = 0; ++_pos; }
+        return;
+    }
+    int16_t r = WiFi.scanComplete();
+    if (r == WIFI_SCAN_RUNNING) return;
+    _running = false;
+    if (r >= 0) merge();
+    WiFi.scanDelete();
+    _retry = 0;
+    ++_pos;
+    _t_end = millis();
+    const bool done = !busy();
+    if (_cb) _cb(_aps, _count, done, _user);
+    if (!done) start_channel();
+}
+
+void WifiScanner::merge() {
+    const int16_t n = WiFi.scanComplete();
+    for (int16_t i = 0; i < n; ++i) {
+        String ssid = WiFi.SSID(i);
+        if (ssid.length() == 0) continue;   // 非公開 SSID は名前で選べないので載せない
+        const int8_t rssi = (int8_t)WiFi.RSSI(i);
+
+        // 同じ SSID は強い方を残す
+        int8_t slot = -1;
+        for (uint8_t k = 0; k < _count; ++k) {
+            if (strcmp(_aps[k].ssid, ssid.c_str()) == 0) { slot = k; break; }
+        }
+        if (slot >= 0) {
+            if (rssi <= _aps[slot].rssi) continue;
+            for (uint8_t k = slot; k + 1 < _count; ++k) _aps[k] = _aps[k + 1];
+            --_count;
+        }
+        WifiScanAp ap;
+        strncpy(ap.ssid, ssid.c_str(), sizeof(ap.ssid) - 1);
+        ap.ssid[sizeof(ap.ssid) - 1] = '\0';
+        ap.rssi = rssi;
+        ap.channel = (uint8_t)WiFi.channel(i);
+        ap.secured = WiFi.encryptionType(i) != WIFI_AUTH_OPEN;
+
+        // RSSI の降順に挿入（満杯なら一番弱いものを押し出す）
+        uint8_t pos = _count;
+        while (pos > 0 && _aps[pos - 1].rssi < rssi) --pos;
+        if (pos >= WIFI_SCAN_MAX_APS) continue;
+        const uint8_t last = _count < WIFI_SCAN_MAX_APS ? _count : WIFI_SCAN_MAX_APS - 1;
+        for (uint8_t k = last; k > pos; --k) _aps[k] = _aps[k - 1];
+        _aps[pos] = ap;
+        if (_count < WIFI_SCAN_MAX_APS) ++_count;
+    }
+}
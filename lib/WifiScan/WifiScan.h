@@ -0,0 +1,60 @@
+#pragma once
+
+// 非同期・チャネル単位の WiFi スキャン。
+// ESP32 のスキャン結果はスキャン全体が終わるまで取れないので、1チャネルずつ非同期スキャンを回し、
+// チャネルが終わるたびに結果を統合して通知する（UI は最初のチャネル分から表示できる）。
+// poll() は待たないので、lv_timer などから定期的に呼ぶ。
+// start_known() は前回見つかったチャネルだけを回す（再スキャンを速くする）。
+
+#include <stdint.h>
+
+#ifndef WIFI_SCAN_MAX_APS
+#define WIFI_SCAN_MAX_APS 32
+#endif
+#ifndef WIFI_SCAN_MS_PER_CHAN
+#define WIFI_SCAN_MS_PER_CHAN 120
+#endif
+#define WIFI_SCAN_CHANNELS 13
+
+struct WifiScanAp {
+    char    ssid[33];
+    int8_t  rssi;
+    uint8_t channel;
+    bool    secured;
+};
+
+// 結果が更新されるたびに呼ばれる（RSSI の降順、SSID で重複排除済み）。done は全チャネル終了
+typedef void (*WifiScanCb)(const WifiScanAp* aps, uint8_t count, bool done, void* user);
+
+class WifiScanner {
+public:
+    void on_update(WifiScanCb cb, void* user = nullptr) { _cb = cb; _user = user; }
+
+    // channels=nullptr なら 1..13 を順に回す。結果は空にしてから始める
+    bool start(const uint8_t* channels = nullptr, uint8_t n = 0, uint16_t ms_per_chan = WIFI_SCAN_MS_PER_CHAN);
+    // 前回の結果にあるチャネルだけを回す（前回が空なら全チャネル）
+    bool start_known(uint16_t ms_per_chan = WIFI_SCAN_MS_PER_CHAN);
+    void cancel();
+    void poll();
+
+    bool busy() const { return _pos < _n; }
+    uint8_t count() const { return _count; }
+    const WifiScanAp& ap(uint8_t i) const { return _aps[i]; }
+    uint32_t elapsed_ms() const { return _t_end - _t_start; }
+
+private:
+    bool start_channel();
+    void merge();
+
+    WifiScanCb _cb = nullptr;
+    void* _user = nullptr;
+    uint8_t _channels[WIFI_SCAN_CHANNELS];
+    uint8_t _n = 0, _pos = 0;
+    uint8_t _retry = 0;
+    bool _running = false;          // 現在のチャネルのスキャン要求中
+    uint16_t _ms_per_chan = WIFI_SCAN_MS_PER_CHAN;
+    uint32_t _t_start = 0, _t_end = 0;
+
+    WifiScanAp _aps[WIFI_SCAN_MAX_APS];
+    uint8_t _count = 0;
+};
@@ -1,14 +1,25 @@
 // LovyanGFX + LVGL test (ESP32 + ST7789 240x320)
 
 #include <Arduino.h>
-#include "../include/LGFX_Driver.hpp"
+#include "BspLgfx.hpp"
 #include <esp_heap_caps.h>
 #include <SPI.h>
 #include <SD.h>
 #include <lvgl.h>
+#include "LvPool.h"   // lv_conf.h の LV_MEM_CUSTOM のアロケータ
 #include "CST820.h"
+#include "TouchFilter.h"
+#include "TouchTrace.h"
+#include "TouchAffine.h"
+#include "TouchCalibUi.h"
+#include "LatencyProbe.h"
+#include "SdBench.h"
+#include "SdMount.h"
+#include "SdService.h"
 
 static LGFX tft;
+static SdFsBackend sd_backend(SD);
+static SdService sd_service(sd_backend);
 
 extern "C" uint32_t lvgl_tick_get_cb(void) { return millis(); }
 
@@ -18,6 +29,22 @@ extern "C" uint32_t lvgl_tick_get_cb(void) { return millis(); }
 #endif
 static lv_color_t lvbuf1[320 * LV_LINES];
 
+// タッチトレース（生サンプル）: 0=無効 / 1=SDへ記録 / 2=SDから再生して indev に流す
+#ifndef TOUCH_TRACE_MODE
+#define TOUCH_TRACE_MODE 0
+#endif
+#ifndef TOUCH_TRACE_PATH
+#define TOUCH_TRACE_PATH "/touch.ctt"
+#endif
+#if TOUCH_TRACE_MODE == 1
+static TouchTraceRecorder trace_rec;
+#elif TOUCH_TRACE_MODE == 2
+static TouchTracePlayer trace_player;
+#endif
+
+// タッチ生座標 → 画面座標（既定は横向き: sx = ry, sy = 239 - rx。NVS にキャリブレーション結果があれば置き換える）
+static TouchAffine touch_cal = touch_affine_make(0, 1, 0, -1, 0, 240 - 1);
+
 static void print_mem(const char* stage) {
     size_t free8   = heap_caps_get_free_size(MALLOC_CAP_8BIT);
     size_t freeDMA = heap_caps_get_free_size(MALLOC_CAP_DMA);
@@ -36,6 +63,7 @@ static void lvgl_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* c
     uint32_t h = (area->y2 - area->y1 + 1);
     // 無駄のない経路に統一: LVGL側で LV_COLOR_16_SWAP=1 にしておき、ここではスワップせず送る
     tft.pushImage(area->x1, area->y1, w, h, (uint16_t*)&color_p->full, false /*swapBytes*/);
+    LATENCY_PROBE_FLUSH(lv_scr_act(), lv_disp_flush_is_last(disp));
     lv_disp_flush_ready(disp);
 }
 
@@ -46,8 +74,8 @@ void setup() {
     tft.init();
     tft.setRotation(1);              // landscape 320x240（製品の正位を維持）
     tft.setColorDepth(16);
-    pinMode(27, OUTPUT);             // BL 強制点灯
-    digitalWrite(27, HIGH);
+    pinMode(bsp::Board::Tft::kBl, OUTPUT);  // BL 強制点灯
+    digitalWrite(bsp::Board::Tft::kBl, HIGH);
     tft.setBrightness(255);
     print_mem("boot");
 
@@ -62,11 +90,19 @@ void setup() {
     disp_drv.ver_res = tft.height();
     disp_drv.flush_cb = lvgl_flush;
     disp_drv.draw_buf = &draw_buf;
+#if LATENCY_PROBE_ENABLE
+    // 無効化のたびに呼ばれる（領域は変更しない）。indev の処理中（read_cb で読んだ入力をイベントとして配っている間）に
+    // 起きたものだけを入力→再描画の対応付けに使う。描画中の呼び出しやタイマー/アニメーションの無効化では lv_indev_get_act() が NULL
+    disp_drv.rounder_cb = [](lv_disp_drv_t*, lv_area_t*) {
+        if (lv_indev_get_act()) LATENCY_PROBE_INVALIDATE();
+    };
+#endif
     lv_disp_drv_register(&disp_drv);
     print_mem("after_lvgl");
 
     // UI: タイトル + スライダー + ラベル + ボタン
     lv_obj_t* root = lv_scr_act();
+    LATENCY_PROBE_NAME(root, "main");
     lv_obj_set_flex_flow(root, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_style_pad_all(root, 12, 0);
     lv_obj_set_style_pad_gap(root, 12, 0);
@@ -103,8 +139,9 @@ void setup() {
 
     // --- Touch indev (CST820 I2C) ---
     // CYD: SDA=33, SCL=32, RST=25, INT=21
-    static CST820 tp(33, 32, 25, 21, I2C_ADDR_CST820);
+    static CST820 tp;
     tp.begin();
+    touch_calib_load(&touch_cal);
 
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
@@ -113,112 +150,100 @@ void setup() {
         static CST820* s_tp = nullptr;
         if (!s_tp) s_tp = (CST820*)drv->user_data;
 
-        uint16_t rx, ry; uint8_t g;
-        bool pressed = s_tp->getTouch(&rx, &ry, &g);
-
-        // フィルタ切替マクロ（デフォルトOFF）
-        #ifndef TOUCH_FILTER_ENABLE
-        #define TOUCH_FILTER_ENABLE 0
-        #endif
-
-        #if TOUCH_FILTER_ENABLE
-            static bool last_pressed = false;
-            static uint8_t press_cnt = 0, release_cnt = 0;
-            static uint16_t fx = 0, fy = 0; // filtered
-            const uint8_t PRESS_STABLE = 2;
-            const uint8_t RELEASE_STABLE = 2;
-            const uint16_t DEADZONE = 3; // px
-
-            if (!pressed) {
-                release_cnt++;
-                press_cnt = 0;
-                if (last_pressed && release_cnt >= RELEASE_STABLE) last_pressed = false;
-                data->state = last_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
-                if (last_pressed) { data->point.x = fx; data->point.y = fy; }
-                return;
-            }
-
-            uint16_t sx = ry;
-            uint16_t sy = (uint16_t)(240 - 1) - rx;
-            if (sx >= tft.width())  sx = tft.width() - 1;
-            if (sy >= tft.height()) sy = tft.height() - 1;
-
-            if (!last_pressed) { fx = sx; fy = sy; }
-            else {
-                uint16_t dx = (sx > fx) ? (sx - fx) : (fx - sx);
-                uint16_t dy = (sy > fy) ? (sy - fy) : (fy - sy);
-                if (dx > DEADZONE || dy > DEADZONE) {
-                    fx = (uint16_t)((fx * 3 + sx) / 4);
-                    fy = (uint16_t)((fy * 3 + sy) / 4);
-                }
-            }
+        static TouchFilterDefault filter;
 
-            press_cnt++;
-            release_cnt = 0;
-            if (!last_pressed && press_cnt >= PRESS_STABLE) last_pressed = true;
-
-            data->state = last_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
-            data->point.x = fx; data->point.y = fy;
-        #else
-            if (!pressed) { data->state = LV_INDEV_STATE_RELEASED; return; }
-            uint16_t sx = ry;
-            uint16_t sy = (uint16_t)(240 - 1) - rx;
-            if (sx >= tft.width())  sx = tft.width() - 1;
-            if (sy >= tft.height()) sy = tft.height() - 1;
-            data->state = LV_INDEV_STATE_PRESSED;
-            data->point.x = sx; data->point.y = sy;
-        #endif
+        uint16_t rx = 0, ry = 0; uint8_t g = 0;
+        TouchPoint p = {0, 0, false, millis()};
+#if TOUCH_TRACE_MODE == 2
+        if (trace_player.active()) p.pressed = trace_player.getTouch(p.t_ms, &rx, &ry, &g);
+        else
+#endif
+        p.pressed = s_tp->getTouch(&rx, &ry, &g);
+        LATENCY_PROBE_INPUT(micros(), p.pressed, rx, ry);
+#if TOUCH_TRACE_MODE == 1
+        trace_rec.push(p.t_ms, rx, ry, g, p.pressed);
+#endif
+        if (touch_calib_ui_active()) {
+            touch_calib_ui_feed(p.pressed, rx, ry);
+            data->state = LV_INDEV_STATE_RELEASED;
+            return;
+        }
+        if (p.pressed) touch_affine_apply(touch_cal, rx, ry, &p.x, &p.y);
+        filter.process(p);
+        if (!p.pressed) { data->state = LV_INDEV_STATE_RELEASED; return; }
+
+        if (p.x < 0) p.x = 0;
+        if (p.y < 0) p.y = 0;
+        if (p.x >= tft.width())  p.x = tft.width() - 1;
+        if (p.y >= tft.height()) p.y = tft.height() - 1;
+        data->state = LV_INDEV_STATE_PRESSED;
+        data->point.x = p.x; data->point.y = p.y;
     };
     indev_drv.user_data = &tp;
     lv_indev_drv_register(&indev_drv);
 
+    // 起動時に画面を押したままならタッチのキャリブレーション画面を出す
+    {
+        uint16_t rx, ry; uint8_t g;
+        if (tp.getTouch(&rx, &ry, &g)) touch_calib_ui_start(&touch_cal);
+    }
+
     // --- SD read/write test (VSPI: SCK=18, MISO=19, MOSI=23, CS=5) ---
-    SPIClass sdSPI(VSPI);
-    sdSPI.begin(18, 19, 23, 5);
-    bool sd_ok = SD.begin(5, sdSPI, 10000000);
+    static SPIClass sdSPI(VSPI);  // SD はこのインスタンスを保持し続けるので static にする
+    sdSPI.begin(bsp::Board::Sd::kSck, bsp::Board::Sd::kMiso, bsp::Board::Sd::kMosi, bsp::Board::Sd::kCs);
+    SdMountResult sdm = sd_mount_auto(sdSPI, bsp::Board::Sd::kCs);
+    bool sd_ok = sdm.ok;
+    if (sd_ok) Serial.printf("[SD] %lu Hz%s\n", (unsigned long)sdm.hz, sdm.cached ? " (cached)" : "");
+#if SD_BENCH_ENABLE
+    if (sd_ok) sd_ok = sd_bench_run(sdSPI, sd_bench_default_config(bsp::Board::Sd::kCs, sdm.hz), Serial);
+#endif
 
     // 右下に結果を表示するラベル（既存UIの配置は維持）
     lv_obj_t* sd_lbl = lv_label_create(lv_scr_act());
     lv_obj_align(sd_lbl, LV_ALIGN_BOTTOM_RIGHT, -4, -4);
 
     if (sd_ok) {
+        // 以降のファイル操作は SD I/O サービス経由（ここでは完了を待つ）
+        sd_service.begin();
+
         // ルートを少し列挙
-        File rootDir = SD.open("/");
+        static char listBuf[128];
+        SdFuture list_fut;
         int count = 0; String names;
-        if (rootDir) {
-            for (File f = rootDir.openNextFile(); f; f = rootDir.openNextFile()) {
-                if (count < 3) {
-                    names += f.name(); names += ' ';
-                }
-                f.close();
-                ++count;
+        if (sd_service.submit(SdPrio::Low, SdOp::List, "/", 0, (uint8_t*)listBuf, sizeof(listBuf),
+                              nullptr, nullptr, &list_fut) && list_fut.wait() && list_fut.result().ok) {
+            count = list_fut.result().bytes;
+            int shown = 0;
+            for (char* p = listBuf; *p && shown < 3; ++shown) {
+                char* nl = strchr(p, '\n');
+                if (!nl) break;
+                *nl = '\0';
+                names += p; names += ' ';
+                p = nl + 1;
             }
-            rootDir.close();
         }
 
         // RWテスト
         const char* testPath = "/lovgfx_sd_test.txt";
         String payload = String("Hello SD @") + String(millis());
-        bool wr_ok = false, rd_ok = false; String readBack;
-
-        File wf = SD.open(testPath, FILE_WRITE);
-        if (wf) {
-            size_t n = wf.print(payload);
-            wf.flush(); wf.close();
-            wr_ok = (n == payload.length());
-        }
-        File rf = SD.open(testPath, FILE_READ);
-        if (rf) {
-            while (rf.available() && readBack.length() < 64) readBack += (char)rf.read();
-            rf.close();
-            rd_ok = (readBack.length() > 0);
-        }
+        char readBuf[65] = "";
+        SdFuture wr_fut, rd_fut;
+        bool wr_ok = sd_service.submit(SdPrio::Low, SdOp::Write, testPath, 0, (uint8_t*)payload.c_str(), payload.length(),
+                                       nullptr, nullptr, &wr_fut) && wr_fut.wait() && wr_fut.result().ok;
+        bool rd_ok = sd_service.submit(SdPrio::Low, SdOp::Read, testPath, 0, (uint8_t*)readBuf, sizeof(readBuf) - 1,
+                                       nullptr, nullptr, &rd_fut) && rd_fut.wait() && rd_fut.result().bytes > 0;
+        String readBack(readBuf);
 
         Serial.printf("[SD] OK files=%d %s | RW=%s/%s '%s'\n",
                       count, names.c_str(), wr_ok?"OK":"NG", rd_ok?"OK":"NG", readBack.c_str());
         lv_label_set_text_fmt(sd_lbl, "SD: OK CS=5 VSPI files=%d %s\nRW: %s/%s %s",
                               count, names.length()? ("[" + names + "]").c_str() : "",
                               wr_ok?"OK":"NG", rd_ok?"OK":"NG", rd_ok? readBack.c_str(): "");
+#if TOUCH_TRACE_MODE == 1
+        Serial.printf("[TRACE] record %s: %s\n", TOUCH_TRACE_PATH, trace_rec.begin(sd_service, TOUCH_TRACE_PATH) ? "OK" : "NG");
+#elif TOUCH_TRACE_MODE == 2
+        Serial.printf("[TRACE] replay %s: %s\n", TOUCH_TRACE_PATH, trace_player.begin(sd_service, TOUCH_TRACE_PATH, true) ? "OK" : "NG");
+#endif
         print_mem("after_sd");
     } else {
         Serial.println("[SD] Not found (VSPI CS=5)");
@@ -256,7 +281,43 @@ void setup() {
     tft.print("LovyanGFX test");
 }
 
+#if TOUCH_TRACE_MODE == 1
+// シリアルの "trace stop" で端数を書き出して記録を止める
+static void poll_serial_command() {
+    static char line[16];
+    static uint8_t len = 0;
+    while (Serial.available()) {
+        const int c = Serial.read();
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (len < sizeof(line) - 1) line[len++] = (char)c;
+            continue;
+        }
+        line[len] = '\0';
+        len = 0;
+        if (strcmp(line, "trace stop") == 0) {
+            trace_rec.end();
+            Serial.printf("[TRACE] stopped: recorded=%lu dropped=%lu write_err=%lu\n", (unsigned long)trace_rec.recorded(),
+                          (unsigned long)trace_rec.dropped(), (unsigned long)trace_rec.write_errors());
+        } else if (line[0]) {
+            Serial.printf("? %s (trace stop)\n", line);
+        }
+    }
+}
+#endif
+
 void loop() {
     lv_timer_handler();
+#if TOUCH_TRACE_MODE == 1
+    poll_serial_command();
+#endif
+#if LATENCY_PROBE_ENABLE
+    static uint32_t last_report = 0;
+    if (millis() - last_report > 10000) { last_report = millis(); latency_probe_report(Serial); }
+#endif
+#if SD_SERVICE_REPORT
+    static uint32_t last_sd_report = 0;
+    if (sd_service.running() && millis() - last_sd_report > 10000) { last_sd_report = millis(); sd_service.report(Serial); }
+#endif
     delay(5);
 }
@@ -0,0 +1,169 @@
+// アセットパック（lib/AssetPack の形式）を作る
+//
+//   g++ -std=c++11 -O2 -I lib/AssetPack tools/asset_pack.cpp -o asset_pack
+//   ./asset_pack assets.bin title=font/title.vlw logo=img/logo.ppm menu=ui/menu.tbl
+//   esptool.py write_flash 0x210000 assets.bin      # partitions.csv の spiffs の先頭
+//
+// 種類は拡張子で決める: .vlw=Font / .ppm(P6)=Image（RGB565 に変換）/ .tbl=Table / その他=Raw
+//   --no-swap  画像を LV_COLOR_16_SWAP=0 向けに並べる（既定はスワップ済み）
+//   -x DIR     格納したデータを DIR/名前 にも書き出す（SD に置いて asset_pack_bench で比較する用）
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+struct Item {
+    std::string name;
+    AssetType type;
+    std::vector<uint8_t> data;
+};
+
+static uint32_t crc32(const uint8_t* p, size_t n) {
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; ++i) {
+        c ^= p[i];
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1)));
+    }
+    return ~c;
+}
+
+static std::vector<uint8_t> read_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); exit(1); }
+    std::vector<uint8_t> v;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) v.insert(v.end(), buf, buf + n);
+    fclose(f);
+    return v;
+}
+
+static bool ends_with(const std::string& s, const char* ext) {
+    size_t n = strlen(ext);
+    return s.size() >= n && s.compare(s.size() - n, n, ext) == 0;
+}
+
+// P6 の PPM を AssetImageInfo + RGB565 に変換する
+static std::vector<uint8_t> ppm_to_rgb565(const char* path, const std::vector<uint8_t>& src, bool swap) {
+    size_t pos = 0;
+    auto token = [&]() -> std::string {
+        for (;;) {
+            while (pos < src.size() && isspace(src[pos])) ++pos;
+            if (pos < src.size() && src[pos] == '#') {
+                while (pos < src.size() && src[pos] != '\n') ++pos;
+                continue;
+            }
+            break;
+        }
+        std::string t;
+        while (pos < src.size() && !isspace(src[pos])) t += (char)src[pos++];
+        return t;
+    };
+    if (token() != "P6") { fprintf(stderr, "%s: P6 の PPM のみ対応\n", path); exit(1); }
+    int w = atoi(token().c_str()), h = atoi(token().c_str()), maxv = atoi(token().c_str());
+    ++pos;  // 画素の前の空白1文字
+    if (w <= 0 || h <= 0 || w > 0xFFFF || h > 0xFFFF || maxv != 255 || src.size() < pos + (size_t)w * h * 3) {
+        fprintf(stderr, "%s: 不正な PPM\n", path);
+        exit(1);
+    }
+    AssetImageInfo info = {(uint16_t)w, (uint16_t)h, (uint16_t)(swap ? 1 : 0), 0};
+    std::vector<uint8_t> out(sizeof(info) + (size_t)w * h * 2);
+    memcpy(out.data(), &info, sizeof(info));
+    uint8_t* d = out.data() + sizeof(info);
+    for (size_t i = 0; i < (size_t)w * h; ++i) {
+        const uint8_t* p = &src[pos + i * 3];
+        uint16_t c = (uint16_t)(((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3));
+        d[i * 2 + 0] = swap ? (uint8_t)(c >> 8) : (uint8_t)c;
+        d[i * 2 + 1] = swap ? (uint8_t)c : (uint8_t)(c >> 8);
+    }
+    return out;
+}
+
+int main(int argc, char** argv) {
+    bool swap = true;
+    const char* extract_dir = nullptr;
+    const char* out_path = nullptr;
+    std::vector<Item> items;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--no-swap") == 0) { swap = false; continue; }
+        if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) { extract_dir = argv[++i]; continue; }
+        if (!out_path) { out_path = argv[i]; continue; }
+        const char* eq = strchr(argv[i], '=');
+        if (!eq) { fprintf(stderr, "name=path の形式で指定: %s\n", argv[i]); return 1; }
+        Item it;
+        it.name.assign(argv[i], eq - argv[i]);
+        const std::string path(eq + 1);
+        if (it.name.empty() || it.name.size() >= ASSET_NAME_MAX) {
+            fprintf(stderr, "名前は 1〜%d 文字: %s\n", ASSET_NAME_MAX - 1, it.name.c_str());
+            return 1;
+        }
+        std::vector<uint8_t> raw = read_file(path.c_str());
+        if (ends_with(path, ".vlw"))      { it.type = AssetType::Font;  it.data = raw; }
+        else if (ends_with(path, ".ppm")) { it.type = AssetType::Image; it.data = ppm_to_rgb565(path.c_str(), raw, swap); }
+        else if (ends_with(path, ".tbl")) { it.type = AssetType::Table; it.data = raw; }
+        else                              { it.type = AssetType::Raw;   it.data = raw; }
+        items.push_back(it);
+    }
+    if (!out_path || items.empty()) {
+        fprintf(stderr, "usage: %s [--no-swap] [-x DIR] out.bin name=path ...\n", argv[0]);
+        return 1;
+    }
+    if (items.size() > 0xFFFF) { fprintf(stderr, "アセットが多すぎます\n"); return 1; }
+
+    // 実機側は名前の二分探索なので名前順に並べる
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.name < b.name; });
+    for (size_t i = 1; i < items.size(); ++i) {
+        if (items[i].name == items[i - 1].name) { fprintf(stderr, "名前が重複: %s\n", items[i].name.c_str()); return 1; }
+    }
+
+    std::vector<AssetEntry> dir(items.size());
+    uint32_t off = sizeof(AssetPackHeader) + (uint32_t)(items.size() * sizeof(AssetEntry));
+    for (size_t i = 0; i < items.size(); ++i) {
+        memset(&dir[i], 0, sizeof(AssetEntry));
+        memcpy(dir[i].name, items[i].name.data(), items[i].name.size());
+        off = (off + 3) & ~3u;
+        dir[i].offset = off;
+        dir[i].size = (uint32_t)items[i].data.size();
+        dir[i].type = (uint16_t)items[i].type;
+        off += dir[i].size;
+    }
+
+    AssetPackHeader h;
+    memcpy(h.magic, ASSET_PACK_MAGIC, 4);
+    h.version = ASSET_PACK_VERSION;
+    h.count = (uint16_t)items.size();
+    h.total_size = off;
+    h.crc = crc32(reinterpret_cast<const uint8_t*>(dir.data()), dir.size() * sizeof(AssetEntry));
+
+    std::vector<uint8_t> pack(off, 0xFF);  // 隙間は消去状態のまま
+    memcpy(pack.data(), &h, sizeof(h));
+    memcpy(pack.data() + sizeof(h), dir.data(), dir.size() * sizeof(AssetEntry));
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (!items[i].data.empty()) memcpy(pack.data() + dir[i].offset, items[i].data.data(), items[i].data.size());
+    }
+
+    FILE* f = fopen(out_path, "wb");
+    if (!f || fwrite(pack.data(), 1, pack.size(), f) != pack.size()) { perror(out_path); return 1; }
+    fclose(f);
+
+    static const char* const type_names[] = {"raw", "font", "image", "table"};
+    for (size_t i = 0; i < items.size(); ++i) {
+        printf("%-20s %-6s %8u @0x%06x\n", items[i].name.c_str(), type_names[dir[i].type],
+               (unsigned)dir[i].size, (unsigned)dir[i].offset);
+        if (extract_dir) {
+            std::string p = std::string(extract_dir) + "/" + items[i].name;
+            FILE* x = fopen(p.c_str(), "wb");
+            if (!x) { perror(p.c_str()); return 1; }
+            fwrite(items[i].data.data(), 1, items[i].data.size(), x);
+            fclose(x);
+        }
+    }
+    printf("%s: %u assets, %u bytes (spiffs 0x1EF000 まで)\n", out_path, (unsigned)items.size(), (unsigned)pack.size());
+    return pack.size() > 0x1EF000 ? 1 : 0;
+}
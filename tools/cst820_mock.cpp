@@ -0,0 +1,200 @@
+// lib/Bsp/CST820.h をホスト上でモックの TwoWire に繋ぎ、失敗時の経路を確かめる
+//
+//   g++ -std=c++11 -O2 -I lib/Bsp tools/cst820_mock.cpp -o cst820_mock
+//   ./cst820_mock
+//
+// モックは1トランザクションごとに NAK / 短い読み出し / タイムアウト（時間を進めて 5 を返す）を差し込め、
+// SDA を指定クロック数だけ Low に張り付かせられる。Wire が掴んでいる間にピンを触ると
+// 実機と同じく Wire がピンを失い、掛け直すまで通信できなくなる。
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+
+// --- Arduino の代わり（CST820.h より前に宣言する） ---
+enum { LOW = 0, HIGH = 1 };
+enum { INPUT = 1, OUTPUT = 3, INPUT_PULLUP = 5, OUTPUT_OPEN_DRAIN = 0x13 };
+
+static uint32_t g_now_ms = 0;
+static uint32_t millis() { return g_now_ms; }
+static void delay(uint32_t ms) { g_now_ms += ms; }
+static void delayMicroseconds(uint32_t) {}
+
+static const uint8_t kSda = 33, kScl = 32;
+
+struct Line {
+    int stuck_clocks = 0;    // SDA を Low に掴んでいる残りクロック数
+    int scl_level = HIGH, sda_level = HIGH;
+    int scl_pulses = 0;
+    int stops = 0;           // SCL=High の間の SDA Low→High
+    int pins_stolen = 0;     // Wire が掴んでいる間に SDA/SCL を触った回数
+};
+static Line g_line;
+
+struct MockWire {
+    enum class Fault : uint8_t { Nak, Short, Timeout };
+    std::deque<Fault> faults;
+    uint32_t timeout_ms = 6;   // Timeout で進める時間
+    bool began = false;
+    bool detached = false;     // ピンを GPIO に取られた
+    int begins = 0;
+    uint8_t regs[16] = {};
+    uint8_t reg = 0, tx_len = 0;
+    bool short_next = false;
+    std::deque<uint8_t> rx;
+
+    bool begin(int, int) { began = true; detached = false; ++begins; return true; }
+    bool begin() { return begin(-1, -1); }
+    bool end() { began = false; return true; }
+    void setClock(uint32_t) {}
+    void setTimeOut(uint16_t) {}
+    void beginTransmission(uint8_t) { tx_len = 0; }
+    size_t write(uint8_t v) {
+        if (tx_len++ == 0) reg = v;
+        else if (reg < sizeof(regs)) regs[reg] = v;
+        return 1;
+    }
+    uint8_t endTransmission(bool = true) {
+        if (!began || detached || g_line.stuck_clocks > 0) return 4;
+        if (faults.empty()) return 0;
+        const Fault f = faults.front();
+        faults.pop_front();
+        switch (f) {
+        case Fault::Nak: return 2;
+        case Fault::Timeout: g_now_ms += timeout_ms; return 5;
+        case Fault::Short: short_next = true; return 0;
+        }
+        return 0;
+    }
+    uint8_t requestFrom(uint8_t, uint8_t n) {
+        if (!began || detached) return 0;
+        if (short_next) { short_next = false; n = n ? n - 1 : 0; }
+        for (uint8_t i = 0; i < n; ++i) rx.push_back(regs[(reg + i) & 15]);
+        return n;
+    }
+    int available() { return (int)rx.size(); }
+    int read() {
+        if (rx.empty()) return -1;
+        const int v = rx.front();
+        rx.pop_front();
+        return v;
+    }
+};
+static MockWire Wire;
+
+static void pinMode(uint8_t pin, uint8_t) {
+    if ((pin == kSda || pin == kScl) && Wire.began) {
+        ++g_line.pins_stolen;
+        Wire.detached = true;
+    }
+}
+static int digitalRead(uint8_t pin) {
+    if (pin == kSda) return g_line.stuck_clocks > 0 ? LOW : g_line.sda_level;
+    return HIGH;
+}
+static void digitalWrite(uint8_t pin, uint8_t v) {
+    if (pin == kScl) {
+        if (g_line.scl_level == LOW && v == HIGH) {
+            ++g_line.scl_pulses;
+            if (g_line.stuck_clocks > 0) --g_line.stuck_clocks;
+        }
+        g_line.scl_level = v;
+    } else if (pin == kSda) {
+        if (g_line.sda_level == LOW && v == HIGH && g_line.scl_level == HIGH) ++g_line.stops;
+        g_line.sda_level = v;
+    }
+}
+
+#include "CST820.h"
+
+static_assert(bsp::Board::Touch::kSda == kSda && bsp::Board::Touch::kScl == kScl, "mock pins follow the board");
+
+static int failures = 0;
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+// 毎回まっさらな状態から始める
+static void reset(CST820& tp) {
+    tp = CST820();
+    Wire = MockWire();
+    g_line = Line();
+    g_now_ms = 0;
+    // gesture=SingleTap, finger=1, X=0x123, Y=0x045
+    const uint8_t frame[] = {0x05, 0x01, 0x01, 0x23, 0x00, 0x45};
+    memcpy(&Wire.regs[1], frame, sizeof(frame));
+    tp.begin();
+}
+
+static bool touch(CST820& tp, uint16_t* x = nullptr, uint16_t* y = nullptr, uint8_t* g = nullptr) {
+    uint16_t dx, dy; uint8_t dg;
+    return tp.getTouch(x ? x : &dx, y ? y : &dy, g ? g : &dg);
+}
+
+int main() {
+    CST820 tp;
+    uint16_t x = 0, y = 0; uint8_t g = 0xFF;
+
+    reset(tp);
+    check(touch(tp, &x, &y, &g) && x == 0x123 && y == 0x45 && g == 0x05, "burst read decodes 0x01..0x06");
+    check(tp.stats().transactions == 1, "one transaction per sample");
+
+    reset(tp);
+    tp.setBurstRead(false);
+    check(touch(tp, &x, &y, &g) && x == 0x123 && y == 0x45 && g == 0x05, "per-register read decodes the same");
+
+    reset(tp);
+    Wire.faults = {MockWire::Fault::Nak};
+    check(touch(tp), "NAK is retried");
+    check(tp.stats().naks == 1 && tp.stats().transactions == 2, "NAK counted once");
+
+    reset(tp);
+    Wire.faults = {MockWire::Fault::Short};
+    check(touch(tp), "short read is retried");
+    check(tp.stats().short_reads == 1 && Wire.rx.empty(), "short read counted and drained");
+
+    reset(tp);
+    Wire.faults.assign(CST820_I2C_RETRY + 1, MockWire::Fault::Nak);
+    g = 0xFF;
+    check(!touch(tp, nullptr, nullptr, &g) && g == 0, "failed sample reads as released");
+    check(tp.stats().naks == CST820_I2C_RETRY + 1, "all attempts used");
+
+    // 6ms ずつかかるタイムアウトが2回で 10ms の上限に達する。数えるのは2回だけ
+    reset(tp);
+    Wire.faults.assign(4, MockWire::Fault::Timeout);
+    const uint32_t t0 = millis();
+    check(!touch(tp), "timeout gives up");
+    check(millis() - t0 < 2 * CST820_I2C_TIMEOUT_MS, "time budget bounds the read");
+    check(tp.stats().timeouts == 2, "each timeout counted once");
+
+    // NAK で連続失敗 → SDA は離れているので復旧は不要だが、Wire は掛け直されていること
+    reset(tp);
+    Wire.faults.assign(CST820_RECOVER_AFTER * (CST820_I2C_RETRY + 1), MockWire::Fault::Nak);
+    for (int i = 0; i < CST820_RECOVER_AFTER; ++i) touch(tp);
+    check(tp.stats().recoveries == 0, "free SDA is not counted as a recovery");
+    check(g_line.pins_stolen == 0, "pins touched only after Wire.end()");
+    check(Wire.began && !Wire.detached, "Wire re-attached after the check");
+    check(touch(tp, &x, &y) && x == 0x123, "bus works after repeated NAKs");
+
+    // SDA が3クロック張り付く → 9クロック以内に外れて STOP、次のサンプルは読める
+    reset(tp);
+    g_line.stuck_clocks = 3;
+    for (int i = 0; i < CST820_RECOVER_AFTER; ++i) touch(tp);
+    check(tp.stats().recoveries == 1, "stuck SDA recovered once");
+    check(g_line.scl_pulses == 3 + 1 && g_line.stops == 1, "clocks until released, then STOP");   // +1 は STOP の SCL
+    check(g_line.pins_stolen == 0 && Wire.began, "Wire released during recovery and re-attached");
+    check(touch(tp, &x, &y) && x == 0x123, "bus works after recovery");
+
+    // 外れない張り付きは 9 クロックで諦め、それでも Wire は戻す
+    reset(tp);
+    g_line.stuck_clocks = 100;
+    const int begins = Wire.begins;
+    for (int i = 0; i < CST820_RECOVER_AFTER; ++i) touch(tp);
+    check(g_line.scl_pulses == 9 + 1 && tp.stats().recoveries == 1, "gives up after 9 clocks");
+    check(Wire.began && Wire.begins == begins + 1, "Wire re-attached after a failed recovery");
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+// lib/TouchGesture に合成の点列を流し、タップ/ダブルタップ/長押し/4方向スワイプとフリック速度、慣性スクロールを確かめる
+//
+//   g++ -std=c++11 -O2 -I lib/TouchFilter -I lib/TouchGesture tools/gesture_synth.cpp lib/TouchGesture/TouchGesture.cpp -o gesture_synth
+//   ./gesture_synth
+//
+// 点列は 10ms 間隔（実機の read_cb と同じ）。時刻はテストごとに十分空けて、前のジェスチャの影響を残さない。
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "TouchGesture.h"
+
+static int failures = 0;
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+static const uint32_t kPeriod = 10;
+
+struct Feed {
+    TouchGesture g;
+    uint32_t t = 1000;
+    std::vector<TouchGestureEvent> events;
+
+    void sample(int x, int y, bool pressed) {
+        TouchPoint p = {(int16_t)x, (int16_t)y, pressed, t};
+        TouchGestureEvent ev;
+        if (g.update(p, &ev)) events.push_back(ev);
+        t += kPeriod;
+    }
+    // (x0,y0) から (x1,y1) へ ms かけて等速で動かす（押したまま）
+    void move(int x0, int y0, int x1, int y1, uint32_t ms) {
+        const uint32_t n = ms / kPeriod;
+        for (uint32_t i = 0; i <= n; ++i) sample(x0 + (x1 - x0) * (int)i / (int)n, y0 + (y1 - y0) * (int)i / (int)n, true);
+    }
+    void hold(int x, int y, uint32_t ms) { move(x, y, x, y, ms); }
+    void release(int x, int y) { sample(x, y, false); }
+    void idle(uint32_t ms) { t += ms; }
+
+    bool only(TouchGestureType type) const { return events.size() == 1 && events[0].type == type; }
+};
+
+static void test_taps() {
+    {
+        Feed f;
+        f.hold(100, 100, 100);
+        f.release(100, 100);
+        check(f.only(TouchGestureType::Tap), "tap");
+        check(f.only(TouchGestureType::Tap) && f.events[0].x == 100 && f.events[0].start_y == 100, "tap position");
+    }
+    {
+        Feed f;
+        f.move(100, 100, 104, 103, 80);   // tap_slop 以内の揺れ
+        f.release(104, 103);
+        check(f.only(TouchGestureType::Tap), "tap with jitter inside slop");
+    }
+    {
+        Feed f;
+        f.hold(100, 100, 400);            // tap_max を超えるが長押しには届かない
+        f.release(100, 100);
+        check(f.events.empty(), "slow press is neither tap nor long press");
+    }
+    {
+        Feed f;
+        f.hold(100, 100, 80);
+        f.release(100, 100);
+        f.idle(120);
+        f.hold(105, 102, 80);
+        f.release(105, 102);
+        check(f.events.size() == 2 && f.events[0].type == TouchGestureType::Tap &&
+              f.events[1].type == TouchGestureType::DoubleTap, "double tap (first tap also reported)");
+
+        // 3回目はもう一度タップから数える
+        f.idle(120);
+        f.hold(100, 100, 80);
+        f.release(100, 100);
+        check(f.events.size() == 3 && f.events[2].type == TouchGestureType::Tap, "third tap starts a new pair");
+    }
+    {
+        Feed f;
+        f.hold(100, 100, 80);
+        f.release(100, 100);
+        f.idle(500);                      // double_tap_gap を超える
+        f.hold(100, 100, 80);
+        f.release(100, 100);
+        check(f.events.size() == 2 && f.events[1].type == TouchGestureType::Tap, "slow second tap is a tap");
+    }
+    {
+        Feed f;
+        f.hold(50, 50, 80);
+        f.release(50, 50);
+        f.idle(100);
+        f.hold(250, 180, 80);             // 離れた位置
+        f.release(250, 180);
+        check(f.events.size() == 2 && f.events[1].type == TouchGestureType::Tap, "distant second tap is a tap");
+    }
+}
+
+static void test_long_press() {
+    Feed f;
+    uint32_t at = 0;
+    for (uint32_t ms = 0; ms <= 900; ms += kPeriod) {
+        const size_t before = f.events.size();
+        f.sample(160, 120, true);
+        if (f.events.size() > before && !at) at = ms;
+    }
+    f.release(160, 120);
+    check(f.only(TouchGestureType::LongPress), "long press reported once, nothing on release");
+    check(at >= 600 && at < 600 + 2 * kPeriod, "long press fires at long_press_ms while held");
+
+    Feed g;
+    g.move(160, 120, 200, 120, 700);      // 動いていれば長押しにしない
+    check(g.events.empty(), "moving press is not a long press");
+}
+
+static void test_swipes() {
+    struct Case { int dx, dy; TouchGestureType type; const char* name; };
+    const Case cases[] = {
+        {-120, 0, TouchGestureType::SwipeLeft, "swipe left"},
+        {120, 0, TouchGestureType::SwipeRight, "swipe right"},
+        {0, -100, TouchGestureType::SwipeUp, "swipe up"},
+        {0, 100, TouchGestureType::SwipeDown, "swipe down"},
+        {90, -60, TouchGestureType::SwipeRight, "diagonal picks the larger axis"},
+    };
+    for (const Case& c : cases) {
+        Feed f;
+        f.move(160, 120, 160 + c.dx, 120 + c.dy, 120);
+        f.release(160 + c.dx, 120 + c.dy);
+        check(f.only(c.type), c.name);
+    }
+
+    Feed slow;
+    slow.move(160, 120, 190, 120, 300);   // 30px を 100px/s: 距離も速度も足りない
+    slow.release(190, 120);
+    check(slow.events.empty(), "short slow drag is not a swipe");
+
+    Feed flick;
+    flick.move(160, 120, 185, 120, 50);   // 25px でも 500px/s なら速度で決まる
+    flick.release(185, 120);
+    check(flick.only(TouchGestureType::SwipeRight), "short fast flick is a swipe");
+}
+
+static void test_velocity() {
+    Feed f;
+    f.move(20, 200, 220, 100, 200);       // vx = +1000, vy = -500 [px/s]
+    int16_t px, py;
+    f.g.predict(50, &px, &py);
+    f.release(220, 100);
+    check(f.only(TouchGestureType::SwipeRight), "fling classified");
+    if (f.events.empty()) return;
+    const TouchGestureEvent& e = f.events[0];
+    printf("  fling v=(%.0f, %.0f) px/s, predict(+50ms)=(%d, %d)\n", e.vx, e.vy, px, py);
+    check(fabsf(e.vx - 1000.0f) < 50.0f && fabsf(e.vy + 500.0f) < 25.0f, "fling velocity within 5%");
+    check(abs(px - 270) <= 3 && abs(py - 75) <= 3, "predict follows the velocity");
+    check(e.start_x == 20 && e.start_y == 200 && e.x == 220 && e.y == 100, "swipe start and end");
+
+    // 止まってから離すと速度は 0 近く（スワイプは距離で決まる）
+    Feed g;
+    g.move(20, 120, 220, 120, 200);
+    g.hold(220, 120, 150);
+    g.release(220, 120);
+    check(g.only(TouchGestureType::SwipeRight) && fabsf(g.events[0].vx) < 1.0f, "velocity resets after the finger stops");
+}
+
+static void test_kinetic() {
+    KineticScroller k(325, 20);
+    k.fling(1000.0f);
+    int32_t total = 0, last = 1 << 30;
+    bool monotonic = true;
+    int steps = 0;
+    while (k.active() && steps < 1000) {
+        const int32_t d = k.step(16);
+        monotonic = monotonic && d <= last + 1;   // 繰り越しで 1px の揺れはある
+        last = d;
+        total += d;
+        ++steps;
+    }
+    printf("  kinetic: %ld px in %d frames\n", (long)total, steps);
+    check(!k.active(), "kinetic scroll stops");
+    // v*tau = 325px から、止める速度（20px/s）以下の残り 20*0.325 ≒ 6px を引いた程度
+    check(total >= 310 && total <= 325, "distance is about v * tau");
+    check(monotonic, "step size decays");
+
+    KineticScroller n(325, 20);
+    n.fling(-800.0f);
+    int32_t neg = 0;
+    for (int i = 0; i < 200 && n.active(); ++i) neg += n.step(16);
+    check(neg <= -250 && neg >= -260, "negative fling mirrors");
+
+    // 1ms 刻みでも小数部を繰り越すので総量は変わらない
+    KineticScroller fine(325, 20), coarse(325, 20);
+    fine.fling(600.0f);
+    coarse.fling(600.0f);
+    int32_t fsum = 0, csum = 0;
+    for (int i = 0; i < 320; ++i) fsum += fine.step(1);
+    for (int i = 0; i < 20; ++i) csum += coarse.step(16);
+    check(abs(fsum - csum) <= 2, "residual carries over small steps");
+
+    k.fling(1000.0f);
+    k.stop();
+    check(!k.active() && k.step(16) == 0, "stop() halts");
+}
+
+int main() {
+    test_taps();
+    test_long_press();
+    test_swipes();
+    test_velocity();
+    test_kinetic();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+// LVGL の確保トレースをホスト上で LvPool に流し、サイズクラスの有無で断片化と失敗を比べる
+//
+//   g++ -std=c++11 -O2 -I lib/LvPool tools/lv_pool_stress.cpp -o lv_pool_stress
+//   ./lv_pool_stress [--pool KB] [--check] log.txt   # 実機のシリアルログ（LV_POOL_TRACE=1 の [LVT] 行）
+//   ./lv_pool_stress [--pool KB] [--cycles N]        # 引数なしなら合成トレース（モーダルの生成と削除の繰り返し）
+//
+// 構成: slab512 / slab256 = サイズクラスあり（ページの目安 512 / 256B）、tlsf = TLSF だけ（LVGL 組み込みのプールに近い）
+// peak : 使用量の最大（ヘッダとページ込み）
+// frag : 1 - 最大の空きブロック / 空き合計。worst は全体の最大、end は最後
+// fail : 確保できなかった回数（同じトレースでも断片化で差が出る）
+// --check を付けると1操作ごとに構造の整合性と中身（確保ごとの模様）を確かめる
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "LvPoolCore.h"
+
+enum class OpKind : uint8_t { Alloc, Free, Realloc };
+
+struct Op {
+    OpKind kind;
+    uint32_t handle;     // 確保ごとの番号（realloc は同じ番号を引き継ぐ）
+    uint32_t size;
+};
+
+// [LVT] 行を読む。オフセットは生存中の確保の中でだけ一意なので、番号に付け替える
+static std::vector<Op> load(const char* path, uint32_t* handles) {
+    std::vector<Op> ops;
+    FILE* f = fopen(path, "r");
+    if (!f) { perror(path); exit(1); }
+    std::map<unsigned long, uint32_t> live;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        const char* p = strstr(line, "[LVT] ");
+        if (!p) continue;
+        p += 6;
+        unsigned long a = 0, b = 0;
+        unsigned size = 0;
+        if (p[0] == 'a' && sscanf(p + 1, "%lx %u", &a, &size) == 2) {
+            if (a == 0xFFFFFFFFul) continue;    // 実機で失敗した確保
+            live[a] = *handles;
+            ops.push_back({OpKind::Alloc, (*handles)++, size});
+        } else if (p[0] == 'f' && sscanf(p + 1, "%lx", &a) == 1) {
+            auto it = live.find(a);
+            if (it == live.end()) continue;
+            ops.push_back({OpKind::Free, it->second, 0});
+            live.erase(it);
+        } else if (p[0] == 'r' && sscanf(p + 1, "%lx %lx %u", &a, &b, &size) == 3) {
+            if (b == 0xFFFFFFFFul) continue;
+            uint32_t h;
+            auto it = live.find(a);
+            if (it == live.end()) {
+                h = (*handles)++;
+                ops.push_back({OpKind::Alloc, h, size});
+            } else {
+                h = it->second;
+                live.erase(it);
+                ops.push_back({OpKind::Realloc, h, size});
+            }
+            live[b] = h;
+        }
+    }
+    fclose(f);
+    return ops;
+}
+
+// LVGL v8（32bit）らしい確保の並び:
+//   常駐の画面（オブジェクト・スタイル配列・ラベル文字列）を作ってから、
+//   キーボード付きのモーダルを作って文字を打ち、閉じる、を繰り返す。その間に一覧の行やステータスの文字列が入れ替わる
+class Synth {
+public:
+    Synth(uint32_t seed) : _rng(seed) {}
+
+    std::vector<Op> make(int cycles, uint32_t* handles) {
+        _handles = handles;
+        std::vector<uint32_t> screen, rows;
+        for (int i = 0; i < 40; ++i) obj(screen, i % 3 == 0);
+        const uint32_t status = alloc(24);
+        for (int c = 0; c < cycles; ++c) {
+            // 一覧の行（スキャンのたびに作り直す）
+            if (c % 5 == 0) {
+                for (uint32_t h : rows) free(h);
+                rows.clear();
+                const int n = 4 + rnd(12);
+                for (int i = 0; i < n; ++i) obj(rows, true);
+            }
+            // モーダル: 背景 + パネル + テキストエリア + キーボード（btnmatrix の map / ctrl 配列）+ ボタン
+            std::vector<uint32_t> modal;
+            for (int i = 0; i < 4; ++i) obj(modal, i == 2);
+            modal.push_back(alloc(4 * (40 + rnd(8))));
+            modal.push_back(alloc(2 * (40 + rnd(8))));
+            modal.push_back(alloc(176));    // 描画用の一時領域
+            uint32_t text = alloc(1);
+            const int typed = 4 + rnd(28);
+            for (int i = 0; i < typed; ++i) realloc(text, 2 + i);
+            modal.push_back(text);
+            for (int i = 0; i < 2; ++i) obj(modal, true);
+            realloc(status, 12 + rnd(48));
+            for (size_t i = modal.size(); i-- > 0;) free(modal[i]);
+        }
+        for (uint32_t h : rows) free(h);
+        for (size_t i = screen.size(); i-- > 0;) free(screen[i]);
+        free(status);
+        return std::move(_ops);
+    }
+
+private:
+    int rnd(int n) { return (int)(_rng() % (uint32_t)n); }
+
+    uint32_t alloc(uint32_t size) {
+        const uint32_t h = (*_handles)++;
+        _ops.push_back({OpKind::Alloc, h, size});
+        return h;
+    }
+    void realloc(uint32_t h, uint32_t size) { _ops.push_back({OpKind::Realloc, h, size}); }
+    void free(uint32_t h) { _ops.push_back({OpKind::Free, h, 0}); }
+
+    // lv_obj_t + spec_attr + スタイル配列（あれば文字列）
+    void obj(std::vector<uint32_t>& out, bool label) {
+        out.push_back(alloc(label ? 60 : 36));
+        out.push_back(alloc(28));
+        const uint32_t styles = alloc(8);
+        realloc(styles, 16);
+        out.push_back(styles);
+        if (rnd(4) == 0) out.push_back(alloc(12));    // イベント
+        if (label) out.push_back(alloc(4 + rnd(40)));
+    }
+
+    std::mt19937 _rng;
+    uint32_t* _handles = nullptr;
+    std::vector<Op> _ops;
+};
+
+struct Result {
+    uint32_t peak = 0, fail = 0, worst_frag = 0, end_frag = 0, end_largest = 0, pages_peak = 0;
+    double ns_per_op = 0;
+    bool ok = true;
+};
+
+static bool fill_ok(const uint8_t* p, size_t n, uint8_t v) {
+    for (size_t i = 0; i < n; ++i) if (p[i] != v) return false;
+    return true;
+}
+
+static Result run(const std::vector<Op>& ops, uint32_t handles, size_t pool_bytes, uint16_t page, bool check) {
+    Result r;
+    std::vector<uint8_t> mem(pool_bytes);
+    LvPoolCore pool;
+    pool.begin(mem.data(), mem.size(), page);
+    std::vector<uint8_t*> ptr(handles, nullptr);
+    std::vector<uint32_t> size(handles, 0);
+    lv_pool_stats_t st;
+    auto t0 = std::chrono::steady_clock::now();
+    for (const Op& op : ops) {
+        uint8_t*& p = ptr[op.handle];
+        uint32_t n = op.size;
+        const uint8_t pat = (uint8_t)(op.handle * 31 + 7);
+        if (check && p && !fill_ok(p, size[op.handle], pat)) { r.ok = false; break; }
+        switch (op.kind) {
+        case OpKind::Alloc:
+            p = (uint8_t*)pool.alloc(op.size);
+            break;
+        case OpKind::Realloc:
+            if (p) {
+                uint8_t* q = (uint8_t*)pool.realloc(p, op.size);
+                if (q) p = q;
+                else n = size[op.handle];    // 失敗時は元の領域が残る
+            } else {
+                p = (uint8_t*)pool.alloc(op.size);
+            }
+            break;
+        case OpKind::Free:
+            pool.free(p);
+            p = nullptr;
+            break;
+        }
+        size[op.handle] = p ? n : 0;
+        if (check) {
+            if (p) memset(p, pat, n);
+            if (!pool.check()) { r.ok = false; break; }
+        }
+        pool.stats(&st);
+        if (st.frag_pct > r.worst_frag) r.worst_frag = st.frag_pct;
+        if (st.slab_pages > r.pages_peak) r.pages_peak = st.slab_pages;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    pool.stats(&st);
+    r.peak = st.peak_used;
+    r.fail += st.failures;
+    r.end_frag = st.frag_pct;
+    r.end_largest = st.largest_free;
+    r.ns_per_op = ops.empty() ? 0 : std::chrono::duration<double, std::nano>(t1 - t0).count() / ops.size();
+    return r;
+}
+
+int main(int argc, char** argv) {
+    size_t pool_kb = 48;
+    int cycles = 2000;
+    bool check = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--pool") && i + 1 < argc) pool_kb = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--cycles") && i + 1 < argc) cycles = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--check")) check = true;
+        else path = argv[i];
+    }
+
+    uint32_t handles = 0;
+    std::vector<Op> ops = path ? load(path, &handles) : Synth(1).make(cycles, &handles);
+    printf("%s: %zu ops, pool %zu KB\n", path ? path : "synthetic", ops.size(), pool_kb);
+    printf("%-8s %8s %6s %10s %8s %10s %6s %8s\n", "config", "peakKB", "fail", "worst_frag", "end_frag",
+           "largestKB", "pages", "ns/op");
+    struct { const char* name; uint16_t page; } configs[] = {{"slab512", 512}, {"slab256", 256}, {"tlsf", 0}};
+    int rc = 0;
+    for (const auto& c : configs) {
+        const Result r = run(ops, handles, pool_kb * 1024, c.page, check);
+        printf("%-8s %8.1f %6u %9u%% %7u%% %10.1f %6u %8.0f%s\n", c.name, r.peak / 1024.0, r.fail, r.worst_frag,
+               r.end_frag, r.end_largest / 1024.0, r.pages_peak, r.ns_per_op, r.ok ? "" : "  CHECK FAILED");
+        if (!r.ok) rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,220 @@
+// lib/MetricsHttp の要求解析・応答組み立てをホストのループバックで試す
+//
+//   g++ -std=c++11 -O2 -pthread -I lib/MetricsHttp tools/metrics_loopback.cpp -o metrics_loopback
+//   ./metrics_loopback [回数]
+//
+// 127.0.0.1 の空きポートに MetricsServer と同じ手順（非ブロッキングで1接続ずつ、poll で読んで書く）の
+// スタブを立て、別スレッドの HTTP クライアントから次を確かめる:
+//   - GET /metrics が 200 で、Content-Length と本文が一致し、各行が Prometheus のテキスト形式になっている
+//   - 要求を1バイトずつ分けて送っても同じ応答になる
+//   - 404 / 405 / 431 の応答
+//   - 連続要求の応答時間（poll 1回あたりの最大時間も出す: LVGL のループを止めないことの目安）
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <regex>
+#include <string>
+#include <thread>
+
+#include "MetricsHttp.h"
+
+static uint64_t now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 端末側の wifi ビルドと同じ並びのダミー値
+static void fill(MetricsText& m, void*) {
+    static uint32_t n = 0;
+    ++n;
+    m.counter("jc_uptime_seconds", 1234 + n);
+    m.gauge("jc_heap_free_bytes", 123456);
+    m.gauge("jc_heap_largest_block_bytes", 65524);
+    m.gauge("jc_heap_dma_free_bytes", 98765);
+    m.type("jc_lvgl_fps", "gauge").value_milli("jc_lvgl_fps", 33333);
+    m.counter("jc_audio_underruns_total", 0);
+    m.type("jc_touch_errors_total", "counter")
+        .value("jc_touch_errors_total", 1, "kind", "nak")
+        .value("jc_touch_errors_total", 0, "kind", "short_read")
+        .value("jc_touch_errors_total", 2, "kind", "timeout");
+    m.gauge("jc_wifi_rssi_dbm", -61);
+}
+
+// MetricsServer::poll() と同じ流れを POSIX ソケットで
+struct StubServer {
+    int lfd = -1, cfd = -1;
+    uint16_t port = 0;
+    MetricsRequest req;
+    const char* tx = nullptr;
+    size_t tx_len = 0, tx_pos = 0;
+    char buf[METRICS_HTTP_BUF];
+    uint32_t requests = 0;
+    uint64_t poll_max_us = 0;
+
+    bool begin() {
+        lfd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in a = {};
+        a.sin_family = AF_INET;
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(lfd, (sockaddr*)&a, sizeof(a)) < 0 || listen(lfd, 4) < 0) return false;
+        socklen_t l = sizeof(a);
+        getsockname(lfd, (sockaddr*)&a, &l);
+        port = ntohs(a.sin_port);
+        fcntl(lfd, F_SETFL, O_NONBLOCK);
+        return true;
+    }
+
+    void close_client() {
+        ::close(cfd);
+        cfd = -1;
+        tx = nullptr;
+    }
+
+    void poll() {
+        const uint64_t t0 = now_us();
+        step();
+        const uint64_t dt = now_us() - t0;
+        if (dt > poll_max_us) poll_max_us = dt;
+    }
+
+    void step() {
+        if (cfd < 0) {
+            cfd = accept(lfd, nullptr, nullptr);
+            if (cfd < 0) return;
+            fcntl(cfd, F_SETFL, O_NONBLOCK);
+            req.reset();
+        }
+        if (!tx) {
+            char in[128];
+            ssize_t n;
+            while (req.state() == MetricsRequest::Incomplete && (n = recv(cfd, in, sizeof(in), 0)) > 0) {
+                req.feed(in, (size_t)n);
+            }
+            if (req.state() == MetricsRequest::Incomplete) return;
+            tx_len = metrics_http_build(buf, sizeof(buf), req, fill, nullptr, &tx);
+            tx_pos = 0;
+            ++requests;
+        }
+        const ssize_t n = send(cfd, tx + tx_pos, tx_len - tx_pos, MSG_NOSIGNAL);
+        if (n > 0) tx_pos += (size_t)n;
+        if (tx_pos >= tx_len) close_client();
+    }
+};
+
+struct Response {
+    int status = 0;
+    size_t content_length = 0;
+    std::string body;
+};
+
+static bool fetch(uint16_t port, const std::string& request, bool dribble, Response* r) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_port = htons(port);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&a, sizeof(a)) < 0) { close(fd); return false; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (dribble) {
+        for (char c : request) {
+            send(fd, &c, 1, MSG_NOSIGNAL);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    } else {
+        send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+    }
+    std::string all;
+    char tmp[1024];
+    ssize_t n;
+    while ((n = recv(fd, tmp, sizeof(tmp), 0)) > 0) all.append(tmp, (size_t)n);
+    close(fd);
+    const size_t he = all.find("\r\n\r\n");
+    if (he == std::string::npos || all.compare(0, 9, "HTTP/1.0 ") != 0) return false;
+    r->status = atoi(all.c_str() + 9);
+    const size_t cl = all.find("Content-Length: ");
+    r->content_length = cl < he ? (size_t)atol(all.c_str() + cl + 16) : 0;
+    r->body = all.substr(he + 4);
+    return true;
+}
+
+static int failures = 0;
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+static bool valid_exposition(const std::string& body) {
+    static const std::regex type_re("# TYPE [a-zA-Z_:][a-zA-Z0-9_:]* (gauge|counter)");
+    static const std::regex sample_re("[a-zA-Z_:][a-zA-Z0-9_:]*(\\{[a-zA-Z_][a-zA-Z0-9_]*=\"[^\"]*\"\\})? -?[0-9]+(\\.[0-9]+)?");
+    size_t pos = 0;
+    int samples = 0;
+    while (pos < body.size()) {
+        size_t e = body.find('\n', pos);
+        if (e == std::string::npos) return false;   // 最終行も改行で終わる
+        const std::string line = body.substr(pos, e - pos);
+        if (line.compare(0, 2, "# ") == 0) {
+            if (!std::regex_match(line, type_re)) return false;
+        } else {
+            if (!std::regex_match(line, sample_re)) return false;
+            ++samples;
+        }
+        pos = e + 1;
+    }
+    return samples > 0;
+}
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? atoi(argv[1]) : 200;
+    StubServer srv;
+    if (!srv.begin()) { perror("bind"); return 1; }
+    printf("stub on 127.0.0.1:%u\n", srv.port);
+
+    std::atomic<bool> done(false);
+    std::thread server([&] {
+        while (!done) {
+            srv.poll();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    Response r;
+    check(fetch(srv.port, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n", false, &r) && r.status == 200, "GET /metrics 200");
+    check(r.content_length == r.body.size(), "Content-Length matches body");
+    check(valid_exposition(r.body), "body is Prometheus text format");
+    const std::string first = r.body;
+
+    check(fetch(srv.port, "GET /metrics?x=1 HTTP/1.1\r\nHost: x\r\nAccept: */*\r\n\r\n", true, &r) && r.status == 200 &&
+          valid_exposition(r.body), "request split into 1-byte writes");
+    check(fetch(srv.port, "GET /nope HTTP/1.0\r\n\r\n", false, &r) && r.status == 404, "unknown path 404");
+    check(fetch(srv.port, "POST /metrics HTTP/1.0\r\n\r\n", false, &r) && r.status == 405, "POST 405");
+    check(fetch(srv.port, "GET /metrics HTTP/1.0\r\nX: " + std::string(600, 'a') + "\r\n\r\n", false, &r) &&
+          r.status == 431, "oversized request 431");
+
+    uint64_t sum = 0, worst = 0;
+    int ok = 0;
+    for (int i = 0; i < rounds; ++i) {
+        const uint64_t t0 = now_us();
+        if (fetch(srv.port, "GET /metrics HTTP/1.0\r\n\r\n", false, &r) && r.status == 200) ++ok;
+        const uint64_t dt = now_us() - t0;
+        sum += dt;
+        if (dt > worst) worst = dt;
+    }
+    check(ok == rounds, "sequential requests");
+    done = true;
+    server.join();
+
+    printf("body %zu bytes (buffer %d), %d requests: avg=%lluus max=%lluus, poll max=%lluus\n",
+           first.size(), METRICS_HTTP_BUF, rounds, (unsigned long long)(rounds ? sum / rounds : 0),
+           (unsigned long long)worst, (unsigned long long)srv.poll_max_us);
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+// lib/MqttTelemetry のペイロード・オフラインキュー・送信をホストで測る
+//
+//   g++ -std=c++11 -O2 -I lib/MqttTelemetry tools/mqtt_bench.cpp -o mqtt_bench
+//   mosquitto -p 1883 &                       # ローカルのブローカー
+//   ./mqtt_bench [--broker 127.0.0.1:1883] [--batches 2000] [--offline-hours 24] [--queue-kb 8]
+//
+//   1. ペイロード: 30 サンプルのバッチを CBOR にした大きさと、同じ内容の JSON との比較
+//   2. オフライン: ブローカーに届かないまま --offline-hours 分のサンプルを積んだときのキューの使用量（上限に張り付くこと）と捨てた件数
+//   3. ブローカー: 同じトピックを購読した接続を別に開き、--batches 件を送って受信できた件数・内容の一致・スループットを出す
+//      （ブローカーが無ければ 3 は飛ばす）
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "TelemetryBatch.h"
+#include "TelemetryQueue.h"
+#include "MqttPacket.h"
+
+static double now_s() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// それらしい値の変化を付けたサンプル
+static TelemetrySample make_sample(uint32_t i) {
+    TelemetrySample s;
+    s.t_ms = 1000 * i;
+    s.heap_free = 152000 - (i * 37) % 4000;
+    s.heap_largest = 65524 - (i % 7) * 512;
+    s.audio_underruns = i % 97 == 0 ? 1 : 0;
+    s.audio_buf = 16384 + (i * 131) % 8192;
+    s.touch_presses = (i / 5) % 3;
+    s.touch_errors = i % 211 == 0 ? 1 : 0;
+    s.rssi = -55 - (int32_t)(i % 9);
+    return s;
+}
+
+static size_t make_batch(uint32_t seq, uint8_t* buf, size_t cap, std::string* json) {
+    TelemetryBatch b;
+    for (uint32_t i = 0; i < TELEMETRY_BATCH_MAX; ++i) b.add(make_sample(seq * TELEMETRY_BATCH_MAX + i));
+    if (json) {
+        // 比較用: サンプルごとのオブジェクトを並べた素直な JSON
+        char tmp[256];
+        *json = "{\"v\":1,\"id\":\"cyd-bench\",\"seq\":" + std::to_string(seq) + ",\"s\":[";
+        for (uint32_t i = 0; i < TELEMETRY_BATCH_MAX; ++i) {
+            TelemetrySample s = make_sample(seq * TELEMETRY_BATCH_MAX + i);
+            snprintf(tmp, sizeof(tmp), "%s{\"t\":%u,\"heap\":%u,\"lb\":%u,\"ur\":%u,\"ab\":%u,\"tp\":%u,\"te\":%u,\"rssi\":%d}",
+                     i ? "," : "", s.t_ms, s.heap_free, s.heap_largest, s.audio_underruns, s.audio_buf,
+                     s.touch_presses, s.touch_errors, s.rssi);
+            *json += tmp;
+        }
+        *json += "]}";
+    }
+    return b.encode(buf, cap, "cyd-bench", seq);
+}
+
+static int tcp_connect(const std::string& host, uint16_t port) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0) return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(fd, res->ai_addr, res->ai_addrlen) < 0) { close(fd); fd = -1; }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static bool send_all(int fd, const uint8_t* p, size_t n) {
+    while (n) {
+        ssize_t k = send(fd, p, n, MSG_NOSIGNAL);
+        if (k <= 0) return false;
+        p += k;
+        n -= (size_t)k;
+    }
+    return true;
+}
+
+// 1パケット読む（timeout_ms で諦める）
+struct Reader {
+    int fd;
+    std::vector<uint8_t> buf;
+    bool next(uint8_t* type, std::vector<uint8_t>* body, int timeout_ms) {
+        for (;;) {
+            const uint8_t* b;
+            uint32_t bl;
+            size_t total;
+            if (mqtt_parse(buf.data(), buf.size(), type, &b, &bl, &total)) {
+                body->assign(b, b + bl);
+                buf.erase(buf.begin(), buf.begin() + total);
+                return true;
+            }
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, timeout_ms) <= 0) return false;
+            uint8_t tmp[4096];
+            ssize_t k = recv(fd, tmp, sizeof(tmp), 0);
+            if (k <= 0) return false;
+            buf.insert(buf.end(), tmp, tmp + k);
+        }
+    }
+};
+
+static int mqtt_open(const std::string& host, uint16_t port, const char* id, Reader* rd) {
+    int fd = tcp_connect(host, port);
+    if (fd < 0) return -1;
+    uint8_t buf[64];
+    send_all(fd, buf, mqtt_connect(buf, id, 60));
+    rd->fd = fd;
+    uint8_t type;
+    std::vector<uint8_t> body;
+    if (!rd->next(&type, &body, 2000) || type != MQTT_CONNACK || body.size() != 2 || body[1] != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    std::string host = "127.0.0.1";
+    uint16_t port = 1883;
+    int batches = 2000;
+    double offline_hours = 24;
+    int queue_kb = 8;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string a = argv[i];
+        if (a == "--broker") {
+            std::string v = argv[i + 1];
+            size_t c = v.find(':');
+            host = v.substr(0, c);
+            if (c != std::string::npos) port = (uint16_t)atoi(v.c_str() + c + 1);
+        } else if (a == "--batches") batches = atoi(argv[i + 1]);
+        else if (a == "--offline-hours") offline_hours = atof(argv[i + 1]);
+        else if (a == "--queue-kb") queue_kb = atoi(argv[i + 1]);
+    }
+
+    // 1. ペイロード
+    uint8_t payload[1024];
+    std::string json;
+    const size_t cbor = make_batch(0, payload, sizeof(payload), &json);
+    printf("[payload] %d samples: cbor=%zuB (%.1fB/sample) json=%zuB (%.1fx)\n", TELEMETRY_BATCH_MAX, cbor,
+           (double)cbor / TELEMETRY_BATCH_MAX, json.size(), (double)json.size() / cbor);
+
+    // 2. オフライン（ブローカーに届かないまま積み続ける）
+    {
+        std::vector<uint8_t> storage((size_t)queue_kb * 1024);
+        TelemetryQueue q(storage.data(), storage.size());
+        const uint32_t n = (uint32_t)(offline_hours * 3600 / TELEMETRY_BATCH_MAX);
+        for (uint32_t seq = 0; seq < n; ++seq) {
+            size_t len = make_batch(seq, payload, sizeof(payload), nullptr);
+            q.push(payload, len);
+        }
+        TelemetryQueueStats s = q.stats();
+        printf("[offline] %.1fh (%u batches) queue=%uKB: used=%uB high_water=%uB kept=%u (%.1f min) dropped=%u\n",
+               offline_hours, n, queue_kb, s.used, s.high_water, s.count,
+               s.count * TELEMETRY_BATCH_MAX / 60.0, s.dropped);
+        if (s.high_water > s.cap) { printf("FAIL high_water over cap\n"); return 1; }
+    }
+
+    // 3. ブローカー
+    Reader sub_rd, pub_rd;
+    const int sub = mqtt_open(host, port, "jc-bench-sub", &sub_rd);
+    const int pub = sub >= 0 ? mqtt_open(host, port, "jc-bench-pub", &pub_rd) : -1;
+    if (sub < 0 || pub < 0) {
+        printf("[broker] %s:%u not reachable, skipped\n", host.c_str(), port);
+        return 0;
+    }
+    const char* topic = "jc2432/bench/telemetry";
+    uint8_t buf[128];
+    send_all(sub, buf, mqtt_subscribe(buf, 1, topic));
+    uint8_t type;
+    std::vector<uint8_t> body;
+    if (!sub_rd.next(&type, &body, 2000) || type != MQTT_SUBACK) { printf("FAIL no SUBACK\n"); return 1; }
+
+    std::vector<std::vector<uint8_t>> sent;
+    size_t bytes = 0;
+    const double t0 = now_s();
+    for (int seq = 0; seq < batches; ++seq) {
+        const size_t len = make_batch((uint32_t)seq, payload, sizeof(payload), nullptr);
+        const size_t h = mqtt_publish_header(buf, topic, len);
+        if (!send_all(pub, buf, h) || !send_all(pub, payload, len)) { printf("FAIL publish\n"); return 1; }
+        sent.emplace_back(payload, payload + len);
+        bytes += h + len;
+    }
+    const double t_pub = now_s() - t0;
+    int received = 0, mismatched = 0;
+    while (received < batches && sub_rd.next(&type, &body, 3000)) {
+        if (type != MQTT_PUBLISH) continue;
+        const size_t tl = ((size_t)body[0] << 8) | body[1];
+        std::vector<uint8_t> p(body.begin() + 2 + tl, body.end());
+        if (p != sent[received]) ++mismatched;
+        ++received;
+    }
+    const double t_all = now_s() - t0;
+    printf("[broker] %s:%u sent=%d received=%d mismatched=%d | publish %.0f msg/s %.1f KB/s | end-to-end %.0f msg/s (%.0f samples/s)\n",
+           host.c_str(), port, batches, received, mismatched, batches / t_pub, bytes / 1024.0 / t_pub,
+           received / t_all, received * (double)TELEMETRY_BATCH_MAX / t_all);
+    send_all(pub, buf, mqtt_disconnect(buf));
+    send_all(sub, buf, mqtt_disconnect(buf));
+    close(pub);
+    close(sub);
+    return (received == batches && !mismatched) ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+# OtaUpdate 用のイメージを作る（標準ライブラリのみ）
+#
+#   python3 tools/ota_pack.py .pio/build/esp32dev/firmware.bin [-o fw.ota] [--store] [--level 9]
+#   python3 -m http.server 8000        # 出力したディレクトリで。wifi ビルドの OTA_URL に指定
+#
+# 形式は lib/OtaUpdate/OtaImage.h を参照。既定は zlib 圧縮。
+#   --store   圧縮しないイメージ（比較用の基準）。fw.ota と fw.raw.ota を両方置き、
+#             OTA_URL を切り替えて [OTA] の total= を比べる
+
+import argparse
+import hashlib
+import struct
+import zlib
+
+MAGIC = b"JOT1"
+
+
+def pack(raw, store, level):
+    body = raw if store else zlib.compress(raw, level)
+    head = struct.pack("<4sBBHII32s", MAGIC, 1, 0 if store else 1, 0, len(raw), len(body),
+                       hashlib.sha256(raw).digest())
+    return head + struct.pack("<I", zlib.crc32(head) & 0xFFFFFFFF) + body
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("firmware")
+    ap.add_argument("-o", "--output")
+    ap.add_argument("--store", action="store_true")
+    ap.add_argument("--level", type=int, default=9)
+    args = ap.parse_args()
+
+    with open(args.firmware, "rb") as f:
+        raw = f.read()
+    out = args.output
+    if not out:
+        base = args.firmware[:-4] if args.firmware.endswith(".bin") else args.firmware
+        out = base + (".raw.ota" if args.store else ".ota")
+    img = pack(raw, args.store, args.level)
+    with open(out, "wb") as f:
+        f.write(img)
+    print("%s: %d -> %d bytes (%.1f%%)" % (out, len(raw), len(img), 100.0 * len(img) / len(raw)))
+
+
+if __name__ == "__main__":
+    main()
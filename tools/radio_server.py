@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# RadioStream の試験用 HTTP/ICY サーバ（標準ライブラリのみ）
+#
+#   python3 tools/radio_server.py DIR [--port 8000] [--kbps 128] [--metaint 8192]
+#                                     [--stall-every 30 --stall-secs 4] [--drop-every 0]
+#   -> http://<ホストのIP>:8000/<ファイル名>   （wifi ビルドの RADIO_URL に指定）
+#
+# DIR 内の .mp3 / .aac をループ再生で流し続ける。
+#   --kbps         送出レートを制限する（0 で無制限。実際の放送と同じく実時間で流す）
+#   --metaint      Icy-MetaData: 1 の要求に ICY メタデータを挟む間隔（StreamTitle はファイル名）
+#   --stall-every  N 秒ごとに --stall-secs 秒送信を止める（WiFi の途切れの再現。バッファで耐えるか見る）
+#   --drop-every   N 秒ごとに接続を切る（再接続の確認）
+#   /redirect/<名前> は 302 で /<名前> へ飛ばす（リダイレクトの確認）
+
+import argparse
+import os
+import socketserver
+import time
+from http.server import BaseHTTPRequestHandler
+
+TYPES = {".mp3": "audio/mpeg", ".aac": "audio/aac"}
+
+
+def icy_block(title):
+    meta = ("StreamTitle='%s';" % title).encode("utf-8")
+    n = (len(meta) + 15) // 16
+    return bytes([n]) + meta.ljust(n * 16, b"\0")
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"
+
+    def do_GET(self):
+        args = self.server.args
+        path = self.path.lstrip("/")
+        if path.startswith("redirect/"):
+            self.send_response(302)
+            self.send_header("Location", "http://%s/%s" % (self.headers.get("Host", ""), path[9:]))
+            self.end_headers()
+            return
+        file = os.path.join(args.dir, os.path.basename(path))
+        ext = os.path.splitext(file)[1].lower()
+        if ext not in TYPES or not os.path.isfile(file):
+            self.send_error(404)
+            return
+        icy = self.headers.get("Icy-MetaData") == "1" and args.metaint > 0
+        self.send_response(200)
+        self.send_header("Content-Type", TYPES[ext])
+        self.send_header("icy-name", "radio_server")
+        if icy:
+            self.send_header("icy-metaint", str(args.metaint))
+        self.end_headers()
+
+        with open(file, "rb") as f:
+            data = f.read()
+        title = os.path.basename(file)
+        rate = args.kbps * 1000 // 8
+        chunk = 1024
+        pos = 0
+        until_meta = args.metaint
+        sent = 0
+        t0 = time.monotonic()
+        next_stall = t0 + args.stall_every if args.stall_every else None
+        next_drop = t0 + args.drop_every if args.drop_every else None
+        loop = 0
+        try:
+            while True:
+                now = time.monotonic()
+                if next_drop and now >= next_drop:
+                    self.log_message("drop")
+                    return
+                if next_stall and now >= next_stall:
+                    self.log_message("stall %.1fs", args.stall_secs)
+                    time.sleep(args.stall_secs)
+                    next_stall = time.monotonic() + args.stall_every
+                    # 止めていた分は追いつかせない（放送と同じく欠ける）
+                    t0 += args.stall_secs
+                n = min(chunk, len(data) - pos)
+                if icy:
+                    n = min(n, until_meta)
+                out = data[pos:pos + n]
+                pos += n
+                if pos >= len(data):
+                    pos = 0
+                    loop += 1
+                if icy:
+                    until_meta -= n
+                    if until_meta == 0:
+                        out += icy_block("%s #%d" % (title, loop))
+                        until_meta = args.metaint
+                self.wfile.write(out)
+                sent += n
+                if rate:
+                    ahead = sent / rate - (time.monotonic() - t0)
+                    if ahead > 0:
+                        time.sleep(ahead)
+        except (BrokenPipeError, ConnectionResetError):
+            self.log_message("client closed after %d bytes", sent)
+
+
+class Server(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("dir")
+    ap.add_argument("--port", type=int, default=8000)
+    ap.add_argument("--kbps", type=int, default=128)
+    ap.add_argument("--metaint", type=int, default=8192)
+    ap.add_argument("--stall-every", type=float, default=0)
+    ap.add_argument("--stall-secs", type=float, default=4)
+    ap.add_argument("--drop-every", type=float, default=0)
+    args = ap.parse_args()
+    srv = Server(("", args.port), Handler)
+    srv.args = args
+    print("serving %s on :%d (%d kbps)" % (args.dir, args.port, args.kbps))
+    srv.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
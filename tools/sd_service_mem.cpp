@@ -0,0 +1,123 @@
+// SdService の要求実行部（sd_service_execute）を SdMemBackend に繋いで確かめる。
+// タッチトレースの記録（ヘッダ Write → チャンク Append）と再生（オフセット付き Read の先読み）も同じ経路で通す。
+//
+//   g++ -std=c++11 -O2 -I lib/SdService -I lib/TouchTrace tools/sd_service_mem.cpp lib/SdService/SdService.cpp -o sd_service_mem
+//   ./sd_service_mem
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SdMemBackend.h"
+#include "SdService.h"
+#include "TouchTrace.h"
+
+static int failures = 0;
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+static SdResult run(SdBackend& be, SdOp op, const char* path, uint32_t offset, void* buf, size_t len) {
+    SdRequest req = {};
+    req.op = op;
+    strncpy(req.path, path, SD_SERVICE_PATH_MAX - 1);
+    req.offset = offset;
+    req.buf = static_cast<uint8_t*>(buf);
+    req.len = len;
+    return sd_service_execute(be, req);
+}
+
+static void test_ops() {
+    SdMemBackend be;
+    char a[] = "hello", b[] = "world!";
+    SdResult r = run(be, SdOp::Write, "/a.txt", 0, a, 5);
+    check(r.ok && r.bytes == 5 && r.op == SdOp::Write, "write creates the file");
+    r = run(be, SdOp::Append, "/a.txt", 0, b, 6);
+    check(r.ok && be.files()["/a.txt"] == "helloworld!", "append adds to the end");
+    r = run(be, SdOp::Write, "/a.txt", 0, a, 3);
+    check(r.ok && be.files()["/a.txt"] == "hel", "write truncates");
+
+    char buf[8] = {};
+    run(be, SdOp::Write, "/a.txt", 0, b, 6);
+    r = run(be, SdOp::Read, "/a.txt", 2, buf, 3);
+    check(r.ok && r.bytes == 3 && memcmp(buf, "rld", 3) == 0, "read at offset");
+    r = run(be, SdOp::Read, "/a.txt", 4, buf, sizeof(buf));
+    check(r.ok && r.bytes == 2, "read is short at EOF");
+    r = run(be, SdOp::Read, "/a.txt", 6, buf, sizeof(buf));
+    check(r.ok && r.bytes == 0, "read past EOF returns 0");
+    r = run(be, SdOp::Read, "/none", 0, buf, sizeof(buf));
+    check(!r.ok && r.bytes < 0, "missing file fails");
+
+    run(be, SdOp::Write, "/d/x", 0, a, 1);
+    run(be, SdOp::Write, "/d/yy", 0, a, 1);
+    char names[64];
+    r = run(be, SdOp::List, "/d", 0, names, sizeof(names));
+    check(r.ok && r.bytes == 2 && strcmp(names, "x\nyy\n") == 0, "list by prefix");
+    char tiny[4];
+    r = run(be, SdOp::List, "/d", 0, tiny, sizeof(tiny));
+    check(r.ok && r.bytes == 2 && strcmp(tiny, "x\n") == 0, "list counts names that do not fit");
+
+    r = run(be, SdOp::Remove, "/d/x", 0, nullptr, 0);
+    check(r.ok && !be.files().count("/d/x"), "remove");
+    r = run(be, SdOp::Remove, "/d/x", 0, nullptr, 0);
+    check(!r.ok, "remove of a missing file fails");
+}
+
+// TouchTraceRecorder / TouchTracePlayer と同じ単位で書いて読む
+static void test_trace() {
+    const size_t kRecChunk = 128, kPlayChunk = 64;
+    const char* path = "/touch.ctt";
+    SdMemBackend be;
+
+    TouchTraceHeader h;
+    touch_trace_init_header(&h, 1234);
+    check(run(be, SdOp::Write, path, 0, &h, sizeof(h)).ok, "trace header written");
+
+    // 満杯のチャンク2つと end() で出す端数
+    const size_t total = kRecChunk * 2 + 5;
+    std::vector<TouchTraceRecord> chunk;
+    bool ok = true;
+    for (size_t i = 0; i < total; ++i) {
+        TouchTraceSample s = {(uint32_t)(i * 10), (uint16_t)(i & 0xFFF), (uint16_t)(4095 - (i & 0xFFF)),
+                              (uint8_t)(i % 13), (i % 3) != 0};
+        chunk.push_back(touch_trace_encode(s));
+        if (chunk.size() == kRecChunk || i + 1 == total) {
+            ok = ok && run(be, SdOp::Append, path, 0, chunk.data(), chunk.size() * sizeof(TouchTraceRecord)).ok;
+            chunk.clear();
+        }
+    }
+    check(ok && be.files()[path].size() == sizeof(h) + total * sizeof(TouchTraceRecord), "trace chunks appended");
+
+    TouchTraceHeader rh;
+    SdResult r = run(be, SdOp::Read, path, 0, &rh, sizeof(rh));
+    check(r.bytes == (int32_t)sizeof(rh) && touch_trace_check_header(&rh) && rh.start_ms == 1234, "trace header reads back");
+
+    // 再生側: ヘッダの後ろから 64 件ずつ。満杯でない区間が末尾
+    TouchTraceRecord buf[kPlayChunk];
+    uint32_t off = sizeof(TouchTraceHeader);
+    size_t n = 0, reads = 0;
+    ok = true;
+    for (;;) {
+        r = run(be, SdOp::Read, path, off, buf, sizeof(buf));
+        if (!r.ok) { ok = false; break; }
+        const size_t got = (size_t)r.bytes / sizeof(TouchTraceRecord);
+        for (size_t i = 0; i < got; ++i, ++n) {
+            const TouchTraceSample s = touch_trace_decode(buf[i]);
+            ok = ok && s.t_ms == n * 10 && s.x == (n & 0xFFF) && s.y == 4095 - (n & 0xFFF) &&
+                 s.gesture == n % 13 && s.finger == ((n % 3) != 0);
+        }
+        ++reads;
+        off += sizeof(buf);
+        if (got < kPlayChunk) break;
+    }
+    check(ok && n == total, "trace reads back in order");
+    check(reads == (total + kPlayChunk - 1) / kPlayChunk, "short read marks the end");
+}
+
+int main() {
+    test_ops();
+    test_trace();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+// タッチトレースをホスト上で各フィルタ構成に通し、静止時ジッタと移動時ラグを比較する
+//
+//   g++ -std=c++11 -O2 -I lib/TouchFilter -I lib/TouchTrace tools/touch_replay.cpp -o touch_replay
+//   ./touch_replay touch.ctt      # 実機で記録した生トレース（TOUCH_TRACE_MODE=1）
+//   ./touch_replay trace.csv      # 1行 = t_ms,x,y,pressed（画面座標）
+//   ./touch_replay                # 引数なしなら合成トレース（ノイズ付きドラッグ）
+//
+// jitter: 指が止まっている区間での出力の揺れ（フレーム間移動量のRMS, px）
+// lag   : 指が動いている区間での出力と生座標の平均距離（px）
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "TouchFilter.h"
+#include "TouchTrace.h"
+
+using namespace touch_filter;
+
+static std::vector<TouchPoint> load(const char* path) {
+    std::vector<TouchPoint> v;
+    FILE* f = fopen(path, "rb");
+    if (!f) { perror(path); exit(1); }
+
+    TouchTraceHeader h;
+    if (fread(&h, sizeof(h), 1, f) == 1 && touch_trace_check_header(&h)) {
+        // 生座標を横向き画面座標へ（各ビルドの既定回転と同じ）
+        TouchTraceRecord r;
+        while (fread(&r, sizeof(r), 1, f) == 1) {
+            TouchTraceSample s = touch_trace_decode(r);
+            TouchPoint tp = {(int16_t)s.y, (int16_t)(240 - 1 - s.x), s.finger, s.t_ms};
+            v.push_back(tp);
+        }
+        fclose(f);
+        return v;
+    }
+    rewind(f);
+    unsigned t; int x, y, p;
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%u,%d,%d,%d", &t, &x, &y, &p) == 4) {
+            TouchPoint tp = {(int16_t)x, (int16_t)y, p != 0, t};
+            v.push_back(tp);
+        }
+    }
+    fclose(f);
+    return v;
+}
+
+// 静止 → 一定速度のドラッグ → 静止 を 10ms 周期で、±2px のノイズ付きで生成
+static std::vector<TouchPoint> synthetic() {
+    std::vector<TouchPoint> v;
+    srand(1);
+    uint32_t t = 0;
+    float x = 40, y = 120;
+    for (int i = 0; i < 300; ++i, t += 10) {
+        if (i >= 100 && i < 200) x += 2.0f;  // 200 px/s
+        TouchPoint p = {(int16_t)lroundf(x + rand() % 5 - 2), (int16_t)lroundf(y + rand() % 5 - 2), true, t};
+        v.push_back(p);
+    }
+    for (int i = 0; i < 10; ++i, t += 10) v.push_back(TouchPoint{0, 0, false, t});
+    return v;
+}
+
+struct Result { double jitter, lag; };
+
+template <typename Chain>
+static Result run(const std::vector<TouchPoint>& trace) {
+    Chain chain;
+    double jit2 = 0, lag = 0;
+    int njit = 0, nlag = 0;
+    bool have_prev = false;
+    TouchPoint prev = {};
+    for (size_t i = 0; i < trace.size(); ++i) {
+        TouchPoint p = trace[i];
+        chain.process(p);
+        if (!p.pressed || !trace[i].pressed) { have_prev = false; continue; }
+        // 前後5サンプルの生座標の移動量で静止/移動を判定
+        size_t a = i >= 5 ? i - 5 : 0, b = i + 5 < trace.size() ? i + 5 : trace.size() - 1;
+        double span = hypot(trace[b].x - trace[a].x, trace[b].y - trace[a].y);
+        if (span < 6.0) {
+            if (have_prev) { jit2 += pow(p.x - prev.x, 2) + pow(p.y - prev.y, 2); ++njit; }
+        } else {
+            lag += hypot(p.x - trace[i].x, p.y - trace[i].y); ++nlag;
+        }
+        prev = p; have_prev = true;
+    }
+    Result r = {njit ? sqrt(jit2 / njit) : 0.0, nlag ? lag / nlag : 0.0};
+    return r;
+}
+
+template <typename Chain>
+static void report(const char* name, const std::vector<TouchPoint>& trace) {
+    Result r = run<Chain>(trace);
+    printf("%-28s jitter=%6.2f px  lag=%6.2f px\n", name, r.jitter, r.lag);
+}
+
+int main(int argc, char** argv) {
+    std::vector<TouchPoint> trace = argc > 1 ? load(argv[1]) : synthetic();
+    printf("samples=%u\n", (unsigned)trace.size());
+    report<TouchFilterChain<>>("raw", trace);
+    report<TouchFilterChain<Debounce<2, 2>, Deadzone<3>, Ema<64>>>("legacy (deadzone+ema 1/4)", trace);
+    report<TouchFilterChain<Debounce<1, 2>, Deadzone<2>>>("deadzone 2", trace);
+    report<TouchFilterChain<Debounce<1, 2>, OneEuro<1000, 7>>>("1euro 1.0Hz b=0.007", trace);
+    report<TouchFilterChain<Debounce<1, 2>, OneEuro<1000, 50>>>("1euro 1.0Hz b=0.05", trace);
+    report<TouchFilterChain<Debounce<1, 2>, Deadzone<2>, OneEuro<1000, 50>>>("deadzone 2 + 1euro (default)", trace);
+    report<TouchFilterChain<Debounce<1, 2>, AlphaBeta<128, 32, 0>>>("alpha-beta", trace);
+    report<TouchFilterChain<Debounce<1, 2>, AlphaBeta<128, 32, 16>>>("alpha-beta predict 16ms", trace);
+    return 0;
+}
@@ -0,0 +1,239 @@
+// lib/WifiConn/WifiConnMachine を偽のドライバ・イベント・時刻で動かし、接続の流れを確かめる
+//
+//   g++ -std=c++11 -O2 -I lib/WifiConn tools/wifi_conn_sim.cpp lib/WifiConn/WifiConnMachine.cpp -o wifi_conn_sim
+//   ./wifi_conn_sim
+//
+// Fast→Full のフォールバック、認証エラー、バックオフの間隔と上限、タイムアウト、cancel、再接続、millis() の一周を見る。
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "WifiConnMachine.h"
+
+static int failures = 0;
+static void check(bool ok, const char* what) {
+    printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+// 呼ばれた順に1文字ずつ記録する（f=begin_fast, F=begin_full, d=disconnect, c=connected）
+struct FakeDriver : WifiConnDriver {
+    bool cache = true;
+    std::string calls;
+    bool has_cache() override { return cache; }
+    void begin_fast() override { calls += 'f'; }
+    void begin_full() override { calls += 'F'; }
+    void disconnect() override { calls += 'd'; }
+    void connected() override { calls += 'c'; }
+};
+
+struct Sim {
+    FakeDriver drv;
+    WifiConnMachine m;
+    uint32_t now;
+    std::vector<WifiConnState> seen;
+
+    explicit Sim(bool cache, const WifiConnPolicy& p = WifiConnPolicy(), uint32_t t0 = 1000) : m(drv, p), now(t0) {
+        drv.cache = cache;
+        m.on_status([](const WifiConnStatus& st, void* user) { static_cast<Sim*>(user)->seen.push_back(st.state); }, this);
+    }
+    void start() { m.start(now); }
+    // ms 進めながら 10ms ごとに tick する
+    void run(uint32_t ms) {
+        for (uint32_t end = now + ms; now != end;) {
+            now += (end - now) < 10 ? (end - now) : 10;
+            m.tick(now);
+        }
+    }
+    void got_ip(uint32_t ip = 0x0101A8C0) { m.on_event(WifiConnEvent{WifiConnEventType::GotIp, 0, ip}, now); }
+    void disconnected(uint8_t reason) { m.on_event(WifiConnEvent{WifiConnEventType::Disconnected, reason, 0}, now); }
+    // Backoff に入ってから次の Full までの時間（上限 limit）
+    uint32_t backoff_len(uint32_t limit = 120000) {
+        uint32_t t = 0;
+        while (m.state() == WifiConnState::Backoff && t < limit) { run(10); t += 10; }
+        return t;
+    }
+};
+
+static void test_fast_path() {
+    Sim s(true);
+    s.start();
+    check(s.m.state() == WifiConnState::Fast && s.drv.calls == "f", "cache starts with Fast");
+    s.run(700);
+    s.got_ip();
+    const WifiConnStatus& st = s.m.status();
+    check(st.state == WifiConnState::Connected && st.via_cache && st.attempt == 0, "Fast connects via cache");
+    check(st.time_to_ip_ms == 700 && st.ip == 0x0101A8C0 && s.drv.calls == "fc", "time to IP and connected() recorded");
+    s.run(60000);
+    check(s.m.state() == WifiConnState::Connected, "connected state ignores the deadline");
+}
+
+static void test_fast_fallback() {
+    WifiConnPolicy p;
+    Sim s(true, p);
+    s.start();
+    s.run(p.fast_timeout_ms - 10);
+    check(s.m.state() == WifiConnState::Fast, "Fast waits until fast_timeout");
+    s.run(10);
+    check(s.m.state() == WifiConnState::Full && s.m.status().attempt == 1 && s.drv.calls == "fF",
+          "Fast timeout falls back to Full");
+    s.got_ip();
+    check(s.m.state() == WifiConnState::Connected && !s.m.status().via_cache &&
+          s.m.status().time_to_ip_ms == p.fast_timeout_ms, "Full connects, time counted from start()");
+
+    Sim d(true);
+    d.start();
+    d.disconnected(WIFI_CONN_REASON_NO_AP_FOUND);
+    check(d.m.state() == WifiConnState::Full && d.m.status().reason == WIFI_CONN_REASON_NO_AP_FOUND,
+          "stale cache (no AP) falls back to Full at once");
+
+    Sim n(false);
+    n.start();
+    check(n.m.state() == WifiConnState::Full && n.drv.calls == "F", "no cache starts with Full");
+}
+
+static void test_auth_fail() {
+    const uint8_t reasons[] = {WIFI_CONN_REASON_AUTH_FAIL, WIFI_CONN_REASON_AUTH_EXPIRE,
+                               WIFI_CONN_REASON_4WAY_TIMEOUT, WIFI_CONN_REASON_HANDSHAKE_TIMEOUT};
+    bool all = true;
+    for (uint8_t r : reasons) {
+        Sim s(false);
+        s.start();
+        s.disconnected(r);
+        all = all && s.m.state() == WifiConnState::Failed && s.m.status().fail == WifiConnFail::Auth &&
+              s.m.status().attempt == 1 && s.drv.calls == "Fd";
+        s.run(120000);
+        all = all && s.m.state() == WifiConnState::Failed && s.drv.calls == "Fd";
+    }
+    check(all, "auth errors fail without retry");
+
+    // Fast 中の認証エラーはキャッシュの問題かもしれないので Full で確かめ直す
+    Sim f(true);
+    f.start();
+    f.disconnected(WIFI_CONN_REASON_AUTH_FAIL);
+    check(f.m.state() == WifiConnState::Full, "auth error during Fast retries with Full");
+    f.disconnected(WIFI_CONN_REASON_AUTH_FAIL);
+    check(f.m.state() == WifiConnState::Failed && f.m.status().fail == WifiConnFail::Auth, "then fails on Full");
+}
+
+static void test_backoff() {
+    WifiConnPolicy p;   // base 1000, max 30000, retries 4
+    Sim s(false, p);
+    s.start();
+    std::vector<uint32_t> waits;
+    bool no_ap = true;
+    for (int i = 0; i < 10 && s.m.state() == WifiConnState::Full; ++i) {
+        s.disconnected(WIFI_CONN_REASON_NO_AP_FOUND);
+        if (s.m.state() != WifiConnState::Backoff) break;
+        no_ap = no_ap && s.m.status().fail == WifiConnFail::NoAp;
+        waits.push_back(s.backoff_len());
+    }
+    check(no_ap, "backoff records the reason");
+    printf("  backoff:");
+    for (uint32_t w : waits) printf(" %lu", (unsigned long)w);
+    printf(" ms\n");
+    check(waits == std::vector<uint32_t>({1000, 2000, 4000, 8000}), "backoff doubles from base");
+    check(s.m.state() == WifiConnState::Failed && s.m.status().fail == WifiConnFail::Retries &&
+          s.m.status().attempt == p.max_retries + 1, "gives up after max_retries");
+    check(s.drv.calls == "FFFFFd", "one begin_full per attempt");
+
+    WifiConnPolicy c;
+    c.backoff_base_ms = 10000;
+    c.backoff_max_ms = 25000;
+    c.max_retries = 5;
+    Sim m(false, c);
+    m.start();
+    waits.clear();
+    while (m.m.state() == WifiConnState::Full) {
+        m.disconnected(0);
+        if (m.m.state() != WifiConnState::Backoff) break;
+        waits.push_back(m.backoff_len());
+    }
+    check(waits == std::vector<uint32_t>({10000, 20000, 25000, 25000, 25000}), "backoff capped at backoff_max");
+}
+
+static void test_timeout() {
+    WifiConnPolicy p;
+    p.max_retries = 1;
+    Sim s(false, p);
+    s.start();
+    s.run(p.attempt_timeout_ms);
+    check(s.m.state() == WifiConnState::Backoff && s.m.status().fail == WifiConnFail::Timeout &&
+          s.drv.calls == "Fd", "attempt timeout disconnects and backs off");
+    s.backoff_len();
+    s.run(p.attempt_timeout_ms);
+    check(s.m.state() == WifiConnState::Failed && s.m.status().fail == WifiConnFail::Timeout, "last timeout fails as Timeout");
+}
+
+static void test_cancel() {
+    Sim s(false);
+    s.start();
+    s.disconnected(0);
+    check(s.m.state() == WifiConnState::Backoff, "in backoff");
+    s.m.cancel();
+    check(s.m.state() == WifiConnState::Idle && s.drv.calls == "Fd", "cancel disconnects");
+    s.run(120000);
+    s.got_ip();
+    check(s.m.state() == WifiConnState::Idle && s.drv.calls == "Fd", "nothing restarts after cancel");
+    const size_t n = s.seen.size();
+    s.m.cancel();
+    check(s.seen.size() == n && s.drv.calls == "Fd", "second cancel is a no-op");
+
+    Sim f(true);
+    f.start();
+    f.m.cancel();
+    f.run(10000);
+    check(f.m.state() == WifiConnState::Idle && f.drv.calls == "fd", "cancel during Fast stops the fallback");
+}
+
+static void test_reconnect() {
+    Sim s(true);
+    s.start();
+    s.got_ip();
+    s.run(5000);
+    s.disconnected(WIFI_CONN_REASON_ASSOC_LEAVE);
+    check(s.m.state() == WifiConnState::Connected, "own disconnect (ASSOC_LEAVE) ignored");
+    s.disconnected(0);
+    check(s.m.state() == WifiConnState::Fast && s.m.status().ip == 0 && s.drv.calls == "fcf", "link loss reconnects via Fast");
+    s.run(300);
+    s.got_ip();
+    check(s.m.status().time_to_ip_ms == 300, "reconnect time counted from the drop");
+
+    WifiConnPolicy p;
+    p.auto_reconnect = false;
+    Sim n(false, p);
+    n.start();
+    n.got_ip();
+    n.disconnected(0);
+    check(n.m.state() == WifiConnState::Idle && n.drv.calls == "Fc", "no auto_reconnect goes Idle");
+
+    const std::vector<WifiConnState> expect = {WifiConnState::Full, WifiConnState::Connected, WifiConnState::Idle};
+    check(n.seen == expect, "status callback per transition");
+}
+
+static void test_wrap() {
+    WifiConnPolicy p;
+    Sim s(true, p, 0xFFFFFFFFu - 1000);   // millis() が途中で一周する
+    s.start();
+    s.run(p.fast_timeout_ms - 10);
+    check(s.m.state() == WifiConnState::Fast, "no early timeout across wrap");
+    s.run(10);
+    check(s.m.state() == WifiConnState::Full, "timeout fires across wrap");
+    s.run(500);
+    s.got_ip();
+    check(s.m.status().time_to_ip_ms == p.fast_timeout_ms + 500, "time to IP across wrap");
+}
+
+int main() {
+    test_fast_path();
+    test_fast_fallback();
+    test_auth_fail();
+    test_backoff();
+    test_timeout();
+    test_cancel();
+    test_reconnect();
+    test_wrap();
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -1,10 +1,65 @@
 // WiFi SSID選択＆パスワード入力 → 接続
 
 #include <Arduino.h>
-#include "../include/LGFX_Driver.hpp"
+#include "BspLgfx.hpp"
 #include <lvgl.h>
+#include "LvPool.h"   // lv_conf.h の LV_MEM_CUSTOM のアロケータ
 #include <WiFi.h>
 #include "CST820.h"
+#include "TouchFilter.h"
+#include "TouchAffine.h"
+#include "TouchCalibUi.h"
+#include "LatencyProbe.h"
+#include "TouchGesture.h"
+#include "WifiScan.h"
+#include "LvVirtualList.h"
+#include "WifiCache.h"
+#include "WifiConn.h"
+#include <esp_heap_caps.h>
+
+// 1 でネットラジオ（RADIO_URL を HTTP/ICY で受けて I2S の PCM5102A に出す）
+#ifndef RADIO_ENABLE
+#define RADIO_ENABLE 0
+#endif
+// 1 で GET http://<IP>:9100/metrics（Prometheus テキスト）に状態を出す
+#ifndef METRICS_HTTP_ENABLE
+#define METRICS_HTTP_ENABLE 1
+#endif
+#if METRICS_HTTP_ENABLE
+#include "MetricsHttp.h"
+#endif
+
+// 1 で MQTT_BROKER へテレメトリ（CBOR のバッチ）を送る
+#ifndef TELEMETRY_MQTT_ENABLE
+#define TELEMETRY_MQTT_ENABLE 0
+#endif
+#if TELEMETRY_MQTT_ENABLE
+#include "MqttTelemetry.h"
+#ifndef MQTT_BROKER
+#define MQTT_BROKER "192.168.1.10"
+#endif
+#ifndef MQTT_PORT
+#define MQTT_PORT 1883
+#endif
+// まとめて送る間隔 [ms]
+#ifndef TELEMETRY_BATCH_MS
+#define TELEMETRY_BATCH_MS 10000
+#endif
+static MqttTelemetry telemetry;
+#endif
+
+// OTA 更新のイメージ（tools/ota_pack.py）。空ならボタンを出さない
+#ifndef OTA_URL
+#define OTA_URL ""
+#endif
+#include "OtaUpdate.h"
+
+#if RADIO_ENABLE
+#include "RadioStream.h"
+#ifndef RADIO_URL
+#define RADIO_URL "http://192.168.1.10:8000/test.mp3"
+#endif
+#endif
 
 static LGFX tft;
 
@@ -15,21 +70,38 @@ extern "C" uint32_t lvgl_tick_get_cb(void) { return millis(); }
 #endif
 static lv_color_t lvbuf1[320 * LV_LINES];
 
+// タッチ生座標 → 画面座標（既定は横向き: sx = ry, sy = 239 - rx。NVS にキャリブレーション結果があれば置き換える）
+static TouchAffine touch_cal = touch_affine_make(0, 1, 0, -1, 0, 240 - 1);
+
+// 押下中は指の速度から TOUCH_PREDICT_MS 先の位置を LVGL に渡し、描画遅延分の追従遅れを打ち消す（0 で無効）
+#ifndef TOUCH_PREDICT_MS
+#define TOUCH_PREDICT_MS 16
+#endif
+static TouchGesture gesture;
+static KineticScroller kinetic;   // SSIDリストのフリック慣性（LVGL標準の慣性の代わり）
+
 static void lvgl_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p) {
   uint32_t w = (area->x2 - area->x1 + 1);
   uint32_t h = (area->y2 - area->y1 + 1);
   // color_p は先頭画素へのポインタなので、そのまま16bit配列として渡す
   tft.pushImage(area->x1, area->y1, w, h, reinterpret_cast<const uint16_t*>(color_p), false /*swapBytes*/);
+  LATENCY_PROBE_FLUSH(lv_scr_act(), lv_disp_flush_is_last(disp));
   lv_disp_flush_ready(disp);
 }
 
+// 描画フレーム数と直近1秒の FPS（x1000）
+static uint32_t lv_frames = 0;
+static uint32_t lv_fps_milli = 0;
+static CST820* touch_dev = nullptr;
+static uint32_t touch_presses = 0;
+
 // UI要素
 static lv_obj_t* status_lbl = nullptr;
 static lv_obj_t* list_box = nullptr;   // SSIDリスト
 
-// 接続チェック用タイマー
-static lv_timer_t* conn_timer = nullptr;
-static String pending_ssid;
+// 接続（WiFi のイベントで進む状態機械。状態は LVGL のスレッドで受け取る）
+static WifiConn wifi_conn;
+static bool scan_after_connect = false;
 
 static void set_status(const char* fmt, ...) {
   if (!status_lbl) return;
@@ -40,7 +112,202 @@ static void set_status(const char* fmt, ...) {
   lv_label_set_text(status_lbl, buf);
 }
 
-static void populate_ssid_list();
+// 1: チャネル単位の非同期スキャン（UI を止めない）/ 0: 従来の同期スキャン（停止時間の比較用）
+#ifndef WIFI_SCAN_ASYNC
+#define WIFI_SCAN_ASYNC 1
+#endif
+static WifiScanner scanner;
+static uint32_t scan_stall_max = 0;   // スキャン開始以降の loop() 間隔の最大値 [ms]
+
+static void populate_ssid_list(bool quick);
+
+static void on_gesture(const TouchGestureEvent& ev) {
+  if (ev.type != TouchGestureType::SwipeUp && ev.type != TouchGestureType::SwipeDown) return;
+  if (!list_box) return;
+  lv_area_t a;
+  lv_obj_get_coords(list_box, &a);
+  lv_point_t start = {ev.start_x, ev.start_y};
+  if (_lv_area_is_point_on(&a, &start, 0)) kinetic.fling(ev.vy);
+}
+
+static void kinetic_tick(lv_timer_t* t) {
+  static uint32_t last = 0;
+  uint32_t now = millis();
+  uint32_t dt = last ? now - last : 0;
+  last = now;
+  if (!kinetic.active() || !list_box) return;
+  int32_t d = kinetic.step(dt);
+  // 端に着いたら止める
+  if ((d > 0 && lv_obj_get_scroll_top(list_box) <= 0) ||
+      (d < 0 && lv_obj_get_scroll_bottom(list_box) <= 0)) {
+    kinetic.stop();
+    return;
+  }
+  if (d) lv_obj_scroll_by(list_box, 0, d, LV_ANIM_OFF);
+}
+
+static void on_conn_status(const WifiConnStatus& st, void*) {
+  const char* ssid = wifi_conn.ssid();
+  switch (st.state) {
+  case WifiConnState::Fast:
+    set_status("Connecting to: %s ...", ssid);
+    return;
+  case WifiConnState::Full:
+    if (st.attempt > 1) set_status("Connecting to: %s ... (retry %u)", ssid, (unsigned)(st.attempt - 1));
+    else set_status("Connecting to: %s ...", ssid);
+    return;
+  case WifiConnState::Backoff:
+    set_status("Retrying: %s (reason %u)", ssid, (unsigned)st.reason);
+    return;
+  case WifiConnState::Connected: {
+    IPAddress ip(st.ip);
+    set_status("Connected: %s / IP: %d.%d.%d.%d", ssid, ip[0], ip[1], ip[2], ip[3]);
+    Serial.printf("[WIFI] connected via %s time_to_ip=%lums attempts=%u\n",
+                  st.via_cache ? "cache" : "scan", (unsigned long)st.time_to_ip_ms, (unsigned)st.attempt);
+#if TELEMETRY_MQTT_ENABLE
+    telemetry.kick();
+#endif
+    break;
+  }
+  case WifiConnState::Failed:
+    if (st.fail == WifiConnFail::Auth) set_status("Failed: %s (auth error)", ssid);
+    else if (st.fail == WifiConnFail::Timeout) set_status("Timeout: %s", ssid);
+    else set_status("Failed: %s (reason %u)", ssid, (unsigned)st.reason);
+    break;
+  case WifiConnState::Idle:
+    set_status("Disconnected: %s", ssid);
+    break;
+  }
+  if (scan_after_connect) { scan_after_connect = false; populate_ssid_list(false); }
+}
+
+// 前回接続できた AP と同じならキャッシュで直接、そうでなければスキャンして接続する
+static void start_connect(const char* ssid, const char* pass) {
+  scanner.cancel();
+  wifi_conn.connect(ssid, pass);
+}
+
+#if RADIO_ENABLE
+static audio_tools::I2SStream i2s;
+static RadioPlayer radio;
+static lv_obj_t* radio_lbl = nullptr;
+
+static void toggle_radio(lv_event_t* e) {
+  if (radio.active()) {
+    radio.stop();   // 待たない（タスクは裏で抜ける）
+    lv_label_set_text(radio_lbl, "Radio");
+    return;
+  }
+  if (radio.stopping()) { set_status("Radio: stopping ..."); return; }
+  if (WiFi.status() != WL_CONNECTED) { set_status("Radio: not connected"); return; }
+  if (radio.play(RADIO_URL)) {
+    lv_label_set_text(radio_lbl, "Stop");
+    set_status("Radio: %s", RADIO_URL);
+  } else {
+    set_status("Radio: failed to start");
+  }
+}
+#endif
+
+static OtaUpdater ota;
+static lv_timer_t* ota_timer = nullptr;
+
+// 進み具合を表示し、終わったら結果を出す。成功なら新しいスロットで再起動
+static void ota_tick(lv_timer_t*) {
+  const OtaStats st = ota.stats();
+  if (ota.busy()) {
+    set_status("OTA: %lu / %lu KB", (unsigned long)(st.raw_bytes / 1024), (unsigned long)(st.raw_total / 1024));
+    return;
+  }
+  lv_timer_del(ota_timer);
+  ota_timer = nullptr;
+  ota.report(Serial);
+  if (st.state != OtaState::Done) { set_status("OTA failed: %s", st.error ? st.error : "?"); return; }
+  set_status("OTA done, restarting ...");
+  lv_timer_handler();
+  delay(500);
+  ESP.restart();
+}
+
+static void start_ota(lv_event_t*) {
+  if (ota.busy()) return;
+  if (WiFi.status() != WL_CONNECTED) { set_status("OTA: not connected"); return; }
+#if RADIO_ENABLE
+  // 受信と書き込みの帯域・メモリを空ける
+  if (radio.active()) { radio.stop(); lv_label_set_text(radio_lbl, "Radio"); }
+#endif
+  if (!ota.start(OTA_URL)) { set_status("OTA: failed to start"); return; }
+  set_status("OTA: %s", OTA_URL);
+  ota_timer = lv_timer_create(ota_tick, 250, nullptr);
+}
+
+#if METRICS_HTTP_ENABLE
+static MetricsServer metrics;
+
+// /metrics の本文（送信バッファへ直接書く。LVGL のスレッドで呼ばれる）
+static void fill_metrics(MetricsText& m, void*) {
+  m.counter("jc_uptime_seconds", millis() / 1000);
+  m.gauge("jc_heap_free_bytes", heap_caps_get_free_size(MALLOC_CAP_8BIT));
+  m.gauge("jc_heap_largest_block_bytes", heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+  m.gauge("jc_heap_dma_free_bytes", heap_caps_get_free_size(MALLOC_CAP_DMA));
+  m.gauge("jc_heap_min_free_bytes", heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+  m.type("jc_lvgl_fps", "gauge").value_milli("jc_lvgl_fps", lv_fps_milli);
+  m.counter("jc_lvgl_frames_total", lv_frames);
+  lv_pool_stats_t ps;
+  lv_pool_get_stats(&ps);
+  m.gauge("jc_lvgl_pool_used_bytes", ps.used_bytes);
+  m.gauge("jc_lvgl_pool_largest_free_bytes", ps.largest_free);
+  m.gauge("jc_lvgl_pool_frag_percent", ps.frag_pct);
+  m.counter("jc_lvgl_pool_failures_total", ps.failures);
+#if RADIO_ENABLE
+  const RadioStats rs = radio.stats();
+  m.counter("jc_audio_underruns_total", rs.underruns);
+  m.gauge("jc_audio_buffer_bytes", rs.buf_level);
+#else
+  m.counter("jc_audio_underruns_total", 0);
+#endif
+  if (touch_dev) {
+    const CST820Stats& ts = touch_dev->stats();
+    m.counter("jc_touch_transactions_total", ts.transactions);
+    m.type("jc_touch_errors_total", "counter")
+      .value("jc_touch_errors_total", ts.naks, "kind", "nak")
+      .value("jc_touch_errors_total", ts.short_reads, "kind", "short_read")
+      .value("jc_touch_errors_total", ts.timeouts, "kind", "timeout")
+      .value("jc_touch_errors_total", ts.recoveries, "kind", "recovery");
+  }
+  m.gauge("jc_wifi_connected", WiFi.status() == WL_CONNECTED ? 1 : 0);
+  m.gauge("jc_wifi_rssi_dbm", WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0);
+  m.counter("jc_metrics_requests_total", metrics.stats().requests);
+}
+#endif
+
+#if TELEMETRY_MQTT_ENABLE
+// TELEMETRY_SAMPLE_MS ごとに1サンプル（カウンタは前回からの増分にする）
+static void telemetry_sample(lv_timer_t*) {
+  static uint32_t last_presses = 0, last_errors = 0;
+  TelemetrySample s = {};
+  s.t_ms = millis();
+  s.heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  s.heap_largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#if RADIO_ENABLE
+  static uint32_t last_underruns = 0;
+  const RadioStats rs = radio.stats();
+  s.audio_underruns = rs.underruns - last_underruns;
+  s.audio_buf = rs.buf_level;
+  last_underruns = rs.underruns;
+#endif
+  s.touch_presses = touch_presses - last_presses;
+  last_presses = touch_presses;
+  if (touch_dev) {
+    const CST820Stats& ts = touch_dev->stats();
+    const uint32_t errors = ts.naks + ts.short_reads + ts.timeouts;
+    s.touch_errors = errors - last_errors;
+    last_errors = errors;
+  }
+  s.rssi = WiFi.status() == WL_CONNECTED ? WiFi.RSSI() : 0;
+  telemetry.sample(s);
+}
+#endif
 
 // パスワード入力ダイアログ
 static void open_password_dialog(const char* ssid) {
@@ -102,40 +369,79 @@ static void open_password_dialog(const char* ssid) {
     lv_obj_add_state(row, LV_STATE_DISABLED);
     set_status("Connecting to: %s ...", ssid);
 
-    // 実接続
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect(true, true);
-    delay(100);
-    WiFi.begin(ssid, pass);
-
-    pending_ssid = ssid;
-
-    if (conn_timer) { lv_timer_del(conn_timer); conn_timer = nullptr; }
-    conn_timer = lv_timer_create([](lv_timer_t* t){
-      wl_status_t st = WiFi.status();
-      if (st == WL_CONNECTED) {
-        IPAddress ip = WiFi.localIP();
-        set_status("Connected: %s / IP: %d.%d.%d.%d", pending_ssid.c_str(), ip[0], ip[1], ip[2], ip[3]);
-        if (conn_timer) { lv_timer_del(conn_timer); conn_timer = nullptr; }
-      } else if (st == WL_CONNECT_FAILED) {
-        set_status("Failed: %s (auth error)", pending_ssid.c_str());
-        if (conn_timer) { lv_timer_del(conn_timer); conn_timer = nullptr; }
-      } else {
-        static uint16_t cnt = 0;
-        if (++cnt > 60) { // 約30秒
-          set_status("Timeout: %s", pending_ssid.c_str());
-          if (conn_timer) { lv_timer_del(conn_timer); conn_timer = nullptr; }
-        }
-      }
-    }, 500, nullptr);
+    start_connect(ssid, pass);
 
     // ダイアログを閉じる
     lv_obj_del(modal);
   }, LV_EVENT_CLICKED, nullptr);
 }
 
-// SSIDリストを作成
-static void populate_ssid_list() {
+#if WIFI_SCAN_ASYNC
+// SSIDリスト（行オブジェクトは見えている分だけ作って使い回す）
+static LvVirtualList ssid_list;
+static lv_style_t ssid_row_style;   // 全行で共有する
+static const lv_coord_t SSID_ROW_H = 40;
+
+static lv_obj_t* create_ssid_row(lv_obj_t* parent, void*) {
+  lv_obj_t* btn = lv_btn_create(parent);
+  lv_obj_add_style(btn, &ssid_row_style, 0);
+  lv_obj_set_width(btn, lv_pct(100));
+  lv_obj_t* lbl = lv_label_create(btn);
+  lv_label_set_long_mode(lbl, LV_LABEL_LONG_DOT);
+  lv_obj_set_width(lbl, lv_pct(100));
+  lv_obj_center(lbl);
+
+  // クリックでパスワード入力へ（行に結び付いている位置の SSID）
+  lv_obj_add_event_cb(btn, [](lv_event_t* e){
+    uint32_t i = LvVirtualList::index_of(lv_event_get_target(e));
+    if (i < scanner.count()) open_password_dialog(scanner.ap(i).ssid);
+  }, LV_EVENT_CLICKED, nullptr);
+  return btn;
+}
+
+static void bind_ssid_row(lv_obj_t* row, uint32_t i, void*) {
+  const WifiScanAp& ap = scanner.ap(i);
+  lv_label_set_text_fmt(lv_obj_get_child(row, 0), "%s  (%ddBm)%s", ap.ssid, (int)ap.rssi, ap.secured?" [secured]":"");
+}
+
+// スクロール中の描画時間（monitor_cb）
+static uint32_t scroll_frames = 0, scroll_frame_sum = 0, scroll_frame_max = 0;
+
+static void report_list_mem(const char* stage) {
+  lv_pool_stats_t ps;
+  lv_pool_get_stats(&ps);
+  Serial.printf("[VLIST %s] items=%u rows=%u lv_mem used=%u B (%u%%) frag=%u%%\n",
+                stage, (unsigned)ssid_list.count(), (unsigned)ssid_list.pool_size(),
+                (unsigned)ps.used_bytes, (unsigned)(ps.pool_bytes ? ps.used_bytes * 100 / ps.pool_bytes : 0),
+                (unsigned)ps.frag_pct);
+}
+
+static void on_scan_update(const WifiScanAp* aps, uint8_t n, bool done, void*) {
+  ssid_list.set_count(n);
+  if (!done) {
+    set_status("Scanning... %d found", n);
+    return;
+  }
+  if (n == 0) set_status("No networks found");
+  else set_status("Found %d network(s)", n);
+  Serial.printf("[SCAN] async aps=%u time=%lums max_stall=%lums\n",
+                n, (unsigned long)scanner.elapsed_ms(), (unsigned long)scan_stall_max);
+  report_list_mem("scan");
+}
+
+// quick=true なら前回見つかったチャネルだけを回す
+static void populate_ssid_list(bool quick) {
+  set_status("Scanning...");
+  scan_stall_max = 0;
+  kinetic.stop();
+  bool ok = (quick && scanner.count()) ? scanner.start_known() : scanner.start();
+  if (!ok) set_status("Scan failed");
+}
+#else
+// SSIDリストを作成（従来の同期スキャン。比較用）
+static void populate_ssid_list(bool quick) {
+  (void)quick;
+  const uint32_t t0 = millis();
   if (!list_box) return;
   lv_obj_clean(list_box);
 
@@ -144,6 +450,8 @@ static void populate_ssid_list() {
   WiFi.disconnect(true, true);
   delay(100);
   int n = WiFi.scanNetworks(/*async=*/false, /*hidden=*/true);
+  // 同期スキャン中は UI が止まっているので、その時間がそのまま停止時間
+  Serial.printf("[SCAN] sync aps=%d time=%lums max_stall=%lums\n", n, (unsigned long)(millis() - t0), (unsigned long)(millis() - t0));
   if (n <= 0) {
     set_status("No networks found");
     return;
@@ -177,15 +485,19 @@ static void populate_ssid_list() {
   }
 }
 
+#endif
+
 void setup() {
   Serial.begin(115200);
   delay(100);
+  // OTA 後の初回起動ならこの版で確定する（ロールバックが有効なブートローダのとき）
+  ota_mark_valid();
 
   tft.init();
   tft.setRotation(1);              // landscape 320x240
   tft.setColorDepth(16);
-  pinMode(27, OUTPUT);             // BL
-  digitalWrite(27, HIGH);
+  pinMode(bsp::Board::Tft::kBl, OUTPUT);  // BL
+  digitalWrite(bsp::Board::Tft::kBl, HIGH);
   tft.setBrightness(255);
 
   // LVGL初期化
@@ -199,32 +511,79 @@ void setup() {
   disp_drv.ver_res = tft.height();
   disp_drv.flush_cb = lvgl_flush;
   disp_drv.draw_buf = &draw_buf;
+  // フレーム数と、スクロール中のフレームの描画時間を集計する
+  disp_drv.monitor_cb = [](lv_disp_drv_t*, uint32_t time, uint32_t) {
+    ++lv_frames;
+    (void)time;
+#if WIFI_SCAN_ASYNC
+    if (!list_box || !(kinetic.active() || lv_obj_is_scrolling(list_box))) return;
+    ++scroll_frames;
+    scroll_frame_sum += time;
+    if (time > scroll_frame_max) scroll_frame_max = time;
+#endif
+  };
+  lv_timer_create([](lv_timer_t*){
+    static uint32_t last_frames = 0, last_ms = 0;
+    const uint32_t now = millis();
+    if (last_ms && now != last_ms) lv_fps_milli = (uint64_t)(lv_frames - last_frames) * 1000000 / (now - last_ms);
+    last_frames = lv_frames;
+    last_ms = now;
+  }, 1000, nullptr);
+#if LATENCY_PROBE_ENABLE
+  // 無効化のたびに呼ばれる（領域は変更しない）。indev の処理中（read_cb で読んだ入力をイベントとして配っている間）に
+  // 起きたものだけを入力→再描画の対応付けに使う。描画中の呼び出しやタイマー/アニメーションの無効化では lv_indev_get_act() が NULL
+  disp_drv.rounder_cb = [](lv_disp_drv_t*, lv_area_t*) {
+    if (lv_indev_get_act()) LATENCY_PROBE_INVALIDATE();
+  };
+#endif
   lv_disp_drv_register(&disp_drv);
 
   // タッチ（CST820）: SDA=33, SCL=32, RST=25, INT=21
-  static CST820 tp(33, 32, 25, 21, I2C_ADDR_CST820);
+  static CST820 tp;
   tp.begin();
+  touch_dev = &tp;
+  touch_calib_load(&touch_cal);
   static lv_indev_drv_t indev_drv;
   lv_indev_drv_init(&indev_drv);
   indev_drv.type = LV_INDEV_TYPE_POINTER;
   indev_drv.read_cb = [](lv_indev_drv_t* drv, lv_indev_data_t* data){
     static CST820* s_tp = nullptr;
     if (!s_tp) s_tp = (CST820*)drv->user_data;
-    uint16_t rx, ry; uint8_t g;
-    bool pressed = s_tp->getTouch(&rx, &ry, &g);
-    if (!pressed) { data->state = LV_INDEV_STATE_RELEASED; return; }
-    uint16_t sx = ry;
-    uint16_t sy = (uint16_t)(240 - 1) - rx;
-    if (sx >= tft.width())  sx = tft.width() - 1;
-    if (sy >= tft.height()) sy = tft.height() - 1;
+    static TouchFilterDefault filter;
+    uint16_t rx = 0, ry = 0; uint8_t g = 0;
+    TouchPoint p = {0, 0, false, millis()};
+    p.pressed = s_tp->getTouch(&rx, &ry, &g);
+    static bool was_pressed = false;
+    if (p.pressed && !was_pressed) ++touch_presses;
+    was_pressed = p.pressed;
+    LATENCY_PROBE_INPUT(micros(), p.pressed, rx, ry);
+    if (touch_calib_ui_active()) {
+      touch_calib_ui_feed(p.pressed, rx, ry);
+      data->state = LV_INDEV_STATE_RELEASED;
+      return;
+    }
+    if (p.pressed) touch_affine_apply(touch_cal, rx, ry, &p.x, &p.y);
+    filter.process(p);
+    TouchGestureEvent ev;
+    if (gesture.update(p, &ev)) on_gesture(ev);
+    if (!p.pressed) { data->state = LV_INDEV_STATE_RELEASED; return; }
+    kinetic.stop();  // 触れたら慣性スクロールを止める
+#if TOUCH_PREDICT_MS
+    gesture.predict(TOUCH_PREDICT_MS, &p.x, &p.y);
+#endif
+    if (p.x < 0) p.x = 0;
+    if (p.y < 0) p.y = 0;
+    if (p.x >= tft.width())  p.x = tft.width() - 1;
+    if (p.y >= tft.height()) p.y = tft.height() - 1;
     data->state = LV_INDEV_STATE_PRESSED;
-    data->point.x = sx; data->point.y = sy;
+    data->point.x = p.x; data->point.y = p.y;
   };
   indev_drv.user_data = &tp;
   lv_indev_drv_register(&indev_drv);
 
   // ルートUI
   lv_obj_t* root = lv_scr_act();
+  LATENCY_PROBE_NAME(root, "wifi");
   lv_obj_set_flex_flow(root, LV_FLEX_FLOW_COLUMN);
   lv_obj_set_style_pad_all(root, 10, 0);
   lv_obj_set_style_pad_gap(root, 8, 0);
@@ -246,7 +605,23 @@ void setup() {
   lv_obj_t* rl = lv_label_create(rescan);
   lv_label_set_text(rl, "Rescan");
   lv_obj_center(rl);
-  lv_obj_add_event_cb(rescan, [](lv_event_t* e){ populate_ssid_list(); }, LV_EVENT_CLICKED, nullptr);
+  // タップは前回のチャネルだけ、長押しは全チャネル
+  lv_obj_add_event_cb(rescan, [](lv_event_t* e){ populate_ssid_list(true); }, LV_EVENT_SHORT_CLICKED, nullptr);
+  lv_obj_add_event_cb(rescan, [](lv_event_t* e){ populate_ssid_list(false); }, LV_EVENT_LONG_PRESSED, nullptr);
+#if RADIO_ENABLE
+  lv_obj_t* radio_btn = lv_btn_create(row);
+  radio_lbl = lv_label_create(radio_btn);
+  lv_label_set_text(radio_lbl, "Radio");
+  lv_obj_center(radio_lbl);
+  lv_obj_add_event_cb(radio_btn, toggle_radio, LV_EVENT_CLICKED, nullptr);
+#endif
+  if (OTA_URL[0]) {
+    lv_obj_t* ota_btn = lv_btn_create(row);
+    lv_obj_t* ol = lv_label_create(ota_btn);
+    lv_label_set_text(ol, "OTA");
+    lv_obj_center(ol);
+    lv_obj_add_event_cb(ota_btn, start_ota, LV_EVENT_CLICKED, nullptr);
+  }
 
   // SSIDリスト
   list_box = lv_obj_create(root);
@@ -254,12 +629,93 @@ void setup() {
   lv_obj_set_flex_flow(list_box, LV_FLEX_FLOW_COLUMN);
   lv_obj_set_style_pad_gap(list_box, 6, 0);
   lv_obj_set_scroll_dir(list_box, LV_DIR_VER);
+  lv_obj_clear_flag(list_box, LV_OBJ_FLAG_SCROLL_MOMENTUM);
+#if WIFI_SCAN_ASYNC
+  lv_style_init(&ssid_row_style);
+  lv_style_set_pad_ver(&ssid_row_style, 4);
+  ssid_list.begin(list_box, SSID_ROW_H, 6, create_ssid_row, bind_ssid_row);
+#endif
+  lv_timer_create(kinetic_tick, 16, nullptr);
+
+  // 起動時に画面を押したままならタッチのキャリブレーション画面を出す
+  {
+    uint16_t rx, ry; uint8_t g;
+    if (tp.getTouch(&rx, &ry, &g)) touch_calib_ui_start(&touch_cal);
+  }
 
   // 初回スキャン
-  populate_ssid_list();
+#if WIFI_SCAN_ASYNC
+  scanner.on_update(on_scan_update);
+  lv_timer_create([](lv_timer_t*){ scanner.poll(); }, 50, nullptr);
+#endif
+  // 前回の接続先があればスキャンせずに接続し、リストのスキャンはその後で行う
+  WiFi.persistent(false);   // 接続情報は WifiCache が持つ（begin のたびに NVS に書かせない）
+  WiFi.mode(WIFI_STA);
+  wifi_conn.on_status(on_conn_status);
+  wifi_conn.begin();
+  lv_timer_create([](lv_timer_t*){ wifi_conn.poll(); }, 20, nullptr);
+#if METRICS_HTTP_ENABLE
+  // 接続前に listen しておく（IP が付けばそのまま受けられる）。poll は待たない
+  metrics.begin(fill_metrics);
+  lv_timer_create([](lv_timer_t*){ metrics.poll(); }, 20, nullptr);
+#endif
+#if TELEMETRY_MQTT_ENABLE
+  {
+    static char client_id[16], topic[48];
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(client_id, sizeof(client_id), "cyd-%02x%02x%02x", mac[3], mac[4], mac[5]);
+    snprintf(topic, sizeof(topic), "jc2432/%s/telemetry", client_id);
+    MqttTelemetryConfig cfg = {MQTT_BROKER, MQTT_PORT, client_id, topic, nullptr, nullptr, 60, TELEMETRY_BATCH_MS};
+    telemetry.begin(cfg);
+    lv_timer_create(telemetry_sample, TELEMETRY_SAMPLE_MS, nullptr);
+  }
+#endif
+#if RADIO_ENABLE
+  // I2S の DMA が出力段（デコードタスクの書き込みはここで待つ）
+  if (!i2s_out_begin(i2s, 44100) || !radio.begin(i2s)) Serial.println("[RADIO] init failed");
+#endif
+  WifiCacheEntry cache;
+  if (wifi_cache_load(&cache)) {
+    set_status("Connecting to: %s ...", cache.ssid);
+    scan_after_connect = true;
+    start_connect(cache.ssid, cache.pass);
+  } else {
+    populate_ssid_list(false);
+  }
 }
 
 void loop() {
+  static uint32_t last_loop = 0;
+  uint32_t now = millis();
+  if (last_loop && now - last_loop > scan_stall_max) scan_stall_max = now - last_loop;
+  last_loop = now;
   lv_timer_handler();
+#if LATENCY_PROBE_ENABLE
+  static uint32_t last_report = 0;
+  if (millis() - last_report > 10000) { last_report = millis(); latency_probe_report(Serial); }
+#endif
+#if WIFI_SCAN_ASYNC
+  static uint32_t last_vlist = 0;
+  if (scroll_frames && millis() - last_vlist > 5000) {
+    last_vlist = millis();
+    Serial.printf("[VLIST] scroll frames=%lu avg=%lums max=%lums\n", (unsigned long)scroll_frames,
+                  (unsigned long)(scroll_frame_sum / scroll_frames), (unsigned long)scroll_frame_max);
+    report_list_mem("scroll");
+    scroll_frames = scroll_frame_sum = scroll_frame_max = 0;
+  }
+#endif
+#if TELEMETRY_MQTT_ENABLE
+  static uint32_t last_mqtt = 0;
+  if (millis() - last_mqtt > 30000) { last_mqtt = millis(); telemetry.report(Serial); }
+#endif
+#if RADIO_ENABLE
+  if (radio.active()) {
+    char title[96];
+    if (radio.title(title, sizeof(title))) set_status("Now: %s", title);
+    static uint32_t last_radio = 0;
+    if (millis() - last_radio > 5000) { last_radio = millis(); radio.report(Serial); }
+  }
+#endif
   delay(5);
 }
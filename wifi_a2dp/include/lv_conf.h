@@ -0,0 +1,39 @@
+/* Minimal LVGL v8 config for LovyanGFX + ESP32 */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#include <stdint.h>
+
+#define LV_COLOR_DEPTH 16
+#define LV_COLOR_16_SWAP 1
+
+#define LV_MEM_CUSTOM 1
+/* lib/LvPool（小物はサイズクラス、それ以外は TLSF）。LV_MEM_SIZE はそのプールの大きさ */
+#define LV_MEM_CUSTOM_INCLUDE "LvPool.h"
+#define LV_MEM_CUSTOM_ALLOC   lv_pool_alloc
+#define LV_MEM_CUSTOM_FREE    lv_pool_free
+#define LV_MEM_CUSTOM_REALLOC lv_pool_realloc
+/* プールを heap_caps の領域に置く場合（既定は .bss の静的配列）
+ * #define LV_POOL_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) */
+// BT + WiFi と同居するので wifi より控えめ（パスワード入力のキーボードは持たない）
+#define LV_MEM_SIZE (24U * 1024U)
+
+#define LV_DISP_DEF_REFR_PERIOD 30
+
+#define LV_TICK_CUSTOM 1
+#if LV_TICK_CUSTOM
+  #define LV_TICK_CUSTOM_INCLUDE "Arduino.h"
+  /* Cコンパイラ互換のため式だけ指定（関数宣言は不要） */
+  #define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())
+#endif
+
+#define LV_USE_LOG 0
+
+#define LV_USE_DRAW_SW 1
+
+#define LV_USE_DEMO_WIDGETS 0
+#define LV_USE_DEMO_BENCHMARK 0
+#define LV_USE_DEMO_MUSIC 0
+
+#endif /* LV_CONF_H */
@@ -0,0 +1,322 @@
+// WiFi + Bluetooth A2DP 同居ビルド（LVGL + LovyanGFX, ESP32 + ST7789 240x320）
+//
+// A2DP で再生しながら WiFi のスキャン/接続をしても音が途切れないかを見るためのファーム。
+//   - BT と WiFi はソフトウェア共存（coexistence）。再生中は BT を優先、それ以外は均等
+//   - BLE は使わないので BT コントローラの BLE 用メモリを起動時に返す
+//   - 大きなバッファは置き場所を決めて確保する（LVGL 描画バッファ=DMA、PCM ジッタバッファ=CPU のみ）
+//   - 起動時にサブシステムごとの DRAM 予算を [BUDGET] に出す
+//   - 再生のアンダーラン/オーバーフローとスキャン・接続中の増分を [A2DP] / [COEX] に出す
+
+#include <Arduino.h>
+#include "BspLgfx.hpp"
+#include <lvgl.h>
+#include "LvPool.h"   // lv_conf.h の LV_MEM_CUSTOM のアロケータ
+#include <WiFi.h>
+#include <BluetoothA2DPSink.h>
+#include <esp_bt.h>
+#include <esp_coexist.h>
+#include "CST820.h"
+#include "TouchAffine.h"
+#include "WifiScan.h"
+#include "WifiCache.h"
+#include "WifiConn.h"
+#include "I2sOut.h"
+#include "I2sJitter.h"
+#include "MemBudget.h"
+
+static LGFX tft;
+static audio_tools::I2SStream i2s;
+static BluetoothA2DPSink a2dp;
+static I2sJitter jitter;
+static WifiScanner scanner;
+static WifiConn wifi_conn;
+
+extern "C" uint32_t lvgl_tick_get_cb(void) { return millis(); }
+
+#ifndef LV_LINES
+#define LV_LINES 20
+#endif
+// A2DP の PCM（16bit ステレオ）を溜めるリング [KB]。32KB で約 190ms
+#ifndef A2DP_JITTER_KB
+#define A2DP_JITTER_KB 32
+#endif
+// 保存済みの接続先が無いときに Connect で使う（任意）
+#ifndef WIFI_SSID
+#define WIFI_SSID ""
+#endif
+#ifndef WIFI_PASS
+#define WIFI_PASS ""
+#endif
+#define SSID_ROWS 6
+
+// タッチ生座標 → 画面座標（既定は横向き: sx = ry, sy = 239 - rx。NVS にキャリブレーション結果があれば置き換える）
+static TouchAffine touch_cal = touch_affine_make(0, 1, 0, -1, 0, 240 - 1);
+
+// UI要素
+static lv_obj_t* status_lbl = nullptr;
+static lv_obj_t* audio_lbl = nullptr;
+static lv_obj_t* ssid_lbl[SSID_ROWS];
+
+// スキャン/接続の間に増えたアンダーランを数える
+struct CoexWindow {
+  const char* what = nullptr;
+  uint32_t t0 = 0;
+  uint32_t underruns = 0;
+  uint32_t overflows = 0;
+};
+static CoexWindow coex_window;
+
+static void set_status(const char* fmt, ...) {
+  if (!status_lbl) return;
+  char buf[160];
+  va_list ap; va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  lv_label_set_text(status_lbl, buf);
+}
+
+static void coex_window_begin(const char* what) {
+  I2sJitterStats s = jitter.stats();
+  jitter.reset_window();
+  coex_window.what = what;
+  coex_window.t0 = millis();
+  coex_window.underruns = s.underruns;
+  coex_window.overflows = s.overflows;
+}
+
+static void coex_window_end() {
+  if (!coex_window.what) return;
+  I2sJitterStats s = jitter.stats();
+  Serial.printf("[COEX] %s %lums playing=%d underruns+%lu overflows+%lu min_buf=%lu%% max_gap=%lums\n",
+                coex_window.what, (unsigned long)(millis() - coex_window.t0), s.playing ? 1 : 0,
+                (unsigned long)(s.underruns - coex_window.underruns),
+                (unsigned long)(s.overflows - coex_window.overflows),
+                (unsigned long)(s.min_level * 100 / s.size), (unsigned long)s.max_gap_ms);
+  coex_window.what = nullptr;
+}
+
+// 再生中は BT を優先（WiFi は共存の空き時間で動く）
+static void set_coex_prefer_bt(bool bt) {
+#if defined(CONFIG_SW_COEXIST_ENABLE) || defined(CONFIG_ESP32_WIFI_SW_COEXIST_ENABLE)
+  esp_coex_preference_set(bt ? ESP_COEX_PREFER_BT : ESP_COEX_PREFER_BALANCE);
+#endif
+}
+
+static void lvgl_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p) {
+  uint32_t w = (area->x2 - area->x1 + 1);
+  uint32_t h = (area->y2 - area->y1 + 1);
+  tft.pushImage(area->x1, area->y1, w, h, reinterpret_cast<const uint16_t*>(color_p), false /*swapBytes*/);
+  lv_disp_flush_ready(disp);
+}
+
+static void on_scan_update(const WifiScanAp* aps, uint8_t n, bool done, void*) {
+  for (uint8_t i = 0; i < SSID_ROWS; ++i) {
+    if (i < n) lv_label_set_text_fmt(ssid_lbl[i], "%s  (%ddBm) ch%u", aps[i].ssid, (int)aps[i].rssi, aps[i].channel);
+    else lv_label_set_text(ssid_lbl[i], "");
+  }
+  if (!done) {
+    set_status("Scanning... %d found", n);
+    return;
+  }
+  set_status("Found %d network(s)", n);
+  Serial.printf("[SCAN] aps=%u time=%lums\n", n, (unsigned long)scanner.elapsed_ms());
+  coex_window_end();
+}
+
+static void on_conn_status(const WifiConnStatus& st, void*) {
+  const char* ssid = wifi_conn.ssid();
+  switch (st.state) {
+  case WifiConnState::Fast:
+  case WifiConnState::Full:
+    set_status("Connecting to: %s ...", ssid);
+    return;
+  case WifiConnState::Backoff:
+    set_status("Retrying: %s (reason %u)", ssid, (unsigned)st.reason);
+    return;
+  case WifiConnState::Connected: {
+    IPAddress ip(st.ip);
+    set_status("Connected: %s / IP: %d.%d.%d.%d", ssid, ip[0], ip[1], ip[2], ip[3]);
+    Serial.printf("[WIFI] connected via %s time_to_ip=%lums attempts=%u\n",
+                  st.via_cache ? "cache" : "scan", (unsigned long)st.time_to_ip_ms, (unsigned)st.attempt);
+    break;
+  }
+  case WifiConnState::Failed:
+    set_status("Failed: %s (reason %u)", ssid, (unsigned)st.reason);
+    break;
+  case WifiConnState::Idle:
+    set_status("Disconnected: %s", ssid);
+    break;
+  }
+  coex_window_end();
+}
+
+static void start_scan() {
+  if (scanner.busy()) return;
+  wifi_conn.cancel();
+  coex_window_begin("scan");
+  if (!scanner.start()) { set_status("Scan failed to start"); coex_window_end(); return; }
+  set_status("Scanning...");
+}
+
+static void start_connect() {
+  WifiCacheEntry cache;
+  const char* ssid = WIFI_SSID;
+  const char* pass = WIFI_PASS;
+  if (wifi_cache_load(&cache)) { ssid = cache.ssid; pass = cache.pass; }
+  if (!ssid[0]) { set_status("No saved network (-D WIFI_SSID)"); return; }
+  scanner.cancel();
+  coex_window_begin("connect");
+  wifi_conn.connect(ssid, pass);
+}
+
+// BT のコールバック（BT タスク上）。リングに積むだけで待たない
+static void on_a2dp_data(const uint8_t* data, uint32_t len) {
+  jitter.push(data, len);
+}
+
+static void add_button(lv_obj_t* row, const char* text, lv_event_cb_t cb) {
+  lv_obj_t* btn = lv_btn_create(row);
+  lv_obj_t* lbl = lv_label_create(btn);
+  lv_label_set_text(lbl, text);
+  lv_obj_center(lbl);
+  lv_obj_add_event_cb(btn, cb, LV_EVENT_CLICKED, nullptr);
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+  mem_budget_begin();
+
+  tft.init();
+  tft.setRotation(1);
+  tft.setColorDepth(16);
+  pinMode(bsp::Board::Tft::kBl, OUTPUT);  // BL
+  digitalWrite(bsp::Board::Tft::kBl, HIGH);
+  tft.setBrightness(255);
+  mem_budget_mark("tft");
+
+  // LVGL: 描画バッファは SPI DMA が読むので DMA 可能領域に、BT/WiFi が始まって断片化する前に取る
+  lv_init();
+  lv_color_t* lvbuf = static_cast<lv_color_t*>(
+      mem_budget_alloc("lvgl", 320 * LV_LINES * sizeof(lv_color_t), MemPlace::Dma));
+  static lv_disp_draw_buf_t draw_buf;
+  lv_disp_draw_buf_init(&draw_buf, lvbuf, NULL, 320 * LV_LINES);
+  static lv_disp_drv_t disp_drv;
+  lv_disp_drv_init(&disp_drv);
+  disp_drv.hor_res = tft.width();
+  disp_drv.ver_res = tft.height();
+  disp_drv.flush_cb = lvgl_flush;
+  disp_drv.draw_buf = &draw_buf;
+  lv_disp_drv_register(&disp_drv);
+  mem_budget_static("lvgl", LV_MEM_SIZE);
+
+  // タッチ（CST820）: SDA=33, SCL=32, RST=25, INT=21
+  static CST820 tp;
+  tp.begin();
+  touch_calib_load(&touch_cal);
+  static lv_indev_drv_t indev_drv;
+  lv_indev_drv_init(&indev_drv);
+  indev_drv.type = LV_INDEV_TYPE_POINTER;
+  indev_drv.read_cb = [](lv_indev_drv_t* drv, lv_indev_data_t* data){
+    CST820* t = (CST820*)drv->user_data;
+    uint16_t rx = 0, ry = 0; uint8_t g = 0;
+    if (!t->getTouch(&rx, &ry, &g)) { data->state = LV_INDEV_STATE_RELEASED; return; }
+    int16_t x, y;
+    touch_affine_apply(touch_cal, rx, ry, &x, &y);
+    data->state = LV_INDEV_STATE_PRESSED;
+    data->point.x = x < 0 ? 0 : x >= tft.width() ? tft.width() - 1 : x;
+    data->point.y = y < 0 ? 0 : y >= tft.height() ? tft.height() - 1 : y;
+  };
+  indev_drv.user_data = &tp;
+  lv_indev_drv_register(&indev_drv);
+
+  // UI
+  lv_obj_t* root = lv_scr_act();
+  lv_obj_set_flex_flow(root, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_style_pad_all(root, 8, 0);
+  lv_obj_set_style_pad_gap(root, 4, 0);
+  lv_obj_t* title = lv_label_create(root);
+  lv_label_set_text(title, "WiFi + A2DP");
+  audio_lbl = lv_label_create(root);
+  lv_label_set_text(audio_lbl, "A2DP: waiting");
+  status_lbl = lv_label_create(root);
+  lv_label_set_text(status_lbl, "");
+  lv_obj_t* row = lv_obj_create(root);
+  lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
+  lv_obj_set_size(row, lv_pct(100), LV_SIZE_CONTENT);
+  lv_obj_set_style_pad_gap(row, 8, 0);
+  add_button(row, "Scan", [](lv_event_t*){ start_scan(); });
+  add_button(row, "Connect", [](lv_event_t*){ start_connect(); });
+  for (uint8_t i = 0; i < SSID_ROWS; ++i) {
+    ssid_lbl[i] = lv_label_create(root);
+    lv_label_set_long_mode(ssid_lbl[i], LV_LABEL_LONG_DOT);
+    lv_obj_set_width(ssid_lbl[i], lv_pct(100));
+    lv_label_set_text(ssid_lbl[i], "");
+  }
+  lv_timer_handler();
+  mem_budget_mark("lvgl");
+
+  // BLE は使わない: コントローラ初期化前なら BLE 分のメモリをヒープに返せる
+  esp_err_t rel = esp_bt_controller_mem_release(ESP_BT_MODE_BLE);
+  Serial.printf("[BT] release BLE memory: %s\n", rel == ESP_OK ? "OK" : esp_err_to_name(rel));
+  mem_budget_mark("ble_free");
+
+  // PCM ジッタバッファ（CPU しか触らない）と I2S（DMA バッファはドライバが内部 DRAM に取る）
+  const size_t jitter_bytes = A2DP_JITTER_KB * 1024;
+  uint8_t* jitter_mem = static_cast<uint8_t*>(mem_budget_alloc("audio", jitter_bytes + 1, MemPlace::NoDma));
+  if (!i2s_out_begin(i2s, 44100) || !jitter.begin(i2s, jitter_mem, jitter_bytes)) {
+    Serial.println("[A2DP] audio init failed");
+  }
+  mem_budget_mark("audio");
+
+  a2dp.set_stream_reader(on_a2dp_data, false);
+  a2dp.set_on_connection_state_changed([](esp_a2d_connection_state_t state, void*) {
+    Serial.printf("[A2DP] connection state %d\n", state);
+  });
+  a2dp.set_on_audio_state_changed([](esp_a2d_audio_state_t state, void*) {
+    const bool playing = state == ESP_A2D_AUDIO_STATE_STARTED;
+    if (!playing) jitter.idle();
+    set_coex_prefer_bt(playing);
+  });
+  a2dp.set_auto_reconnect(true);
+  a2dp.set_volume(90);
+  a2dp.start("JC2432W328C");
+  mem_budget_mark("bt");
+
+  // WiFi: BT と同居するときはモデムスリープが必須（無効にすると共存が成り立たない）
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(true);
+  set_coex_prefer_bt(false);
+  scanner.on_update(on_scan_update);
+  wifi_conn.on_status(on_conn_status);
+  wifi_conn.begin();
+  mem_budget_mark("wifi");
+
+  lv_timer_create([](lv_timer_t*){ scanner.poll(); }, 50, nullptr);
+  lv_timer_create([](lv_timer_t*){ wifi_conn.poll(); }, 20, nullptr);
+  lv_timer_create([](lv_timer_t*){
+    I2sJitterStats s = jitter.stats();
+    lv_label_set_text_fmt(audio_lbl, "A2DP: %s buf=%lu%% underrun=%lu",
+                          s.playing ? "playing" : (a2dp.is_connected() ? "connected" : "waiting"),
+                          (unsigned long)(s.level * 100 / s.size), (unsigned long)s.underruns);
+  }, 500, nullptr);
+
+  mem_budget_report(Serial);
+  start_connect();
+}
+
+void loop() {
+  lv_timer_handler();
+  static uint32_t last_report = 0;
+  if (millis() - last_report > 5000) {
+    last_report = millis();
+    I2sJitterStats s = jitter.stats();
+    Serial.printf("[A2DP] playing=%d underruns=%lu overflows=%lu buf=%lu%% min=%lu%% max_gap=%lums heap=%uKB\n",
+                  s.playing ? 1 : 0, (unsigned long)s.underruns, (unsigned long)s.overflows,
+                  (unsigned long)(s.level * 100 / s.size), (unsigned long)(s.min_level * 100 / s.size),
+                  (unsigned long)s.max_gap_ms, (unsigned)(ESP.getFreeHeap() / 1024));
+    if (!coex_window.what) jitter.reset_window();
+  }
+  delay(5);
+}